@@ -0,0 +1,59 @@
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include "dim/quantity_array.hpp"
+#include "dim/si.hpp"
+#include "measure.hpp"
+
+/*
+ * Throughput of F = m * a + drag * v * v over quantity arrays, in GB/s of
+ * input and output values: evaluating one operator at a time into temporary
+ * arrays, as one fused expression, and as one fused expression split across
+ * threads with parallel_policy.
+ */
+
+using namespace dim::si;
+
+namespace
+{
+
+void drag_force(std::size_t i_count)
+{
+    dim::quantity_array<Mass> mass(i_count, 2.0 * kilogram);
+    dim::quantity_array<Acceleration> acceleration(i_count);
+    dim::quantity_array<Speed> speed(i_count);
+    for (std::size_t i = 0; i < i_count; ++i) {
+        acceleration[i] = static_cast<double>(i % 100) * meter / (second * second);
+        speed[i] = static_cast<double>(i % 30) * meter / second;
+    }
+    auto const drag = 0.5 * kilogram / meter;
+    dim::quantity_array<Force> force(i_count);
+    std::size_t bytes = 4 * i_count * sizeof(double);
+
+    double temporaries = bench::measure(bytes, [&] {
+        dim::quantity_array<Force> inertia = mass * acceleration;
+        dim::quantity_array<decltype(drag * speed)::value_type> dragged = drag * speed;
+        dim::quantity_array<Force> resistance = dragged * speed;
+        force = inertia + resistance;
+    });
+    double fused = bench::measure(bytes, [&] { force = mass * acceleration + drag * speed * speed; });
+    dim::parallel_policy const parallel;
+    double threaded =
+        bench::measure(bytes, [&] { force.assign(mass * acceleration + drag * speed * speed, parallel); });
+
+    std::cout << std::setw(10) << i_count << std::fixed << std::setprecision(2) << std::setw(14) << temporaries
+              << std::setw(12) << fused << std::setw(12) << threaded << "\n";
+}
+
+} // namespace
+
+int main()
+{
+    std::cout << "Threads: " << dim::parallel_policy().threads() << "\n";
+    std::cout << std::setw(10) << "values" << std::setw(14) << "temporaries" << std::setw(12) << "fused"
+              << std::setw(12) << "parallel" << "   (GB/s)\n";
+    for (std::size_t count : {std::size_t(1) << 10, std::size_t(1) << 16, std::size_t(1) << 22, std::size_t(1) << 24}) {
+        drag_force(count);
+    }
+    return 0;
+}
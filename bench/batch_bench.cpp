@@ -0,0 +1,104 @@
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "benchmarks.hpp"
+#include "dim/csv.hpp"
+#include "dim/si.hpp"
+
+/*
+ * Batches: parse_quantities on arrays of strings and on one delimited buffer,
+ * and csv_reader on a two-column file, with strtod over the same cells as the
+ * floor. Each reports ns per value.
+ */
+
+using namespace dim::si;
+
+namespace bench
+{
+
+namespace
+{
+
+std::size_t const kValues = 2000;
+
+} // namespace
+
+void add_batch_benchmarks(suite& io_suite)
+{
+    // Half the values in one unit and half in another, so a batch looks a symbol up twice
+    static std::vector<std::string> texts;
+    static std::vector<char const*> pointers;
+    static std::vector<std::size_t> lengths;
+    static std::string delimited;
+    for (std::size_t i = 0; i < kValues; ++i) {
+        texts.push_back(std::to_string(i) + (i < kValues / 2 ? "_lbf" : "_kN"));
+        delimited += texts.back() + ",";
+    }
+    delimited.pop_back();
+    for (std::string const& text : texts) {
+        pointers.push_back(text.c_str());
+        lengths.push_back(text.size());
+    }
+    static std::vector<Force> forces(kValues);
+    static std::vector<std::errc> errors(kValues);
+
+    // A speed column with the unit in the header and a force column with a unit on every value
+    static std::string csv = "speed [mph],force\n";
+    for (std::size_t i = 0; i < kValues / 2; ++i) {
+        csv += std::to_string(i) + ".25," + std::to_string(i) + "_lbf\n";
+    }
+    static std::vector<Speed> speeds;
+
+    io_suite.add(
+        "batch/parse_quantities",
+        [] {
+            return dim::parse_quantities(forces.data(), errors.data(), pointers.data(), lengths.data(), kValues).failed;
+        },
+        kValues);
+
+    io_suite.add(
+        "batch/parse_quantities/delimited",
+        [] {
+            return dim::parse_quantities(forces.data(), errors.data(), kValues, delimited.data(),
+                                         delimited.data() + delimited.size(), ',')
+                .count;
+        },
+        kValues);
+
+    io_suite.add(
+        "batch/csv_reader",
+        [] {
+            std::istringstream input(csv);
+            dim::csv_reader<double, dim::si::system> reader(input);
+            reader.read_header();
+            std::size_t failed = 0;
+            for (std::size_t rows = reader.read_chunk(); rows > 0; rows = reader.read_chunk()) {
+                speeds.resize(rows);
+                forces.resize(rows);
+                failed += reader.column(0, speeds.data(), nullptr).failed;
+                failed += reader.column(1, forces.data(), nullptr).failed;
+            }
+            forces.resize(kValues);
+            return failed;
+        },
+        kValues);
+
+    io_suite.add(
+        "batch/strtod",
+        [] {
+            double sum = 0.0;
+            char const* position = csv.c_str() + csv.find('\n') + 1;
+            char* end = nullptr;
+            for (std::size_t i = 0; i < kValues; ++i) {
+                sum += std::strtod(position, &end);
+                position = end + std::strcspn(end, ",\n") + 1;
+            }
+            return sum;
+        },
+        kValues);
+}
+
+} // namespace bench
@@ -0,0 +1,29 @@
+#pragma once
+#include "measure.hpp"
+
+/*
+ * The parts of the dimBench suite, one per source file.
+ */
+
+namespace bench
+{
+
+/// from_chars, parse_quantity and from_string, through the format maps and the fallback parsers
+void add_parse_benchmarks(suite& io_suite);
+
+/// to_string, operator<<, format_quantity, to_chars and print_unit
+void add_format_benchmarks(suite& io_suite);
+
+/// dynamic_quantity arithmetic and format map lookups
+void add_quantity_benchmarks(suite& io_suite);
+
+/// Bulk unit conversion with formatter, per value
+void add_convert_benchmarks(suite& io_suite);
+
+/// parse_quantities() and csv_reader, per value
+void add_batch_benchmarks(suite& io_suite);
+
+/// format_registry reads, with and without concurrent reloads, and loads
+void add_registry_benchmarks(suite& io_suite);
+
+} // namespace bench
@@ -0,0 +1,84 @@
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "benchmarks.hpp"
+#include "dim/si.hpp"
+
+/*
+ * Bulk unit conversion with formatter, in ns per value: one
+ * formatter::input<Q>() call per value, the scalar kernel, and the SIMD kernel
+ * chosen at run time (reported in the metadata as simd_kernel).
+ */
+
+using namespace dim::si;
+using system_type = dim::si::system;
+
+namespace bench
+{
+
+namespace
+{
+
+template <class Scalar, class Q>
+void convert(suite& io_suite, std::string const& i_name, dim::formatter<Scalar, system_type> const& i_format,
+             std::size_t i_count)
+{
+    // Shared so the buffers live as long as the suite
+    struct buffers {
+        dim::formatter<Scalar, system_type> format;
+        std::vector<Scalar> input;
+        std::vector<Scalar> output;
+        std::vector<Q> quantities;
+    };
+    std::shared_ptr<buffers> data(new buffers{i_format, std::vector<Scalar>(i_count), std::vector<Scalar>(i_count),
+                                              std::vector<Q>(i_count)});
+    for (std::size_t i = 0; i < i_count; ++i) {
+        data->input[i] = static_cast<Scalar>(i % 1000) * Scalar(0.5);
+    }
+    std::string prefix = "convert/" + i_name + "/" + std::to_string(i_count) + "/";
+
+    io_suite.add(
+        prefix + "input<Q>",
+        [data] {
+            for (std::size_t i = 0; i < data->input.size(); ++i) {
+                data->quantities[i] = data->format.template input<Q>(data->input[i]);
+            }
+            return dimensionless_cast(data->quantities.back());
+        },
+        i_count);
+    io_suite.add(
+        prefix + "scalar",
+        [data] {
+            dim::detail::affine_transform_scalar(data->input.data(), data->output.data(), data->input.size(),
+                                                 Scalar(0), data->format.scale().value(),
+                                                 data->format.offset().value());
+            return data->output.back();
+        },
+        i_count);
+    io_suite.add(
+        prefix + "simd",
+        [data] {
+            data->format.input(data->input.data(), data->output.data(), data->input.size());
+            return data->output.back();
+        },
+        i_count);
+}
+
+} // namespace
+
+void add_convert_benchmarks(suite& io_suite)
+{
+    si::formatter feet("ft", foot);
+    si::formatter fahrenheit("F", 5. / 9. * kelvin, (273.15 - 5. / 9. * 32.) * kelvin);
+    dim::formatter<float, system_type> feet_float("ft", dim::dynamic_quantity<float, system_type>(0.3048f, meter_));
+    using LengthFloat = dim::quantity<Length::unit, float>;
+
+    for (std::size_t count : {std::size_t(1) << 10, std::size_t(1) << 16, std::size_t(1) << 22}) {
+        convert<double, Length>(io_suite, "ft", feet, count);
+        convert<double, Temperature>(io_suite, "F", fahrenheit, count);
+        convert<float, LengthFloat>(io_suite, "ft_float", feet_float, count);
+    }
+}
+
+} // namespace bench
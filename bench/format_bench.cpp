@@ -0,0 +1,82 @@
+#include <sstream>
+#include <string>
+#include "benchmarks.hpp"
+#include "dim/si.hpp"
+
+/*
+ * Formatting: the string and stream interfaces, format_quantity with and
+ * without an output format map, the allocation-free to_chars, and print_unit
+ * for named and compound units.
+ */
+
+using namespace dim::si;
+
+namespace bench
+{
+
+void add_format_benchmarks(suite& io_suite)
+{
+    static Force const force = 123.456 * newton;
+    static Force const force_kn = 123456.0 * newton;
+    static si::dynamic_quantity const dynamic_force(force);
+    static Acceleration const acceleration = 9.81 * meter / (second * second);
+    static si::output_format_map outputs;
+    outputs.insert(si::formatter("kN", 1000.0 * newton));
+    static si::codec const writer{std::locale()};
+
+    io_suite.add("format/to_string", [] { return dim::to_string(force).size(); });
+
+    io_suite.add("format/to_string/dynamic", [] { return dim::to_string(dynamic_force).size(); });
+
+    io_suite.add("format/operator<<", [] {
+        static std::ostringstream stream;
+        stream.seekp(0);
+        stream << force;
+        return static_cast<double>(stream.tellp());
+    });
+
+    io_suite.add("format/format_quantity", [] {
+        si::formatted_quantity formatted;
+        format_quantity(formatted, force);
+        return formatted.value();
+    });
+
+    io_suite.add("format/format_quantity/map", [] {
+        si::formatted_quantity formatted;
+        format_quantity(formatted, force_kn, &outputs);
+        return formatted.value();
+    });
+
+    io_suite.add("format/format_quantity/dynamic", [] {
+        si::formatted_quantity formatted;
+        format_quantity(formatted, dynamic_force, &outputs);
+        return formatted.value();
+    });
+
+    io_suite.add("format/to_chars", [] {
+        char buffer[64];
+        return dim::to_chars(buffer, buffer + sizeof(buffer), force).ptr - buffer;
+    });
+
+    io_suite.add("format/codec/to_chars", [] {
+        char buffer[64];
+        return writer.to_chars(buffer, buffer + sizeof(buffer), force).ptr - buffer;
+    });
+
+    io_suite.add("format/print_unit/named", [] {
+        char buffer[dim::kMaxSymbol];
+        return print_unit(buffer, buffer + sizeof(buffer), force) - buffer;
+    });
+
+    io_suite.add("format/print_unit/compound", [] {
+        char buffer[dim::kMaxSymbol];
+        return print_unit(buffer, buffer + sizeof(buffer), acceleration) - buffer;
+    });
+
+    io_suite.add("format/print_unit/dynamic", [] {
+        char buffer[dim::kMaxSymbol];
+        return print_unit(buffer, buffer + sizeof(buffer), dim::index<Acceleration>()) - buffer;
+    });
+}
+
+} // namespace bench
@@ -0,0 +1,91 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "benchmarks.hpp"
+#include "dim/si.hpp"
+
+/*
+ * dimBench: latency of the common parse, format, arithmetic and lookup paths.
+ *
+ *   dimBench [--csv | --json] [--filter=TEXT] [--repetitions=N] [--sample=SECONDS] [--warmup=SECONDS]
+ *
+ * Results are in ns per operation. The JSON and CSV forms are meant to be kept
+ * and compared across versions.
+ */
+
+volatile double bench::g_sink = 0.0;
+
+namespace
+{
+
+bool option_value(char const* i_arg, char const* i_name, char const*& o_value)
+{
+    std::size_t length = std::strlen(i_name);
+    if (std::strncmp(i_arg, i_name, length) != 0 || i_arg[length] != '=') {
+        return false;
+    }
+    o_value = i_arg + length + 1;
+    return true;
+}
+
+int usage(char const* i_program)
+{
+    std::cerr << "usage: " << i_program
+              << " [--csv | --json] [--filter=TEXT] [--repetitions=N] [--sample=SECONDS] [--warmup=SECONDS]\n";
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    bench::options options;
+    for (int i = 1; i < argc; ++i) {
+        char const* value = nullptr;
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            options.format = bench::options::output::csv;
+        } else if (std::strcmp(argv[i], "--json") == 0) {
+            options.format = bench::options::output::json;
+        } else if (option_value(argv[i], "--filter", value)) {
+            options.filter = value;
+        } else if (option_value(argv[i], "--repetitions", value)) {
+            options.repetitions = std::strtoul(value, nullptr, 10);
+        } else if (option_value(argv[i], "--sample", value)) {
+            options.sample = std::strtod(value, nullptr);
+        } else if (option_value(argv[i], "--warmup", value)) {
+            options.warmup = std::strtod(value, nullptr);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    // The default SI formats, as an application would have them
+    dim::si::system::install_facet();
+
+    bench::suite suite;
+    bench::add_parse_benchmarks(suite);
+    bench::add_format_benchmarks(suite);
+    bench::add_quantity_benchmarks(suite);
+    bench::add_convert_benchmarks(suite);
+    bench::add_batch_benchmarks(suite);
+    bench::add_registry_benchmarks(suite);
+    std::vector<bench::result> results = suite.run(options);
+
+    bench::metadata metadata{
+        {"dim_version", DIM_BENCH_VERSION},
+#ifdef __VERSION__
+        {"compiler", __VERSION__},
+#endif
+        {"cplusplus", std::to_string(__cplusplus)},
+#ifdef NDEBUG
+        {"assertions", "off"},
+#else
+        {"assertions", "on"},
+#endif
+        {"simd_kernel", dim::detail::affine_transform_isa()},
+        {"repetitions", std::to_string(options.repetitions)},
+    };
+    bench::report(std::cout, options.format, metadata, results);
+    return 0;
+}
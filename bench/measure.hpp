@@ -0,0 +1,234 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench
+{
+
+using clock = std::chrono::steady_clock;
+
+/// Run i_function enough times to fill about 0.2 s and return GB/s for i_bytes per run
+template <class Function>
+double measure(std::size_t i_bytes, Function&& i_function)
+{
+    std::size_t runs = 0;
+    auto start = clock::now();
+    double elapsed = 0.0;
+    do {
+        i_function();
+        ++runs;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < 0.2);
+    return static_cast<double>(i_bytes * runs) / elapsed * 1e-9;
+}
+
+/// Results are folded into this so the compiler cannot drop the work being timed
+extern volatile double g_sink;
+
+/// How a suite is run and reported
+struct options {
+    enum class output { text, csv, json };
+
+    /// Timed samples per benchmark
+    std::size_t repetitions = 100;
+    /// Seconds each benchmark runs untimed before sampling
+    double warmup = 0.05;
+    /// Target seconds per sample; the operation is repeated to fill it
+    double sample = 0.001;
+    /// Only run benchmarks whose names contain this
+    std::string filter;
+    output format = output::text;
+};
+
+/// The timing of one benchmark. Each sample is the mean over `iterations` operations.
+struct result {
+    std::string name;
+    std::size_t iterations = 0;
+    std::size_t repetitions = 0;
+    double median = 0.0; ///< ns/op
+    double p99 = 0.0;    ///< ns/op, nearest rank
+    double min = 0.0;    ///< ns/op
+    double mean = 0.0;   ///< ns/op
+};
+
+/**
+ * @brief A set of named operations timed for latency.
+ *
+ * Each operation is called in a loop, untimed for options::warmup seconds
+ * (which also sizes the loop to options::sample seconds), then timed
+ * options::repetitions times with the steady clock. An operation returns a
+ * number derived from its work, which is summed into g_sink.
+ */
+class suite
+{
+  public:
+    /**
+     * @brief Add an operation. i_items is the number of values one call
+     * handles, so batch operations report ns per value.
+     */
+    template <class Function>
+    void add(std::string i_name, Function i_function, std::size_t i_items = 1)
+    {
+        m_entries.push_back(entry{std::move(i_name), i_items, [i_function](std::size_t i_iterations) {
+                                      double sum = 0.0;
+                                      for (std::size_t i = 0; i < i_iterations; ++i) {
+                                          sum += static_cast<double>(i_function());
+                                      }
+                                      return sum;
+                                  }});
+    }
+
+    /// Run the benchmarks matching i_options.filter, in the order they were added
+    std::vector<result> run(options const& i_options) const
+    {
+        std::vector<result> results;
+        for (entry const& e : m_entries) {
+            if (e.name.find(i_options.filter) != std::string::npos) {
+                results.push_back(time(e, i_options));
+            }
+        }
+        return results;
+    }
+
+  private:
+    struct entry {
+        std::string name;
+        std::size_t items;
+        std::function<double(std::size_t)> loop;
+    };
+
+    static double seconds(clock::duration i_duration) { return std::chrono::duration<double>(i_duration).count(); }
+
+    static result time(entry const& i_entry, options const& i_options)
+    {
+        // Warm up, doubling the loop until one run fills a sample
+        std::size_t iterations = 1;
+        auto warmup_end = clock::now() + std::chrono::duration_cast<clock::duration>(
+                                             std::chrono::duration<double>(i_options.warmup));
+        for (;;) {
+            auto start = clock::now();
+            g_sink = g_sink + i_entry.loop(iterations);
+            auto stop = clock::now();
+            if (seconds(stop - start) < i_options.sample) {
+                iterations *= 2;
+            } else if (stop >= warmup_end) {
+                break;
+            }
+        }
+
+        std::vector<double> samples;
+        samples.reserve(i_options.repetitions);
+        double scale = 1e9 / static_cast<double>(iterations * i_entry.items);
+        for (std::size_t r = 0; r < i_options.repetitions; ++r) {
+            auto start = clock::now();
+            g_sink = g_sink + i_entry.loop(iterations);
+            samples.push_back(seconds(clock::now() - start) * scale);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        result out;
+        out.name = i_entry.name;
+        out.iterations = iterations * i_entry.items;
+        out.repetitions = samples.size();
+        if (!samples.empty()) {
+            out.median = samples[(samples.size() - 1) / 2];
+            out.p99 = samples[(samples.size() * 99 + 99) / 100 - 1];
+            out.min = samples.front();
+            double total = 0.0;
+            for (double s : samples) {
+                total += s;
+            }
+            out.mean = total / static_cast<double>(samples.size());
+        }
+        return out;
+    }
+
+    std::vector<entry> m_entries;
+};
+
+/// Key/value facts about the build, reported with the results
+using metadata = std::vector<std::pair<std::string, std::string>>;
+
+/// Write i_text as a JSON string
+inline void write_json_string(std::ostream& o_out, std::string const& i_text)
+{
+    o_out << '"';
+    for (char c : i_text) {
+        if (c == '"' || c == '\\') {
+            o_out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            o_out << ' ';
+        } else {
+            o_out << c;
+        }
+    }
+    o_out << '"';
+}
+
+/**
+ * @brief Write the results as an aligned table, CSV (one header row, then one
+ * row per benchmark) or a JSON object with "metadata" and "benchmarks" members.
+ * Times are in ns per operation.
+ */
+inline void report(std::ostream& o_out, options::output i_format, metadata const& i_metadata,
+                   std::vector<result> const& i_results)
+{
+    switch (i_format) {
+    case options::output::text: {
+        for (auto const& item : i_metadata) {
+            o_out << item.first << ": " << item.second << "\n";
+        }
+        std::size_t width = 10;
+        for (result const& r : i_results) {
+            width = std::max(width, r.name.size() + 2);
+        }
+        o_out << std::left << std::setw(static_cast<int>(width)) << "benchmark" << std::right << std::setw(12)
+              << "median" << std::setw(12) << "p99" << std::setw(12) << "min" << std::setw(12) << "iterations"
+              << "   (ns/op)\n";
+        for (result const& r : i_results) {
+            o_out << std::left << std::setw(static_cast<int>(width)) << r.name << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << r.median << std::setw(12) << r.p99 << std::setw(12)
+                  << r.min << std::setw(12) << r.iterations << "\n";
+        }
+        break;
+    }
+    case options::output::csv:
+        o_out << "name,median_ns,p99_ns,min_ns,mean_ns,iterations,repetitions\n";
+        o_out << std::setprecision(6);
+        for (result const& r : i_results) {
+            o_out << r.name << ',' << r.median << ',' << r.p99 << ',' << r.min << ',' << r.mean << ',' << r.iterations
+                  << ',' << r.repetitions << "\n";
+        }
+        break;
+    case options::output::json:
+        o_out << "{\n  \"metadata\": {";
+        for (std::size_t i = 0; i < i_metadata.size(); ++i) {
+            o_out << (i ? ",\n    " : "\n    ");
+            write_json_string(o_out, i_metadata[i].first);
+            o_out << ": ";
+            write_json_string(o_out, i_metadata[i].second);
+        }
+        o_out << "\n  },\n  \"benchmarks\": [";
+        o_out << std::setprecision(6);
+        for (std::size_t i = 0; i < i_results.size(); ++i) {
+            result const& r = i_results[i];
+            o_out << (i ? ",\n    {" : "\n    {") << "\"name\": ";
+            write_json_string(o_out, r.name);
+            o_out << ", \"median_ns\": " << r.median << ", \"p99_ns\": " << r.p99 << ", \"min_ns\": " << r.min
+                  << ", \"mean_ns\": " << r.mean << ", \"iterations\": " << r.iterations
+                  << ", \"repetitions\": " << r.repetitions << "}";
+        }
+        o_out << "\n  ]\n}\n";
+        break;
+    }
+}
+
+} // namespace bench
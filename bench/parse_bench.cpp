@@ -0,0 +1,103 @@
+#include <cstring>
+#include <string>
+#include "benchmarks.hpp"
+#include "dim/si.hpp"
+#include "dim/si/quantity_parser_driver.hpp"
+#include "dim/si/unit_string_parser.hpp"
+
+/*
+ * Parsing: splitting text with from_chars, parse_quantity answered from the
+ * default format map and from the fallback parser (through its cache), the
+ * fallback parsers on their own, and whole strings with from_string.
+ */
+
+using namespace dim::si;
+
+namespace bench
+{
+
+namespace
+{
+
+/// Unit strings that are not in any format map, so they go to the fallback parser
+char const* const kCompound[] = {"Mg*m/s^2", "mm/s", "kN*m", "mol/L", "(m/s)^2", "μm", "kg*m^2", "GHz"};
+std::size_t const kCompoundCount = sizeof(kCompound) / sizeof(kCompound[0]);
+
+} // namespace
+
+void add_parse_benchmarks(suite& io_suite)
+{
+    static std::string const map_text = "123.25_lbf";
+    static std::string const fallback_text = "123.25_Mg*m/s^2";
+    static si::codec const parser{std::locale()};
+
+    io_suite.add("parse/from_chars", [] {
+        double value = 0.0;
+        char const* symbol = nullptr;
+        std::size_t length = 0;
+        dim::from_chars(map_text.data(), map_text.data() + map_text.size(), value, symbol, length);
+        return value + static_cast<double>(length);
+    });
+
+    io_suite.add("parse/parse_quantity/map", [] {
+        Force force;
+        parse_quantity(force, 123.25, "lbf", 3);
+        return dimensionless_cast(force);
+    });
+
+    io_suite.add("parse/parse_quantity/fallback_cached", [] {
+        Force force;
+        parse_quantity(force, 123.25, "Mg*m/s^2", 8);
+        return dimensionless_cast(force);
+    });
+
+    io_suite.add(
+        "parse/unit_string_parser",
+        [] {
+            double sum = 0.0;
+            for (char const* text : kCompound) {
+                sum += dim::detail::unit_string_parser(text, text + std::strlen(text)).parse().value();
+            }
+            return sum;
+        },
+        kCompoundCount);
+
+    io_suite.add(
+        "parse/bison_parser",
+        [] {
+            double sum = 0.0;
+            for (char const* text : kCompound) {
+                dim::si::detail::quantity_parser_driver driver;
+                driver.parse(text, text + std::strlen(text));
+                sum += driver.result.value();
+            }
+            return sum;
+        },
+        kCompoundCount);
+
+    io_suite.add("parse/from_string/map", [] {
+        Force force;
+        dim::from_string(force, map_text.data(), map_text.size());
+        return dimensionless_cast(force);
+    });
+
+    io_suite.add("parse/from_string/fallback", [] {
+        Force force;
+        dim::from_string(force, fallback_text.data(), fallback_text.size());
+        return dimensionless_cast(force);
+    });
+
+    io_suite.add("parse/from_string/dynamic", [] {
+        si::dynamic_quantity force(0.0, si::dynamic_unit::dimensionless());
+        dim::from_string(force, map_text.data(), map_text.size());
+        return force.value();
+    });
+
+    io_suite.add("parse/codec/map", [] {
+        Force force;
+        parser.parse(force, map_text.data(), map_text.size());
+        return dimensionless_cast(force);
+    });
+}
+
+} // namespace bench
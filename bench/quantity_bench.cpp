@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <cstring>
+#include <locale>
+#include "benchmarks.hpp"
+#include "dim/si.hpp"
+
+/*
+ * Run-time quantities: dynamic_quantity arithmetic and casts, with the static
+ * quantity equivalent for scale, and finding formats by symbol and by unit in
+ * the facet's input_format_map_group.
+ *
+ * The operands cycle through small arrays so the compiler cannot hoist the
+ * arithmetic out of the timing loop.
+ */
+
+using namespace dim::si;
+
+namespace bench
+{
+
+namespace
+{
+
+std::size_t const kOperands = 8;
+
+/// Returns 0, 1, ..., kOperands - 1, 0, ... on successive calls
+std::size_t next_operand()
+{
+    static std::size_t i = 0;
+    i = (i + 1) % kOperands;
+    return i;
+}
+
+} // namespace
+
+void add_quantity_benchmarks(suite& io_suite)
+{
+    static Length lengths[kOperands];
+    static Time times[kOperands];
+    static si::dynamic_quantity dynamic_lengths[kOperands];
+    static si::dynamic_quantity dynamic_times[kOperands];
+    for (std::size_t i = 0; i < kOperands; ++i) {
+        lengths[i] = static_cast<double>(i + 1) * meter;
+        times[i] = static_cast<double>(i + 2) * second;
+        dynamic_lengths[i] = si::dynamic_quantity(lengths[i]);
+        dynamic_times[i] = si::dynamic_quantity(times[i]);
+    }
+
+    io_suite.add("quantity/static/divide", [] {
+        std::size_t i = next_operand();
+        return dimensionless_cast(lengths[i] / times[i]);
+    });
+
+    io_suite.add("quantity/dynamic/multiply", [] {
+        std::size_t i = next_operand();
+        return (dynamic_lengths[i] * dynamic_times[i]).value();
+    });
+
+    io_suite.add("quantity/dynamic/divide", [] {
+        std::size_t i = next_operand();
+        return (dynamic_lengths[i] / dynamic_times[i]).value();
+    });
+
+    io_suite.add("quantity/dynamic/add", [] {
+        std::size_t i = next_operand();
+        return (dynamic_lengths[i] + dynamic_lengths[kOperands - 1 - i]).value();
+    });
+
+    io_suite.add("quantity/dynamic/power", [] {
+        std::size_t i = next_operand();
+        return dim::power(dynamic_lengths[i], 3).value();
+    });
+
+    io_suite.add("quantity/dynamic/as", [] {
+        std::size_t i = next_operand();
+        return dimensionless_cast(dynamic_lengths[i].as<Length>());
+    });
+
+    static std::locale const locale;
+    static si::input_format_map_group const& group = std::use_facet<si::facet>(locale).input_formats();
+    static char const* const symbols[kOperands] = {"lbf", "ft", "psi", "mph", "kPa", "in", "lb", "mi"};
+    static si::dynamic_unit const units[kOperands] = {
+        dim::index<Force>(), dim::index<Length>(),   dim::index<Pressure>(), dim::index<Speed>(),
+        dim::index<Power>(), dim::index<Volume>(), dim::index<Mass>(),     dim::index<Temperature>()};
+
+    io_suite.add("lookup/group/symbol", [] {
+        std::size_t i = next_operand();
+        return group.to_quantity(1.5, symbols[i]).value();
+    });
+
+    io_suite.add("lookup/group/unit", [] {
+        std::size_t i = next_operand();
+        return group.get(units[i]) != nullptr;
+    });
+
+    io_suite.add("lookup/group/parse_quantity", [] {
+        std::size_t i = next_operand();
+        si::dynamic_quantity q(0.0, si::dynamic_unit::dimensionless());
+        parse_quantity(q, 1.5, symbols[i], std::strlen(symbols[i]), group);
+        return q.value();
+    });
+}
+
+} // namespace bench
@@ -0,0 +1,101 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "benchmarks.hpp"
+#include "dim/format_registry.hpp"
+#include "dim/si.hpp"
+
+/*
+ * Reloadable formats: reading the current snapshot of a format_registry,
+ * formatting through it, and loading a new one. The reader benchmarks run
+ * kReaders threads, with and without a writer reloading every millisecond,
+ * and report ns per formatted value.
+ */
+
+using namespace dim::si;
+
+namespace bench
+{
+
+namespace
+{
+
+using registry = dim::format_registry<double, dim::si::system>;
+
+int const kReaders = 4;
+std::size_t const kValuesPerReader = 10000;
+char const* const kConfigs[] = {"output psi 6894.757293168_Pa\n", "output kPa 1000_Pa\n"};
+
+/// Load one of the two test configurations into i_formats
+bool reload(registry& i_formats, std::size_t i_which)
+{
+    std::istringstream input(kConfigs[i_which % 2]);
+    return i_formats.load(input);
+}
+
+/// Format kValuesPerReader values on each of kReaders threads, reloading meanwhile if i_reload is set
+double format_on_readers(registry& i_formats, bool i_reload)
+{
+    static Pressure const pressure = 101325.0 * pascal;
+    std::atomic<bool> done(false);
+    std::thread writer([&] {
+        for (std::size_t i = 0; i_reload && !done.load(); ++i) {
+            reload(i_formats, i);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+    std::atomic<std::size_t> total(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < kReaders; ++t) {
+        readers.emplace_back([&] {
+            char buffer[64];
+            std::size_t length = 0;
+            for (std::size_t i = 0; i < kValuesPerReader; ++i) {
+                length += i_formats.current()->codec().to_chars(buffer, buffer + sizeof(buffer), pressure).ptr - buffer;
+            }
+            total += length;
+        });
+    }
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    done = true;
+    writer.join();
+    return static_cast<double>(total.load());
+}
+
+} // namespace
+
+void add_registry_benchmarks(suite& io_suite)
+{
+    static std::unique_ptr<si::facet> defaults(system::make_default_facet());
+    static registry formats(*defaults);
+    reload(formats, 1);
+    static Pressure const pressure = 101325.0 * pascal;
+
+    io_suite.add("registry/current", [] { return formats.current().get() != nullptr; });
+
+    io_suite.add("registry/to_chars", [] {
+        char buffer[64];
+        return formats.current()->codec().to_chars(buffer, buffer + sizeof(buffer), pressure).ptr - buffer;
+    });
+
+    io_suite.add("registry/load", [] {
+        static std::size_t i = 0;
+        return reload(formats, ++i);
+    });
+
+    io_suite.add(
+        "registry/to_chars/readers", [] { return format_on_readers(formats, false); }, kReaders * kValuesPerReader);
+
+    io_suite.add(
+        "registry/to_chars/readers+reload", [] { return format_on_readers(formats, true); },
+        kReaders * kValuesPerReader);
+}
+
+} // namespace bench
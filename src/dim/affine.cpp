@@ -0,0 +1,233 @@
+#include "io_detail.hpp"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DIM_AFFINE_X86
+#include <immintrin.h>
+#endif
+
+/*
+ * Kernels for formatter's bulk conversions. Each kernel computes
+ * (x + shift) * scale + offset, or with Divide set (x + shift) / scale + offset,
+ * with separate operations (never a fused multiply-add, so this file is built
+ * with -ffp-contract=off). Every kernel then rounds the same, whichever
+ * instruction set is chosen at run time. The single-value conversions are
+ * compiled in the caller's code, which may fuse them (GCC does by default for
+ * FMA targets such as -march=haswell, and on ARM), so they can differ from
+ * the kernels in the last bit.
+ */
+
+namespace dim
+{
+
+namespace detail
+{
+
+namespace
+{
+
+template <bool Divide, class Scalar>
+void affine_scalar(Scalar const* i_values, Scalar* o_values, std::size_t i_count, Scalar i_shift, Scalar i_scale,
+                   Scalar i_offset)
+{
+    for (std::size_t i = 0; i < i_count; ++i) {
+        o_values[i] = (Divide ? (i_values[i] + i_shift) / i_scale : (i_values[i] + i_shift) * i_scale) + i_offset;
+    }
+}
+
+#ifdef DIM_AFFINE_X86
+// Multiply or divide by the scale
+template <bool Divide> __attribute__((target("avx2"))) __m256d apply_scale(__m256d a, __m256d scale)
+{
+    return Divide ? _mm256_div_pd(a, scale) : _mm256_mul_pd(a, scale);
+}
+
+template <bool Divide> __attribute__((target("avx2"))) __m256 apply_scale(__m256 a, __m256 scale)
+{
+    return Divide ? _mm256_div_ps(a, scale) : _mm256_mul_ps(a, scale);
+}
+
+template <bool Divide> __attribute__((target("avx512f"))) __m512d apply_scale(__m512d a, __m512d scale)
+{
+    return Divide ? _mm512_div_pd(a, scale) : _mm512_mul_pd(a, scale);
+}
+
+template <bool Divide> __attribute__((target("avx512f"))) __m512 apply_scale(__m512 a, __m512 scale)
+{
+    return Divide ? _mm512_div_ps(a, scale) : _mm512_mul_ps(a, scale);
+}
+
+template <bool Divide>
+__attribute__((target("avx2"))) void affine_avx2(double const* i_values, double* o_values, std::size_t i_count,
+                                                 double i_shift, double i_scale, double i_offset)
+{
+    __m256d shift = _mm256_set1_pd(i_shift);
+    __m256d scale = _mm256_set1_pd(i_scale);
+    __m256d offset = _mm256_set1_pd(i_offset);
+    std::size_t i = 0;
+    for (; i + 8 <= i_count; i += 8) {
+        __m256d a = _mm256_loadu_pd(i_values + i);
+        __m256d b = _mm256_loadu_pd(i_values + i + 4);
+        a = _mm256_add_pd(apply_scale<Divide>(_mm256_add_pd(a, shift), scale), offset);
+        b = _mm256_add_pd(apply_scale<Divide>(_mm256_add_pd(b, shift), scale), offset);
+        _mm256_storeu_pd(o_values + i, a);
+        _mm256_storeu_pd(o_values + i + 4, b);
+    }
+    affine_scalar<Divide>(i_values + i, o_values + i, i_count - i, i_shift, i_scale, i_offset);
+}
+
+template <bool Divide>
+__attribute__((target("avx2"))) void affine_avx2(float const* i_values, float* o_values, std::size_t i_count,
+                                                 float i_shift, float i_scale, float i_offset)
+{
+    __m256 shift = _mm256_set1_ps(i_shift);
+    __m256 scale = _mm256_set1_ps(i_scale);
+    __m256 offset = _mm256_set1_ps(i_offset);
+    std::size_t i = 0;
+    for (; i + 16 <= i_count; i += 16) {
+        __m256 a = _mm256_loadu_ps(i_values + i);
+        __m256 b = _mm256_loadu_ps(i_values + i + 8);
+        a = _mm256_add_ps(apply_scale<Divide>(_mm256_add_ps(a, shift), scale), offset);
+        b = _mm256_add_ps(apply_scale<Divide>(_mm256_add_ps(b, shift), scale), offset);
+        _mm256_storeu_ps(o_values + i, a);
+        _mm256_storeu_ps(o_values + i + 8, b);
+    }
+    affine_scalar<Divide>(i_values + i, o_values + i, i_count - i, i_shift, i_scale, i_offset);
+}
+
+template <bool Divide>
+__attribute__((target("avx512f"))) void affine_avx512(double const* i_values, double* o_values, std::size_t i_count,
+                                                      double i_shift, double i_scale, double i_offset)
+{
+    __m512d shift = _mm512_set1_pd(i_shift);
+    __m512d scale = _mm512_set1_pd(i_scale);
+    __m512d offset = _mm512_set1_pd(i_offset);
+    std::size_t i = 0;
+    for (; i + 8 <= i_count; i += 8) {
+        __m512d a = _mm512_loadu_pd(i_values + i);
+        a = _mm512_add_pd(apply_scale<Divide>(_mm512_add_pd(a, shift), scale), offset);
+        _mm512_storeu_pd(o_values + i, a);
+    }
+    if (i < i_count) {
+        __mmask8 tail = static_cast<__mmask8>((1u << (i_count - i)) - 1u);
+        __m512d a = _mm512_maskz_loadu_pd(tail, i_values + i);
+        a = _mm512_add_pd(apply_scale<Divide>(_mm512_add_pd(a, shift), scale), offset);
+        _mm512_mask_storeu_pd(o_values + i, tail, a);
+    }
+}
+
+template <bool Divide>
+__attribute__((target("avx512f"))) void affine_avx512(float const* i_values, float* o_values, std::size_t i_count,
+                                                      float i_shift, float i_scale, float i_offset)
+{
+    __m512 shift = _mm512_set1_ps(i_shift);
+    __m512 scale = _mm512_set1_ps(i_scale);
+    __m512 offset = _mm512_set1_ps(i_offset);
+    std::size_t i = 0;
+    for (; i + 16 <= i_count; i += 16) {
+        __m512 a = _mm512_loadu_ps(i_values + i);
+        a = _mm512_add_ps(apply_scale<Divide>(_mm512_add_ps(a, shift), scale), offset);
+        _mm512_storeu_ps(o_values + i, a);
+    }
+    if (i < i_count) {
+        __mmask16 tail = static_cast<__mmask16>((1u << (i_count - i)) - 1u);
+        __m512 a = _mm512_maskz_loadu_ps(tail, i_values + i);
+        a = _mm512_add_ps(apply_scale<Divide>(_mm512_add_ps(a, shift), scale), offset);
+        _mm512_mask_storeu_ps(o_values + i, tail, a);
+    }
+}
+#endif
+
+/// Instruction sets, best first
+enum class affine_isa { kAvx512, kAvx2, kScalar };
+
+affine_isa detect_isa()
+{
+#ifdef DIM_AFFINE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return affine_isa::kAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return affine_isa::kAvx2;
+    }
+#endif
+    return affine_isa::kScalar;
+}
+
+/// The instruction set used by the kernels, checked once
+affine_isa kernel_isa()
+{
+    static affine_isa const s_isa = detect_isa();
+    return s_isa;
+}
+
+template <bool Divide, class Scalar>
+void dispatch(Scalar const* i_values, Scalar* o_values, std::size_t i_count, Scalar i_shift, Scalar i_scale,
+              Scalar i_offset)
+{
+    switch (kernel_isa()) {
+#ifdef DIM_AFFINE_X86
+    case affine_isa::kAvx512:
+        affine_avx512<Divide>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+        return;
+    case affine_isa::kAvx2:
+        affine_avx2<Divide>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+        return;
+#endif
+    default:
+        affine_scalar<Divide>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+        return;
+    }
+}
+
+} // namespace
+
+void affine_transform(double const* i_values, double* o_values, std::size_t i_count, double i_shift, double i_scale,
+                      double i_offset)
+{
+    dispatch<false>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+}
+
+void affine_transform(float const* i_values, float* o_values, std::size_t i_count, float i_shift, float i_scale,
+                      float i_offset)
+{
+    dispatch<false>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+}
+
+void affine_divide(double const* i_values, double* o_values, std::size_t i_count, double i_shift, double i_scale,
+                   double i_offset)
+{
+    dispatch<true>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+}
+
+void affine_divide(float const* i_values, float* o_values, std::size_t i_count, float i_shift, float i_scale,
+                   float i_offset)
+{
+    dispatch<true>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+}
+
+void affine_transform_scalar(double const* i_values, double* o_values, std::size_t i_count, double i_shift,
+                             double i_scale, double i_offset)
+{
+    affine_scalar<false>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+}
+
+void affine_transform_scalar(float const* i_values, float* o_values, std::size_t i_count, float i_shift,
+                             float i_scale, float i_offset)
+{
+    affine_scalar<false>(i_values, o_values, i_count, i_shift, i_scale, i_offset);
+}
+
+char const* affine_transform_isa()
+{
+    switch (kernel_isa()) {
+    case affine_isa::kAvx512:
+        return "avx512f";
+    case affine_isa::kAvx2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+} // namespace detail
+} // namespace dim
@@ -0,0 +1,414 @@
+#pragma once
+#include "dynamic_quantity.hpp"
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#ifdef DIM_EXCEPTIONS
+#include "incommensurable_exception.hpp"
+#include <stdexcept>
+#endif
+
+/**
+ * Binary encoding of quantities, for passing large buffers between processes
+ * without formatting and parsing text.
+ *
+ * An encoding starts with a 16-byte header:
+ *
+ * | Bytes | Contents                                                   |
+ * |-------|------------------------------------------------------------|
+ * | 0-3   | The magic "DIMB"                                           |
+ * | 4     | Format version (kBinaryVersion)                            |
+ * | 5     | Flags: bit 0 is set if the numbers are big-endian          |
+ * | 6     | Size of the scalar in bytes                                |
+ * | 7     | Kind of scalar: 0 for floating point, 1 for integer        |
+ * | 8-15  | The system id (e.g. si::system::id)                        |
+ *
+ * and is followed by blocks, each a 16-byte block header (the dynamic_unit
+ * raw() code then the number of values, both 64-bit) and the bits of that
+ * many scalars. A block holds a run of values with the same unit, so a span of
+ * static quantities is one block and a span of dynamic quantities has a block
+ * per run of equal units. The 8-byte headers keep 8-byte scalars aligned.
+ */
+
+namespace dim
+{
+
+/// Version of the binary encoding written by binary_writer
+constexpr uint8_t kBinaryVersion = 1;
+
+/// Byte order of the numbers in a binary encoding
+enum class byte_order { little, big };
+
+/// Errors found by binary_reader
+enum class binary_error {
+    none,           ///< No error
+    truncated,      ///< The data ends inside a header or a block
+    bad_header,     ///< The data does not start with a binary header
+    bad_version,    ///< The data is in a newer format version
+    wrong_scalar,   ///< The data holds a different scalar type
+    wrong_system,   ///< The data holds units of a different system
+    incommensurable, ///< A block's unit is not the unit being read
+    unreadable,      ///< The file could not be opened or mapped
+    wrong_byte_order ///< The data is in the other byte order, and cannot be used in place
+};
+
+namespace detail
+{
+
+/// Byte order of this machine
+constexpr byte_order native_byte_order()
+{
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return byte_order::big;
+#else
+    return byte_order::little;
+#endif
+}
+
+constexpr std::size_t kBinaryHeaderSize = 16;
+constexpr std::size_t kBinaryBlockHeaderSize = 16;
+
+inline uint16_t byte_swap(uint16_t i_v) { return static_cast<uint16_t>((i_v >> 8) | (i_v << 8)); }
+
+inline uint32_t byte_swap(uint32_t i_v)
+{
+#if defined(__GNUC__)
+    return __builtin_bswap32(i_v);
+#else
+    return (i_v >> 24) | ((i_v >> 8) & 0xff00u) | ((i_v << 8) & 0xff0000u) | (i_v << 24);
+#endif
+}
+
+inline uint64_t byte_swap(uint64_t i_v)
+{
+#if defined(__GNUC__)
+    return __builtin_bswap64(i_v);
+#else
+    return (static_cast<uint64_t>(byte_swap(static_cast<uint32_t>(i_v))) << 32) |
+           byte_swap(static_cast<uint32_t>(i_v >> 32));
+#endif
+}
+
+inline uint8_t byte_swap(uint8_t i_v) { return i_v; }
+
+/// The unsigned integer with the bits of a Scalar
+template <std::size_t Size> struct scalar_bits;
+template <> struct scalar_bits<1> {
+    using type = uint8_t;
+};
+template <> struct scalar_bits<2> {
+    using type = uint16_t;
+};
+template <> struct scalar_bits<4> {
+    using type = uint32_t;
+};
+template <> struct scalar_bits<8> {
+    using type = uint64_t;
+};
+
+/// Copy i_count values of size sizeof(T) from i_source to o_dest, swapping their bytes if i_swap
+template <class T> void copy_ordered(void* o_dest, void const* i_source, std::size_t i_count, bool i_swap)
+{
+    if (!i_swap) {
+        std::memcpy(o_dest, i_source, i_count * sizeof(T));
+        return;
+    }
+    unsigned char* dest = static_cast<unsigned char*>(o_dest);
+    unsigned char const* source = static_cast<unsigned char const*>(i_source);
+    for (std::size_t i = 0; i < i_count; ++i) {
+        T bits;
+        std::memcpy(&bits, source + i * sizeof(T), sizeof(T));
+        bits = byte_swap(bits);
+        std::memcpy(dest + i * sizeof(T), &bits, sizeof(T));
+    }
+}
+
+/// Fill the 16-byte header of an encoding of Scalar in System, with the given magic
+template <class Scalar, class System>
+void write_binary_header(unsigned char* o_header, char const* i_magic, byte_order i_order)
+{
+    std::memcpy(o_header, i_magic, 4);
+    o_header[4] = kBinaryVersion;
+    o_header[5] = (i_order == byte_order::big ? 1 : 0);
+    o_header[6] = static_cast<unsigned char>(sizeof(Scalar));
+    o_header[7] = (std::is_floating_point<Scalar>::value ? 0 : 1);
+    int64_t id = static_cast<int64_t>(System::id);
+    copy_ordered<uint64_t>(o_header + 8, &id, 1, i_order != native_byte_order());
+}
+
+/**
+ * Check the header of i_size bytes of an encoding of Scalar in System with
+ * the given magic, and whether its numbers need their bytes swapped.
+ */
+template <class Scalar, class System>
+binary_error check_binary_header(unsigned char const* i_data, std::size_t i_size, char const* i_magic, bool& o_swap)
+{
+    if (i_size < kBinaryHeaderSize) {
+        return (i_size < 4 || std::memcmp(i_data, i_magic, 4) == 0 ? binary_error::truncated
+                                                                   : binary_error::bad_header);
+    }
+    if (std::memcmp(i_data, i_magic, 4) != 0 || (i_data[5] & ~1) != 0) {
+        return binary_error::bad_header;
+    }
+    if (i_data[4] > kBinaryVersion) {
+        return binary_error::bad_version;
+    }
+    o_swap = ((i_data[5] & 1) ? byte_order::big : byte_order::little) != native_byte_order();
+    if (i_data[6] != sizeof(Scalar) || i_data[7] != (std::is_floating_point<Scalar>::value ? 0 : 1)) {
+        return binary_error::wrong_scalar;
+    }
+    int64_t id;
+    copy_ordered<uint64_t>(&id, i_data + 8, 1, o_swap);
+    return (id == static_cast<int64_t>(System::id) ? binary_error::none : binary_error::wrong_system);
+}
+
+/// A description of each binary_error
+inline char const* binary_error_message(binary_error i_error)
+{
+    static char const* const kMessages[] = {"",
+                                            "Binary quantity data is truncated",
+                                            "Binary quantity data has no valid header",
+                                            "Binary quantity data has a newer version",
+                                            "Binary quantity data has a different scalar type",
+                                            "Binary quantity data is from a different system of units",
+                                            "Binary block has the wrong unit",
+                                            "Binary quantity file could not be read",
+                                            "Binary quantity data is in the other byte order"};
+    return kMessages[static_cast<int>(i_error)];
+}
+
+} // namespace detail
+
+/**
+ * @brief Appends quantities to a buffer in the binary encoding.
+ *
+ * The header is written when the writer is made. Each write() of static
+ * quantities adds one block; each write() of dynamic quantities adds a block
+ * per run of equal units.
+ * ```
+ * std::vector<unsigned char> buffer;
+ * dim::binary_writer<double, si::system> writer(buffer);
+ * writer.write(lengths);            // A std::vector<si::Length>, quantity_array, ...
+ * writer.write(readings.data(), n); // si::dynamic_quantity values
+ * ```
+ */
+template <class Scalar, class System>
+class binary_writer
+{
+  public:
+    using scalar = Scalar;
+    using system = System;
+    using dynamic_type = dynamic_quantity<scalar, system>;
+    using bits_type = typename detail::scalar_bits<sizeof(scalar)>::type;
+
+    /// Append the header to io_buffer. Later writes append blocks.
+    explicit binary_writer(std::vector<unsigned char>& io_buffer, byte_order i_order = byte_order::little)
+        : m_buffer(io_buffer),
+          m_swap(i_order != detail::native_byte_order())
+    {
+        detail::write_binary_header<Scalar, System>(extend(detail::kBinaryHeaderSize), "DIMB", i_order);
+    }
+
+    /// Write i_count static quantities as one block
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    void write(Q const* i_values, std::size_t i_count)
+    {
+        static_assert(std::is_same<typename Q::scalar, scalar>::value, "Quantity scalar must match the writer");
+        DIM_CHECK_SYSTEMS(Q::unit, dynamic_type);
+        unsigned char* block = write_block_header(index<typename Q::unit>(), i_count);
+        detail::copy_ordered<bits_type>(block, i_values, i_count, m_swap);
+    }
+
+    /// Write i_count dynamic quantities, one block per run of equal units
+    void write(dynamic_type const* i_values, std::size_t i_count)
+    {
+        std::size_t first = 0;
+        while (first < i_count) {
+            std::size_t last = first + 1;
+            while (last < i_count && i_values[last].unit() == i_values[first].unit()) {
+                ++last;
+            }
+            unsigned char* block = write_block_header(i_values[first].unit(), last - first);
+            for (std::size_t i = first; i < last; ++i) {
+                scalar value = i_values[i].value();
+                detail::copy_ordered<bits_type>(block + (i - first) * sizeof(scalar), &value, 1, m_swap);
+            }
+            first = last;
+        }
+    }
+
+    /// Write the values of a container with data() and size() (std::vector, quantity_span, ...)
+    template <class Container> void write(Container const& i_values) { write(i_values.data(), i_values.size()); }
+
+  private:
+    unsigned char* extend(std::size_t i_bytes)
+    {
+        std::size_t offset = m_buffer.size();
+        m_buffer.resize(offset + i_bytes);
+        return m_buffer.data() + offset;
+    }
+
+    // Append a block header and room for i_count values, returning where the values go
+    unsigned char* write_block_header(dynamic_unit<System> const& i_unit, std::size_t i_count)
+    {
+        unsigned char* header = extend(detail::kBinaryBlockHeaderSize + i_count * sizeof(scalar));
+        uint64_t fields[2] = {i_unit.raw(), static_cast<uint64_t>(i_count)};
+        detail::copy_ordered<uint64_t>(header, fields, 2, m_swap);
+        return header + detail::kBinaryBlockHeaderSize;
+    }
+
+    std::vector<unsigned char>& m_buffer;
+    bool m_swap;
+};
+
+/**
+ * @brief Reads quantities from a buffer in the binary encoding.
+ *
+ * The header is checked when the reader is made: the scalar must match
+ * Scalar, and the system id must match System. read() then fills values
+ * from successive blocks, in either byte order, and returns how many it
+ * read. Static quantities are read across blocks until one has another
+ * unit, where read() stops early; reading that block as the same quantity
+ * again is an error.
+ *
+ * On a bad header, truncated data, or a block in another unit, the reader
+ * stops, and error() says why. If DIM_EXCEPTIONS is set, these throw instead:
+ * incommensurable_exception for a unit mismatch, std::runtime_error
+ * otherwise.
+ * ```
+ * dim::binary_reader<double, si::system> reader(buffer.data(), buffer.size());
+ * std::vector<si::Length> lengths(count);
+ * reader.read(lengths);
+ * ```
+ */
+template <class Scalar, class System>
+class binary_reader
+{
+  public:
+    using scalar = Scalar;
+    using system = System;
+    using dynamic_type = dynamic_quantity<scalar, system>;
+    using bits_type = typename detail::scalar_bits<sizeof(scalar)>::type;
+
+    /// A reader of the i_size bytes at i_data, which must outlive it
+    binary_reader(unsigned char const* i_data, std::size_t i_size)
+        : m_position(i_data),
+          m_end(i_data + i_size),
+          m_swap(false),
+          m_block_code(0),
+          m_block_remaining(0),
+          m_error(binary_error::none)
+    {
+        binary_error error = detail::check_binary_header<Scalar, System>(i_data, i_size, "DIMB", m_swap);
+        if (error != binary_error::none) {
+            fail(error);
+            return;
+        }
+        m_position += detail::kBinaryHeaderSize;
+    }
+
+    /// The error that stopped the reader, or binary_error::none
+    binary_error error() const { return m_error; }
+
+    /// True if no error has been found
+    bool ok() const { return m_error == binary_error::none; }
+
+    /// True if every value has been read (or the reader has stopped on an error)
+    bool at_end() const { return !ok() || (m_block_remaining == 0 && m_position == m_end); }
+
+    /// Read up to i_count static quantities into o_values
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    std::size_t read(Q* o_values, std::size_t i_count)
+    {
+        static_assert(std::is_same<typename Q::scalar, scalar>::value, "Quantity scalar must match the reader");
+        DIM_CHECK_SYSTEMS(Q::unit, dynamic_type);
+        std::size_t done = 0;
+        while (done < i_count && next_block()) {
+            if (m_block_code != index<typename Q::unit>().raw()) {
+                if (done != 0) {
+                    break;
+                }
+#ifdef DIM_EXCEPTIONS
+                m_error = binary_error::incommensurable;
+                throw incommensurable_exception(dynamic_unit<System>(m_block_code), index<typename Q::unit>(),
+                                                "Binary block has the wrong unit");
+#else
+                fail(binary_error::incommensurable);
+                break;
+#endif
+            }
+            std::size_t count = std::min(i_count - done, m_block_remaining);
+            detail::copy_ordered<bits_type>(o_values + done, m_position, count, m_swap);
+            advance(count);
+            done += count;
+        }
+        return done;
+    }
+
+    /// Read up to i_count dynamic quantities into o_values
+    std::size_t read(dynamic_type* o_values, std::size_t i_count)
+    {
+        std::size_t done = 0;
+        while (done < i_count && next_block()) {
+            dynamic_unit<System> unit(m_block_code);
+            std::size_t count = std::min(i_count - done, m_block_remaining);
+            for (std::size_t i = 0; i < count; ++i) {
+                scalar value;
+                detail::copy_ordered<bits_type>(&value, m_position + i * sizeof(scalar), 1, m_swap);
+                o_values[done + i] = dynamic_type(value, unit);
+            }
+            advance(count);
+            done += count;
+        }
+        return done;
+    }
+
+    /// Read into the values of a container with data() and size() (std::vector, quantity_span, ...)
+    template <class Container> std::size_t read(Container&& o_values) { return read(o_values.data(), o_values.size()); }
+
+  private:
+    // Make sure there is a block with values left, reading its header if needed
+    bool next_block()
+    {
+        while (ok() && m_block_remaining == 0 && m_position != m_end) {
+            if (static_cast<std::size_t>(m_end - m_position) < detail::kBinaryBlockHeaderSize) {
+                fail(binary_error::truncated);
+                break;
+            }
+            uint64_t fields[2];
+            detail::copy_ordered<uint64_t>(fields, m_position, 2, m_swap);
+            m_position += detail::kBinaryBlockHeaderSize;
+            if (fields[1] > static_cast<uint64_t>(m_end - m_position) / sizeof(scalar)) {
+                fail(binary_error::truncated);
+                break;
+            }
+            m_block_code = fields[0];
+            m_block_remaining = static_cast<std::size_t>(fields[1]);
+        }
+        return ok() && m_block_remaining != 0;
+    }
+
+    void advance(std::size_t i_count)
+    {
+        m_position += i_count * sizeof(scalar);
+        m_block_remaining -= i_count;
+    }
+
+    void fail(binary_error i_error)
+    {
+        m_error = i_error;
+#ifdef DIM_EXCEPTIONS
+        throw std::runtime_error(detail::binary_error_message(i_error));
+#endif
+    }
+
+    unsigned char const* m_position;
+    unsigned char const* m_end;
+    bool m_swap;
+    uint64_t m_block_code;
+    std::size_t m_block_remaining;
+    binary_error m_error;
+};
+
+} // namespace dim
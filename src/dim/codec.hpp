@@ -0,0 +1,237 @@
+#pragma once
+#include "facet.hpp"
+#include <locale>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#ifdef DIM_EXCEPTIONS
+#include "dim/incommensurable_exception.hpp"
+#endif
+
+namespace dim
+{
+
+/**
+ * @brief Reads and writes quantities with a fixed set of format maps.
+ *
+ * to_chars(), from_string() and the stream operators find the facet in a
+ * locale on every call. A codec does that once, when it is made, and then
+ * parses and formats with the maps it resolved, touching no locale at all.
+ * All members are const and keep no state between calls, so one codec can be
+ * shared by any number of threads as long as nothing changes the facet (or
+ * maps) it was made from.
+ *
+ * ```
+ * si::codec const codec(std::locale()); // Once, e.g. at startup
+ * ...
+ * si::Length length;
+ * codec.parse(length, field, field_length); // In the hot loop
+ * ```
+ */
+template <class Scalar, class System>
+class quantity_codec
+{
+  public:
+    using scalar = Scalar;
+    using system = System;
+    using dynamic_type = dynamic_quantity<scalar, system>;
+    using formatted = formatted_quantity<scalar>;
+    using map_type = input_format_map<scalar, system>;
+    using map_group_type = input_format_map_group<scalar, system>;
+    using output_map_type = output_format_map<scalar, system>;
+
+    /**
+     * A codec with no format maps: input uses the default formats and the
+     * system's parser, output uses print_unit().
+     */
+    quantity_codec()
+        : m_locale(std::locale::classic()),
+          m_input(&no_maps()),
+          m_output(nullptr)
+    {
+    }
+
+    /**
+     * A codec using the facet of i_locale, or no format maps if i_locale has
+     * no facet for System. The codec keeps a copy of i_locale, so the facet
+     * outlives later changes to the global locale.
+     */
+    explicit quantity_codec(std::locale const& i_locale)
+        : m_locale(i_locale),
+          m_input(&no_maps()),
+          m_output(nullptr)
+    {
+        using facet = typename System::facet;
+        if (std::has_facet<facet>(m_locale)) {
+            facet const& formats = std::use_facet<facet>(m_locale);
+            m_input = &formats.input_formats();
+            m_output = &formats.output_formats();
+        }
+    }
+
+    /**
+     * A codec using the given maps. The maps are not copied and must outlive
+     * the codec.
+     *
+     * @param i_input Input maps, or nullptr for the default formats
+     * @param i_output Output map, or nullptr to use print_unit()
+     */
+    quantity_codec(map_group_type const* i_input, output_map_type const* i_output)
+        : m_locale(std::locale::classic()),
+          m_input(i_input ? i_input : &no_maps()),
+          m_output(i_output)
+    {
+    }
+
+    /**
+     * @brief Convert a scalar and the symbol [i_symbol, i_symbol + i_length)
+     * to a quantity. On failure, o_quantity is a bad_quantity().
+     * @return True if the symbol is a unit of Q
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    bool parse(Q& o_quantity, scalar const& i_value, char const* i_symbol, std::size_t i_length) const
+    {
+#ifdef DIM_EXCEPTIONS
+        try {
+            return parse_typed(o_quantity, i_value, i_symbol, i_length);
+        } catch (incommensurable_exception const&) {
+            o_quantity = Q::bad_quantity();
+            return false;
+        }
+#else
+        return parse_typed(o_quantity, i_value, i_symbol, i_length);
+#endif
+    }
+
+    /**
+     * @brief Convert a scalar and the symbol [i_symbol, i_symbol + i_length)
+     * to a dynamic_quantity. On failure, o_quantity is a bad_quantity().
+     * @return True if the symbol was understood
+     */
+    template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+    bool parse(DQ& o_quantity, scalar const& i_value, char const* i_symbol, std::size_t i_length) const
+    {
+        return parse_quantity(o_quantity, i_value, i_symbol, i_length, *m_input);
+    }
+
+    /**
+     * @brief Convert a formatted_quantity to a quantity or dynamic_quantity.
+     */
+    template <class Q>
+    bool parse(Q& o_quantity, formatted const& i_formatted) const
+    {
+        return parse(o_quantity, i_formatted.value(), i_formatted.symbol(), detail::symbol_length(i_formatted.symbol()));
+    }
+
+    /**
+     * @brief Parse the text [i_text, i_text + i_length), like from_string().
+     * The text is read in place.
+     * @return True if parsing was successful
+     */
+    template <class Q>
+    bool parse(Q& o_quantity, char const* i_text, std::size_t i_length) const
+    {
+        return from_chars(i_text, i_text + i_length, o_quantity).ec == std::errc{};
+    }
+
+#if __cplusplus >= 201703L
+    /**
+     * @brief Parse a string_view, like from_string().
+     */
+    template <class Q>
+    bool parse(Q& o_quantity, std::string_view i_text) const
+    {
+        return parse(o_quantity, i_text.data(), i_text.size());
+    }
+#endif
+
+    /**
+     * @brief Read a quantity or dynamic_quantity from [i_first, i_last).
+     *
+     * The error codes are those of the formatted_quantity from_chars(), plus
+     * invalid_argument if the symbol is not a unit of Q. On error, o_quantity
+     * is a bad_quantity().
+     */
+    template <class Q>
+    std::from_chars_result from_chars(char const* i_first, char const* i_last, Q& o_quantity) const
+    {
+        scalar value;
+        char const* symbol;
+        std::size_t length;
+        std::from_chars_result result = ::dim::from_chars(i_first, i_last, value, symbol, length);
+        if (result.ec != std::errc{}) {
+            o_quantity = Q::bad_quantity();
+        } else if (!parse(o_quantity, value, symbol, length)) {
+            result.ec = std::errc::invalid_argument;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Format a quantity for output (convert to the output scalar
+     * value, assign symbol)
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    formatted format(Q const& i_quantity) const
+    {
+        formatted result;
+        format_quantity(result, i_quantity, m_output);
+        return result;
+    }
+
+    /**
+     * @brief Format a dynamic_quantity for output (convert to the output
+     * scalar value, assign symbol)
+     */
+    formatted format(dynamic_type const& i_quantity) const
+    {
+        formatted result;
+        format_quantity(result, i_quantity, m_output);
+        return result;
+    }
+
+    /**
+     * @brief Write a quantity or dynamic_quantity to [o_first, i_last) as the
+     * formatted_quantity to_chars() does, without allocating.
+     */
+    template <class Q>
+    std::to_chars_result to_chars(char* o_first, char* i_last, Q const& i_quantity) const
+    {
+        return ::dim::to_chars(o_first, i_last, format(i_quantity));
+    }
+
+    /**
+     * Input maps in use
+     */
+    map_group_type const& input_formats() const { return *m_input; }
+
+    /**
+     * Output map in use, or nullptr if there is none
+     */
+    output_map_type const* output_formats() const { return m_output; }
+
+  private:
+    template <class Q>
+    bool parse_typed(Q& o_quantity, scalar const& i_value, char const* i_symbol, std::size_t i_length) const
+    {
+        map_type const* map = m_input->get(index<Q>());
+        if (map) {
+            return parse_quantity(o_quantity, i_value, i_symbol, i_length, *map);
+        }
+        return parse_quantity(o_quantity, i_value, i_symbol, i_length);
+    }
+
+    /// Empty group, so that only default formats and the system's parser are used
+    static map_group_type const& no_maps()
+    {
+        static map_group_type const empty;
+        return empty;
+    }
+
+    std::locale m_locale;
+    map_group_type const* m_input;
+    output_map_type const* m_output;
+};
+
+} // namespace dim
@@ -0,0 +1,431 @@
+#pragma once
+#include "binary.hpp"
+#include "quantity_array.hpp"
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define DIM_HAS_MMAP
+#endif
+
+/**
+ * Files of named quantity columns that are used in place, without decoding.
+ *
+ * A column file starts with the 16-byte header of the binary encoding (see
+ * binary.hpp) with the magic "DIMC", then the number of columns (64-bit) and
+ * a directory entry per column:
+ *
+ * | Bytes | Contents                                        |
+ * |-------|-------------------------------------------------|
+ * | 0-7   | The dynamic_unit raw() code of the column       |
+ * | 8-15  | The number of values                            |
+ * | 16-23 | File offset of the values (a multiple of 64)    |
+ * | 24-31 | File offset of the name                         |
+ * | 32-39 | Length of the name                              |
+ *
+ * followed by the names and then the values of each column as bare scalars.
+ * Files are written in the native byte order, which open() checks, so a
+ * mapped column can be handed out as a quantity_span directly.
+ */
+
+namespace dim
+{
+
+namespace detail
+{
+constexpr std::size_t kColumnEntrySize = 40;
+constexpr std::size_t kColumnAlignment = 64;
+} // namespace detail
+
+/**
+ * @brief Writes columns of quantities to a column file.
+ *
+ * Columns are added by pointer and are only read by write(), so they must
+ * live until then.
+ * ```
+ * dim::column_writer<double, si::system> columns;
+ * columns.add("position", positions); // A std::vector<si::Length>, quantity_array, ...
+ * columns.add("load", load_unit, loads.data(), loads.size());
+ * columns.write("run42.dimc");
+ * ```
+ */
+template <class Scalar, class System>
+class column_writer
+{
+  public:
+    using scalar = Scalar;
+    using system = System;
+    using unit_type = dynamic_unit<System>;
+
+    /// Add a column of i_count static quantities
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    void add(std::string i_name, Q const* i_values, std::size_t i_count)
+    {
+        static_assert(std::is_same<typename Q::scalar, scalar>::value, "Quantity scalar must match the writer");
+        static_assert(sizeof(Q) == sizeof(scalar), "Quantities must be laid out as bare scalars");
+        DIM_CHECK_SYSTEMS(Q::unit, unit_type);
+        add(std::move(i_name), index<typename Q::unit>(), reinterpret_cast<scalar const*>(i_values), i_count);
+    }
+
+    /// Add a column of the values of a container with data() and size() (std::vector, quantity_span, ...)
+    template <class Container> void add(std::string i_name, Container const& i_values)
+    {
+        add(std::move(i_name), i_values.data(), i_values.size());
+    }
+
+    /// Add a column of i_count values, all in i_unit
+    void add(std::string i_name, unit_type const& i_unit, scalar const* i_values, std::size_t i_count)
+    {
+        m_columns.push_back(column_entry{std::move(i_name), i_unit.raw(), i_values, i_count});
+    }
+
+    /// Number of columns added
+    std::size_t size() const { return m_columns.size(); }
+
+    /// Write the columns to the file at i_path. Returns false if the file cannot be written.
+    bool write(char const* i_path) const
+    {
+        std::ofstream file(i_path, std::ios::binary | std::ios::trunc);
+        return file && write(file);
+    }
+
+    /// Write the columns to io_output, which should be a binary stream at offset zero
+    bool write(std::ostream& io_output) const
+    {
+        std::vector<unsigned char> head(detail::kBinaryHeaderSize + 8 + detail::kColumnEntrySize * m_columns.size());
+        detail::write_binary_header<Scalar, System>(head.data(), "DIMC", detail::native_byte_order());
+        uint64_t count = m_columns.size();
+        std::memcpy(head.data() + detail::kBinaryHeaderSize, &count, sizeof(count));
+
+        uint64_t offset = head.size();
+        std::vector<uint64_t> name_offsets;
+        for (auto const& column : m_columns) {
+            name_offsets.push_back(offset);
+            offset += column.name.size();
+        }
+        for (std::size_t i = 0; i < m_columns.size(); ++i) {
+            offset = aligned(offset);
+            uint64_t entry[5] = {m_columns[i].code, m_columns[i].count, offset, name_offsets[i],
+                                 m_columns[i].name.size()};
+            std::memcpy(head.data() + detail::kBinaryHeaderSize + 8 + i * detail::kColumnEntrySize, entry,
+                        sizeof(entry));
+            offset += m_columns[i].count * sizeof(scalar);
+        }
+
+        io_output.write(reinterpret_cast<char const*>(head.data()), static_cast<std::streamsize>(head.size()));
+        offset = head.size();
+        for (auto const& column : m_columns) {
+            io_output.write(column.name.data(), static_cast<std::streamsize>(column.name.size()));
+            offset += column.name.size();
+        }
+        char const padding[detail::kColumnAlignment] = {};
+        for (auto const& column : m_columns) {
+            io_output.write(padding, static_cast<std::streamsize>(aligned(offset) - offset));
+            io_output.write(reinterpret_cast<char const*>(column.values),
+                            static_cast<std::streamsize>(column.count * sizeof(scalar)));
+            offset = aligned(offset) + column.count * sizeof(scalar);
+        }
+        return static_cast<bool>(io_output.flush());
+    }
+
+  private:
+    struct column_entry {
+        std::string name;
+        uint64_t code;
+        scalar const* values;
+        std::size_t count;
+    };
+
+    static uint64_t aligned(uint64_t i_offset)
+    {
+        return (i_offset + detail::kColumnAlignment - 1) / detail::kColumnAlignment * detail::kColumnAlignment;
+    }
+
+    std::vector<column_entry> m_columns;
+};
+
+/**
+ * @brief A column of values in one dynamic unit, read as dynamic quantities.
+ */
+template <class Scalar, class System>
+class dynamic_column
+{
+  public:
+    using scalar = Scalar;
+    using unit_type = dynamic_unit<System>;
+    using dynamic_type = dynamic_quantity<Scalar, System>;
+
+    /// An empty column
+    dynamic_column()
+        : m_values(nullptr),
+          m_size(0),
+          m_unit(unit_type::dimensionless())
+    {
+    }
+
+    dynamic_column(scalar const* i_values, std::size_t i_size, unit_type const& i_unit)
+        : m_values(i_values),
+          m_size(i_size),
+          m_unit(i_unit)
+    {
+    }
+
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    unit_type const& unit() const { return m_unit; }
+
+    /// The values as bare scalars in unit()
+    scalar const* scalars() const { return m_values; }
+
+    dynamic_type operator[](std::size_t i) const { return dynamic_type(m_values[i], m_unit); }
+
+  private:
+    scalar const* m_values;
+    std::size_t m_size;
+    unit_type m_unit;
+};
+
+/**
+ * @brief A column file opened for reading in place.
+ *
+ * open() maps the file (or reads it into memory where mmap is not available)
+ * and checks its header and directory. A column is then fetched by name or
+ * position as a quantity_span, after a single check that its unit is
+ * index<Q>(), or as a dynamic_column; either one points straight into the
+ * mapping, so nothing is decoded and the views are valid until the store is
+ * closed.
+ * ```
+ * dim::column_store<double, si::system> store;
+ * if (store.open("run42.dimc")) {
+ *     dim::quantity_span<si::Length const> position = store.column<si::Length>("position");
+ *     si::Length furthest = max(position);
+ * }
+ * ```
+ * A file that cannot be used leaves error() set (or throws std::runtime_error
+ * if DIM_EXCEPTIONS is set). Asking for a column as the wrong quantity gives
+ * an empty span (or throws incommensurable_exception).
+ */
+template <class Scalar, class System>
+class column_store
+{
+  public:
+    using scalar = Scalar;
+    using system = System;
+    using unit_type = dynamic_unit<System>;
+    using dynamic_column_type = dynamic_column<Scalar, System>;
+
+    /// Returned by find() if there is no such column
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    column_store()
+        : m_data(nullptr),
+          m_size(0),
+          m_mapped(false),
+          m_error(binary_error::none)
+    {
+    }
+
+    /// Open the column file at i_path
+    explicit column_store(char const* i_path)
+        : column_store()
+    {
+        open(i_path);
+    }
+
+    column_store(column_store const&) = delete;
+    column_store& operator=(column_store const&) = delete;
+
+    ~column_store() { close(); }
+
+    /// Open the column file at i_path, closing any file already open. Returns false on error.
+    bool open(char const* i_path)
+    {
+        close();
+        if (!map(i_path)) {
+            return fail(binary_error::unreadable);
+        }
+        bool swap = false;
+        binary_error error = detail::check_binary_header<Scalar, System>(m_data, m_size, "DIMC", swap);
+        if (error != binary_error::none) {
+            return fail(error);
+        }
+        if (swap) {
+            return fail(binary_error::wrong_byte_order);
+        }
+        if (m_size < detail::kBinaryHeaderSize + 8) {
+            return fail(binary_error::truncated);
+        }
+        uint64_t count;
+        std::memcpy(&count, m_data + detail::kBinaryHeaderSize, sizeof(count));
+        if (count > (m_size - detail::kBinaryHeaderSize - 8) / detail::kColumnEntrySize) {
+            return fail(binary_error::truncated);
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            uint64_t entry[5];
+            std::memcpy(entry, m_data + detail::kBinaryHeaderSize + 8 + i * detail::kColumnEntrySize, sizeof(entry));
+            if (!fits(entry[2], entry[1], sizeof(scalar)) || !fits(entry[3], entry[4], 1)
+                || entry[2] % alignof(scalar) != 0) {
+                return fail(binary_error::truncated);
+            }
+            m_columns.push_back(column_entry{std::string(reinterpret_cast<char const*>(m_data + entry[3]),
+                                                   static_cast<std::size_t>(entry[4])),
+                                       unit_type(entry[0]), reinterpret_cast<scalar const*>(m_data + entry[2]),
+                                       static_cast<std::size_t>(entry[1])});
+        }
+        return true;
+    }
+
+    /// Unmap the file. Views of its columns are no longer valid.
+    void close()
+    {
+#ifdef DIM_HAS_MMAP
+        if (m_mapped) {
+            munmap(const_cast<unsigned char*>(m_data), m_size);
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+        m_mapped = false;
+        m_copy.clear();
+        m_columns.clear();
+        m_error = binary_error::none;
+    }
+
+    /// The error from the last open(), or binary_error::none
+    binary_error error() const { return m_error; }
+
+    /// True if a file is open
+    bool is_open() const { return m_data != nullptr && m_error == binary_error::none; }
+
+    /// Number of columns
+    std::size_t columns() const { return m_columns.size(); }
+
+    std::string const& name(std::size_t i_column) const { return m_columns[i_column].name; }
+    unit_type const& unit(std::size_t i_column) const { return m_columns[i_column].unit; }
+
+    /// Number of values in a column
+    std::size_t size(std::size_t i_column) const { return m_columns[i_column].size; }
+
+    /// The position of the column named i_name, or npos
+    std::size_t find(std::string const& i_name) const
+    {
+        for (std::size_t i = 0; i < m_columns.size(); ++i) {
+            if (m_columns[i].name == i_name) {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    /// Column i_column as Q, or an empty span if its unit is not Q's
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    quantity_span<Q const> column(std::size_t i_column) const
+    {
+        static_assert(std::is_same<typename Q::scalar, scalar>::value, "Quantity scalar must match the store");
+        DIM_CHECK_SYSTEMS(Q::unit, unit_type);
+        if (i_column >= m_columns.size()) {
+            return quantity_span<Q const>();
+        }
+        column_entry const& found = m_columns[i_column];
+        if (found.unit != index<typename Q::unit>()) {
+#ifdef DIM_EXCEPTIONS
+            throw incommensurable_exception(found.unit, index<typename Q::unit>(), "Column has the wrong unit");
+#else
+            return quantity_span<Q const>();
+#endif
+        }
+        return quantity_span<Q const>(reinterpret_cast<Q const*>(found.values), found.size);
+    }
+
+    /// The column named i_name as Q, or an empty span if there is none or its unit is not Q's
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    quantity_span<Q const> column(std::string const& i_name) const
+    {
+        return column<Q>(find(i_name));
+    }
+
+    /// Column i_column as dynamic quantities, or an empty column if there is none
+    dynamic_column_type dynamic(std::size_t i_column) const
+    {
+        if (i_column >= m_columns.size()) {
+            return dynamic_column_type();
+        }
+        return dynamic_column_type(m_columns[i_column].values, m_columns[i_column].size, m_columns[i_column].unit);
+    }
+
+    /// The column named i_name as dynamic quantities, or an empty column if there is none
+    dynamic_column_type dynamic(std::string const& i_name) const { return dynamic(find(i_name)); }
+
+  private:
+    struct column_entry {
+        std::string name;
+        unit_type unit;
+        scalar const* values;
+        std::size_t size;
+    };
+
+    bool map(char const* i_path)
+    {
+#ifdef DIM_HAS_MMAP
+        int descriptor = ::open(i_path, O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+        struct stat status;
+        bool mapped = false;
+        if (fstat(descriptor, &status) == 0 && status.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (data != MAP_FAILED) {
+                m_data = static_cast<unsigned char const*>(data);
+                m_size = static_cast<std::size_t>(status.st_size);
+                m_mapped = mapped = true;
+            }
+        }
+        ::close(descriptor);
+        return mapped;
+#else
+        std::ifstream file(i_path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        m_copy.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        m_data = reinterpret_cast<unsigned char const*>(m_copy.data());
+        m_size = m_copy.size();
+        return m_size != 0;
+#endif
+    }
+
+    // True if i_count items of i_size bytes at i_offset lie inside the file
+    bool fits(uint64_t i_offset, uint64_t i_count, std::size_t i_size) const
+    {
+        return i_offset <= m_size && i_count <= (m_size - i_offset) / i_size;
+    }
+
+    bool fail(binary_error i_error)
+    {
+        close();
+        m_error = i_error;
+#ifdef DIM_EXCEPTIONS
+        throw std::runtime_error(detail::binary_error_message(i_error));
+#else
+        return false;
+#endif
+    }
+
+    unsigned char const* m_data;
+    std::size_t m_size;
+    bool m_mapped;
+    std::vector<char> m_copy;
+    std::vector<column_entry> m_columns;
+    binary_error m_error;
+};
+
+template <class Scalar, class System> constexpr std::size_t column_store<Scalar, System>::npos;
+
+} // namespace dim
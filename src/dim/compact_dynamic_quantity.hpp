@@ -0,0 +1,295 @@
+#pragma once
+#include "dynamic_quantity.hpp"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef DIM_EXCEPTIONS
+#include <stdexcept>
+#endif
+
+/**
+ * Dynamic quantities that store a 16-bit unit ID in place of the 8-byte
+ * dynamic_unit code.
+ *
+ * Programs see a few hundred distinct units at most, so a unit_intern_table
+ * numbers each one as it is first seen. A compact_dynamic_quantity<double> is
+ * then 10 bytes rather than 16, and a compact_dynamic_quantity<float> 6 rather
+ * than 16, which matters for large stores of mixed quantities.
+ */
+
+namespace dim
+{
+
+/**
+ * @brief Maps the dynamic_units of a system to 16-bit IDs and back.
+ *
+ * There is one table per system, from instance(). ID 0 is dimensionless and
+ * the units in interned_units<System> follow in order, so those IDs are the
+ * same in every program; other units are numbered as they are interned.
+ *
+ * Lookups in both directions never lock: the ID to unit table is kept in
+ * chunks that never move, and the unit to ID hash index is replaced by a
+ * copy twice the size when it fills, the old copy being kept until the table
+ * is destroyed. Only interning a new unit takes a lock.
+ */
+template <class System>
+class unit_intern_table
+{
+  public:
+    using unit_type = dynamic_unit<System>;
+    using id_type = uint16_t;
+
+    /// The ID of bad_unit(), and the result when the table is full
+    static constexpr id_type kBadId = 0xffff;
+
+    /// The table for System
+    static unit_intern_table& instance()
+    {
+        static unit_intern_table table;
+        return table;
+    }
+
+    unit_intern_table(unit_intern_table const&) = delete;
+    unit_intern_table& operator=(unit_intern_table const&) = delete;
+
+    /**
+     * @brief The ID of i_unit, which is added to the table if it is new. Bad
+     * units give kBadId, as does a new unit when all 65535 IDs are taken (or
+     * this throws std::length_error if DIM_EXCEPTIONS is set).
+     */
+    id_type intern(unit_type const& i_unit)
+    {
+        id_type id = find(i_unit);
+        if (id != kBadId || i_unit.is_bad()) {
+            return id;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = find(i_unit);
+        if (id == kBadId) {
+            id = add(i_unit.raw());
+        }
+        return id;
+    }
+
+    /// The ID of i_unit, or kBadId if it has not been interned
+    id_type find(unit_type const& i_unit) const
+    {
+        hash_index const* current = m_index.load(std::memory_order_acquire);
+        uint64_t code = i_unit.raw();
+        for (std::size_t i = static_cast<std::size_t>(detail::unit_hash(code)) & current->mask;;
+             i = (i + 1) & current->mask) {
+            id_type entry = current->slots[i].load(std::memory_order_acquire);
+            if (entry == 0) {
+                return kBadId;
+            }
+            if (code_of(static_cast<id_type>(entry - 1)) == code) {
+                return static_cast<id_type>(entry - 1);
+            }
+        }
+    }
+
+    /// The unit with ID i_id, or bad_unit() if there is none
+    unit_type unit(id_type i_id) const
+    {
+        if (i_id >= m_size.load(std::memory_order_acquire)) {
+            return unit_type::bad_unit();
+        }
+        return unit_type(code_of(i_id));
+    }
+
+    /// Number of units interned
+    std::size_t size() const { return m_size.load(std::memory_order_acquire); }
+
+  private:
+    static constexpr std::size_t kChunkBits = 8;
+    static constexpr std::size_t kChunkSize = std::size_t(1) << kChunkBits;
+
+    /// Open-addressing hash index from unit codes to ID + 1 (0 is an empty slot)
+    struct hash_index {
+        explicit hash_index(std::size_t i_slots)
+            : mask(i_slots - 1),
+              slots(new std::atomic<id_type>[i_slots])
+        {
+            for (std::size_t i = 0; i < i_slots; ++i) {
+                slots[i].store(0, std::memory_order_relaxed);
+            }
+        }
+        std::size_t mask;
+        std::unique_ptr<std::atomic<id_type>[]> slots;
+    };
+
+    unit_intern_table()
+        : m_size(0)
+    {
+        for (auto& chunk : m_chunks) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+        m_indices.emplace_back(new hash_index(64));
+        m_index.store(m_indices.back().get(), std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        add(unit_type::dimensionless().raw());
+        for (std::size_t i = 0; i < interned_units<System>::count(); ++i) {
+            if (find(interned_units<System>::get(i)) == kBadId) {
+                add(interned_units<System>::get(i).raw());
+            }
+        }
+    }
+
+    ~unit_intern_table()
+    {
+        for (auto& chunk : m_chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t code_of(id_type i_id) const
+    {
+        return m_chunks[i_id >> kChunkBits].load(std::memory_order_acquire)[i_id & (kChunkSize - 1)].load(
+            std::memory_order_relaxed);
+    }
+
+    // Give i_code the next ID. Called with m_mutex held.
+    id_type add(uint64_t i_code)
+    {
+        std::size_t size = m_size.load(std::memory_order_relaxed);
+        if (size >= kBadId) {
+#ifdef DIM_EXCEPTIONS
+            throw std::length_error("unit_intern_table is full");
+#else
+            return kBadId;
+#endif
+        }
+        id_type id = static_cast<id_type>(size);
+        std::atomic<uint64_t>* chunk = m_chunks[id >> kChunkBits].load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new std::atomic<uint64_t>[kChunkSize];
+            m_chunks[id >> kChunkBits].store(chunk, std::memory_order_release);
+        }
+        chunk[id & (kChunkSize - 1)].store(i_code, std::memory_order_relaxed);
+
+        // Keep the index at most half full
+        hash_index* current = m_indices.back().get();
+        if (2 * (size + 1) > current->mask + 1) {
+            m_indices.emplace_back(new hash_index(2 * (current->mask + 1)));
+            current = m_indices.back().get();
+            for (std::size_t i = 0; i < size; ++i) {
+                insert(*current, code_of(static_cast<id_type>(i)), static_cast<id_type>(i));
+            }
+            m_index.store(current, std::memory_order_release);
+        }
+        insert(*current, i_code, id);
+        m_size.store(size + 1, std::memory_order_release);
+        return id;
+    }
+
+    static void insert(hash_index& io_index, uint64_t i_code, id_type i_id)
+    {
+        std::size_t i = static_cast<std::size_t>(detail::unit_hash(i_code)) & io_index.mask;
+        while (io_index.slots[i].load(std::memory_order_relaxed) != 0) {
+            i = (i + 1) & io_index.mask;
+        }
+        io_index.slots[i].store(static_cast<id_type>(i_id + 1), std::memory_order_release);
+    }
+
+    std::atomic<std::atomic<uint64_t>*> m_chunks[(std::size_t(kBadId) + 1) / kChunkSize];
+    std::atomic<std::size_t> m_size;
+    std::atomic<hash_index const*> m_index;
+    std::vector<std::unique_ptr<hash_index>> m_indices;
+    std::mutex m_mutex;
+};
+
+template <class System> constexpr typename unit_intern_table<System>::id_type unit_intern_table<System>::kBadId;
+template <class System> constexpr std::size_t unit_intern_table<System>::kChunkBits;
+template <class System> constexpr std::size_t unit_intern_table<System>::kChunkSize;
+
+/**
+ * @brief A dynamic_quantity that stores its unit as an ID from
+ * unit_intern_table<System>.
+ *
+ * The value is stored unaligned, so an array of these has no padding. Convert
+ * to dynamic_quantity for arithmetic and formatting; the conversion is a table
+ * lookup one way and a hash lookup the other.
+ * ```
+ * std::vector<dim::compact_dynamic_quantity<double, si::system>> readings;
+ * readings.push_back(si::dynamic_quantity(5.0 * si::meter));
+ * si::dynamic_quantity first = readings[0];
+ * ```
+ */
+template <class S, class System, DIM_IS_SCALAR(S)>
+class compact_dynamic_quantity
+{
+  public:
+    using scalar = S;
+    using system = System;
+    using type = compact_dynamic_quantity<S, System>;
+    using unit_type = dynamic_unit<System>;
+    using dynamic_type = dynamic_quantity<S, System>;
+    using table_type = unit_intern_table<System>;
+    using id_type = typename table_type::id_type;
+
+    /// Zero, dimensionless
+    compact_dynamic_quantity()
+        : compact_dynamic_quantity(scalar(0), id_type(0))
+    {
+    }
+
+    /// A value with a unit ID from table_type::instance()
+    compact_dynamic_quantity(scalar i_v, id_type i_id)
+        : m_id(i_id)
+    {
+        std::memcpy(m_value, &i_v, sizeof(scalar));
+    }
+
+    compact_dynamic_quantity(scalar i_v, unit_type const& i_unit)
+        : compact_dynamic_quantity(i_v, table_type::instance().intern(i_unit))
+    {
+        if (m_id == table_type::kBadId) {
+            value(std::numeric_limits<scalar>::quiet_NaN());
+        }
+    }
+
+    compact_dynamic_quantity(dynamic_type const& i_q)
+        : compact_dynamic_quantity(i_q.value(), i_q.unit())
+    {
+    }
+
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    compact_dynamic_quantity(Q const& i_q)
+        : compact_dynamic_quantity(static_cast<scalar>(dimensionless_cast(i_q)), index(i_q))
+    {
+    }
+
+    scalar value() const
+    {
+        scalar v;
+        std::memcpy(&v, m_value, sizeof(scalar));
+        return v;
+    }
+    void value(scalar i_v) { std::memcpy(m_value, &i_v, sizeof(scalar)); }
+
+    /// The ID of the unit in table_type::instance()
+    id_type id() const { return m_id; }
+
+    unit_type unit() const { return table_type::instance().unit(m_id); }
+
+    dynamic_type dynamic() const { return dynamic_type(value(), unit()); }
+
+    operator dynamic_type() const { return dynamic(); }
+
+    static type bad_quantity() { return type(std::numeric_limits<scalar>::quiet_NaN(), table_type::kBadId); }
+
+    bool is_bad() const { return isbad__(value()); }
+
+    bool operator==(type const& i_rhs) const { return m_id == i_rhs.m_id && value() == i_rhs.value(); }
+    bool operator!=(type const& i_rhs) const { return !(*this == i_rhs); }
+
+  private:
+    unsigned char m_value[sizeof(scalar)];
+    id_type m_id;
+};
+
+} // namespace dim
@@ -0,0 +1,383 @@
+#pragma once
+#include "format_map.hpp"
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+/**
+ * Streaming reader for delimited text (CSV, TSV) holding quantities.
+ *
+ * Units may be given once per column in the header, either in brackets
+ * ("speed [mph]", "speed (mph)") or as a trailing "_symbol" ("pressure_psi"),
+ * or per cell ("123_kPa"). Cells are decoded a column at a time with the batch
+ * parser, so a header unit is resolved once per chunk and a run of cells with
+ * the same suffix is resolved once per run.
+ */
+
+namespace dim
+{
+
+namespace detail
+{
+
+/**
+ * Find the unit symbol in a column header: the text inside a trailing
+ * "[...]" or "(...)", or else the text after the last '_'. Returns an empty
+ * string if there is neither.
+ */
+inline std::string header_symbol(std::string const& i_name)
+{
+    std::size_t last = i_name.find_last_not_of(" \t");
+    if (last == std::string::npos) {
+        return std::string();
+    }
+    char close = i_name[last];
+    if (close == ']' || close == ')') {
+        std::size_t open = i_name.find_last_of(close == ']' ? '[' : '(', last);
+        if (open != std::string::npos) {
+            std::size_t first = i_name.find_first_not_of(" \t", open + 1);
+            std::size_t end = i_name.find_last_not_of(" \t", last - 1);
+            return (first <= end && end < last ? i_name.substr(first, end - first + 1) : std::string());
+        }
+    }
+    std::size_t underscore = i_name.rfind('_', last);
+    return (underscore != std::string::npos ? i_name.substr(underscore + 1, last - underscore) : std::string());
+}
+
+} // namespace detail
+
+/**
+ * @brief Read columns of quantities from a delimited text stream in bounded
+ * chunks.
+ *
+ * Call read_header() (unless the input has no header), then read_chunk()
+ * until it returns zero. After each read_chunk(), column() decodes any column
+ * of the chunk straight into a caller-provided array of quantities or
+ * dynamic_quantities. Memory use is bounded by the chunk size and the
+ * longest line.
+ *
+ * Fields may be quoted with '"', but a quoted field may not contain a line
+ * break. Blank lines are skipped. Rows with fewer fields than the header are
+ * padded with empty fields, which fail to parse.
+ */
+template <class Scalar, class System>
+class csv_reader
+{
+  public:
+    using dynamic_type = dynamic_quantity<Scalar, System>;
+    using map_type = input_format_map<Scalar, System>;
+    using map_group_type = input_format_map_group<Scalar, System>;
+
+    /**
+     * @param io_input Stream to read. It must outlive the reader.
+     * @param i_delimiter Field delimiter, e.g. ',' or '\t'
+     * @param i_chunk_size Number of bytes to read from io_input at a time
+     */
+    explicit csv_reader(std::istream& io_input, char i_delimiter = ',', std::size_t i_chunk_size = 1 << 16)
+        : m_input(io_input),
+          m_delimiter(i_delimiter),
+          m_buffer(i_chunk_size > 0 ? i_chunk_size : 1),
+          m_begin(0),
+          m_size(0),
+          m_rows(0),
+          m_eof(false)
+    {
+    }
+
+    /**
+     * Read the header row, setting the number of columns and the names and
+     * unit symbols of each column.
+     * @return false if the input is empty
+     */
+    bool read_header()
+    {
+        std::size_t end = fill_line();
+        if (end == m_begin) {
+            return false;
+        }
+        m_names.clear();
+        m_symbols.clear();
+        char const* line = m_buffer.data();
+        split(line + m_begin, line + end, [this](char const* i_begin, char const* i_end, bool i_quoted) {
+            std::string name(i_begin, i_end);
+            if (i_quoted) {
+                for (std::size_t pos = name.find("\"\""); pos != std::string::npos; pos = name.find("\"\"", pos + 1)) {
+                    name.erase(pos, 1);
+                }
+            }
+            m_symbols.push_back(detail::header_symbol(name));
+            m_names.push_back(std::move(name));
+        });
+        m_begin = end;
+        return true;
+    }
+
+    /**
+     * Read the next chunk of rows. If there was no header, the number of
+     * columns is taken from the first row.
+     * @return The number of rows in the chunk, zero at the end of input
+     */
+    std::size_t read_chunk()
+    {
+        m_rows = 0;
+        m_fields.clear();
+        std::size_t end = fill_lines();
+        char const* data = m_buffer.data();
+        for (std::size_t line = m_begin; line < end;) {
+            char const* line_end = static_cast<char const*>(memchr(data + line, '\n', end - line));
+            if (!line_end) {
+                line_end = data + end;
+            }
+            index_row(data + line, line_end);
+            line = static_cast<std::size_t>(line_end - data) + 1;
+        }
+        m_begin = end;
+        return m_rows;
+    }
+
+    /**
+     * Number of columns
+     */
+    std::size_t columns() const { return m_names.empty() ? m_symbols.size() : m_names.size(); }
+
+    /**
+     * Number of rows in the current chunk
+     */
+    std::size_t rows() const { return m_rows; }
+
+    /**
+     * Header text of a column, or an empty string without a header.
+     */
+    std::string name(std::size_t i_column) const { return i_column < m_names.size() ? m_names[i_column] : std::string(); }
+
+    /**
+     * Unit symbol found in the header of a column, or an empty string if
+     * none. Cells without their own unit symbol use this unit.
+     */
+    std::string const& symbol(std::size_t i_column) const { return m_symbols[i_column]; }
+
+    /**
+     * Decode a column of the current chunk into quantities.
+     *
+     * @param i_column Column index
+     * @param[out] o_values Array of rows() quantities
+     * @param[out] o_errors Array of rows() error codes, as for parse_quantities(). May be nullptr.
+     * @param i_unit_map Map searched for unit symbols before the system's parser
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    parse_batch_result column(std::size_t i_column, Q* o_values, std::errc* o_errors,
+                              map_type const& i_unit_map = get_default_format<Q>()) const
+    {
+        detail::batch_parser<Scalar, System, map_type> parser(i_unit_map);
+        return decode(parser, i_column, o_values, o_errors);
+    }
+
+    /**
+     * Decode a column of the current chunk into dynamic_quantities.
+     *
+     * @param i_column Column index
+     * @param[out] o_values Array of rows() dynamic_quantities
+     * @param[out] o_errors Array of rows() error codes, as for parse_quantities(). May be nullptr.
+     * @param i_unit_map Maps searched for unit symbols before the system's parser
+     */
+    template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+    parse_batch_result column(std::size_t i_column, DQ* o_values, std::errc* o_errors,
+                              map_group_type const& i_unit_map) const
+    {
+        detail::batch_parser<Scalar, System, map_group_type> parser(i_unit_map);
+        return decode(parser, i_column, o_values, o_errors);
+    }
+
+  private:
+    /// Byte offsets of a field within m_buffer
+    struct field {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    template <class Parser, class Q>
+    parse_batch_result decode(Parser& io_parser, std::size_t i_column, Q* o_values, std::errc* o_errors) const
+    {
+        parse_batch_result result{0, 0};
+        if (i_column >= columns()) {
+            return result;
+        }
+        if (!m_symbols[i_column].empty()) {
+            io_parser.default_symbol(m_symbols[i_column].c_str());
+        }
+        char const* data = m_buffer.data();
+        std::size_t stride = columns();
+        for (; result.count < m_rows; ++result.count) {
+            field const& item = m_fields[result.count * stride + i_column];
+            std::errc ec = io_parser.parse(o_values[result.count], data + item.begin, data + item.end);
+            if (o_errors) {
+                o_errors[result.count] = ec;
+            }
+            result.failed += (ec != std::errc{});
+        }
+        return result;
+    }
+
+    /**
+     * Split the line [i_begin, i_end) into fields, calling
+     * i_function(begin, end, quoted) for each one. Quotes and surrounding
+     * blanks are removed.
+     */
+    template <class Function>
+    void split(char const* i_begin, char const* i_end, Function&& i_function) const
+    {
+        if (i_begin < i_end && i_end[-1] == '\r') {
+            --i_end;
+        }
+        for (char const* pos = i_begin;;) {
+            while (pos < i_end && (*pos == ' ' || (*pos == '\t' && m_delimiter != '\t'))) {
+                ++pos;
+            }
+            char const* field_begin = pos;
+            char const* field_end;
+            bool quoted = (pos < i_end && *pos == '"');
+            if (quoted) {
+                field_begin = ++pos;
+                while (pos < i_end) {
+                    if (*pos == '"') {
+                        if (pos + 1 < i_end && pos[1] == '"') {
+                            pos += 2;
+                            continue;
+                        }
+                        break;
+                    }
+                    ++pos;
+                }
+                field_end = pos;
+            }
+            char const* next =
+                (pos < i_end ? static_cast<char const*>(memchr(pos, m_delimiter, static_cast<std::size_t>(i_end - pos)))
+                             : nullptr);
+            if (!next) {
+                next = i_end;
+            }
+            if (!quoted) {
+                field_end = next;
+                while (field_end > field_begin && (field_end[-1] == ' ' || field_end[-1] == '\t')) {
+                    --field_end;
+                }
+            }
+            i_function(field_begin, field_end, quoted);
+            if (next == i_end) {
+                break;
+            }
+            pos = next + 1;
+        }
+    }
+
+    /// Add the fields of one line to m_fields, skipping blank lines
+    void index_row(char const* i_begin, char const* i_end)
+    {
+        char const* trimmed = i_end;
+        while (trimmed > i_begin && (trimmed[-1] == '\r' || trimmed[-1] == ' ' || trimmed[-1] == '\t')) {
+            --trimmed;
+        }
+        if (trimmed == i_begin) {
+            return;
+        }
+        bool size_from_row = (columns() == 0);
+        std::size_t first = m_fields.size();
+        char const* data = m_buffer.data();
+        split(i_begin, i_end, [&](char const* i_field_begin, char const* i_field_end, bool) {
+            if (size_from_row || m_fields.size() - first < columns()) {
+                m_fields.push_back(
+                    field{static_cast<std::size_t>(i_field_begin - data), static_cast<std::size_t>(i_field_end - data)});
+            }
+        });
+        if (size_from_row) {
+            m_symbols.resize(m_fields.size() - first);
+        }
+        m_fields.resize(first + columns(), field{0, 0});
+        ++m_rows;
+    }
+
+    /// Move unread data to the front of the buffer and read more input
+    void fill()
+    {
+        if (m_begin > 0) {
+            std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_size - m_begin);
+            m_size -= m_begin;
+            m_begin = 0;
+        }
+        if (!m_eof && m_size < m_buffer.size()) {
+            m_input.read(m_buffer.data() + m_size, static_cast<std::streamsize>(m_buffer.size() - m_size));
+            m_size += static_cast<std::size_t>(m_input.gcount());
+            m_eof = !m_input;
+        }
+    }
+
+    /**
+     * Read until the buffer holds at least one whole line.
+     * @return Offset past the end of the first line (past its '\n')
+     */
+    std::size_t fill_line()
+    {
+        for (;;) {
+            char* start = m_buffer.data() + m_begin;
+            char* newline = static_cast<char*>(memchr(start, '\n', m_size - m_begin));
+            if (newline) {
+                return static_cast<std::size_t>(newline - m_buffer.data()) + 1;
+            }
+            if (m_eof) {
+                return m_size;
+            }
+            grow_if_full();
+            fill();
+        }
+    }
+
+    /**
+     * Read until the buffer holds at least one whole line.
+     * @return Offset past the end of the last whole line in the buffer
+     */
+    std::size_t fill_lines()
+    {
+        fill();
+        for (;;) {
+            if (m_eof) {
+                return m_size;
+            }
+            char* start = m_buffer.data() + m_begin;
+            std::size_t size = m_size - m_begin;
+            char* newline = nullptr;
+            for (std::size_t i = size; i > 0; --i) {
+                if (start[i - 1] == '\n') {
+                    newline = start + i - 1;
+                    break;
+                }
+            }
+            if (newline) {
+                return static_cast<std::size_t>(newline - m_buffer.data()) + 1;
+            }
+            grow_if_full();
+            fill();
+        }
+    }
+
+    /// Double the buffer if a line doesn't fit
+    void grow_if_full()
+    {
+        if (m_begin == 0 && m_size == m_buffer.size()) {
+            m_buffer.resize(m_buffer.size() * 2);
+        }
+    }
+
+    std::istream& m_input;
+    char m_delimiter;
+    std::vector<char> m_buffer;
+    std::size_t m_begin;
+    std::size_t m_size;
+    std::size_t m_rows;
+    bool m_eof;
+    std::vector<std::string> m_names;
+    std::vector<std::string> m_symbols;
+    std::vector<field> m_fields;
+};
+
+} // namespace dim
@@ -131,7 +131,7 @@ class dynamic_quantity : public dynamic_quantity_tag
     template <class S2, DIM_IS_SCALAR(S2)>
     friend constexpr type divide(type const& a, dynamic_quantity<S2, System> const& b)
     {
-        return multiply(a, dynamic_quantity<S2, System>(S2(1) / b.m_value, inverse(b.unit())));
+        return {a.m_value / b.m_value, a.m_unit.divide(b.m_unit)};
     }
 
     template <class S2, DIM_IS_SCALAR(S2)>
@@ -393,5 +393,28 @@ DQ power(DQ const& a, int n)
     return {std::pow(dimensionless_cast(a), n), pow(a.unit(), n)};
 }
 
+/**
+ * Take the n'th root of a dynamic quantity. The result is bad if a dimension is
+ * not divisible by n, or if n is even and the value is negative. Odd roots of
+ * negative values are negative, e.g. root(-8 m^3, 3) is -2 m.
+ */
+template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+DQ root(DQ const& a, int n)
+{
+    using scalar = typename DQ::scalar;
+    auto unit = root(a.unit(), n);
+    if (unit.is_bad()) {
+        return DQ::bad_quantity();
+    }
+    double value = static_cast<double>(dimensionless_cast(a));
+    if (n == 3) {
+        return {static_cast<scalar>(std::cbrt(value)), unit};
+    }
+    if (n % 2 != 0) {
+        return {static_cast<scalar>(std::copysign(std::pow(std::fabs(value), 1.0 / n), value)), unit};
+    }
+    return {static_cast<scalar>(std::pow(value, 1.0 / n)), unit};
+}
+
 
 } // namespace dim
@@ -86,13 +86,24 @@ class quantity_facet : public std::locale::facet
      */
     template <class Q, DIM_IS_QUANTITY(Q)>
     Q format(formatted const& i_input) const
+    {
+        return format<Q>(i_input.value(), i_input.symbol(), detail::symbol_length(i_input.symbol()));
+    }
+
+    /**
+     * @brief Format a scalar & the symbol [i_symbol, i_symbol + i_length) into a
+     * quantity. The symbol need not be nul-terminated. If the conversion is
+     * illegal, the value will be NaN (check with is_bad() method on quantity)
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    Q format(typename Q::scalar const& i_scalar, char const* i_symbol, std::size_t i_length) const
     {
         Q result;
         input_format_map<Scalar, System> const* input_format = m_input_symbol.get(index(result));
         if (input_format) {
-            parse_quantity(result, i_input, *input_format);
+            parse_quantity(result, i_scalar, i_symbol, i_length, *input_format);
         } else {
-            parse_quantity(result, i_input);
+            parse_quantity(result, i_scalar, i_symbol, i_length);
         }
         return result;
     }
@@ -114,12 +125,31 @@ class quantity_facet : public std::locale::facet
      * @brief Format a scalar & symbol to a dynamic_quantity.
      */
     dynamic_type format(formatted const& i_input) const
+    {
+        return format(i_input.value(), i_input.symbol(), detail::symbol_length(i_input.symbol()));
+    }
+
+    /**
+     * @brief Format a scalar & the symbol [i_symbol, i_symbol + i_length) to a
+     * dynamic_quantity. The symbol need not be nul-terminated.
+     */
+    dynamic_type format(Scalar const& i_scalar, char const* i_symbol, std::size_t i_length) const
     {
         dynamic_type result;
-        parse_quantity(result, i_input, m_input_symbol);
+        parse_quantity(result, i_scalar, i_symbol, i_length, m_input_symbol);
         return result;
     }
 
+    /**
+     * @brief Input format maps, searched before the system's parser
+     */
+    input_format_map_group<scalar, system> const& input_formats() const { return m_input_symbol; }
+
+    /**
+     * @brief Output format map
+     */
+    output_format_map<scalar, system> const& output_formats() const { return m_output_symbol; }
+
     /**
      * @brief Attach a new output formatter for a quantity, replacing the existing formatter.
      *
@@ -127,6 +157,16 @@ class quantity_facet : public std::locale::facet
      */
     void output_formatter(formatter_type const& i_format) { m_output_symbol.insert(i_format); }
 
+    /**
+     * @brief Attach each output formatter in [i_first, i_last), replacing the
+     * existing formatters for those quantities.
+     */
+    template <class Iterator>
+    void output_formatter(Iterator i_first, Iterator i_last)
+    {
+        m_output_symbol.insert(i_first, i_last);
+    }
+
     /**
      * @brief Attach a new output formatter for Q, replacing the existing formatter.
      *
@@ -151,6 +191,16 @@ class quantity_facet : public std::locale::facet
      */
     void input_formatter(input_format_map<Scalar, System> const& i_map) { m_input_symbol.insert(i_map); }
 
+    /**
+     * @brief Attach each input formatter or format map in [i_first, i_last) as
+     * above, indexing the symbols once.
+     */
+    template <class Iterator>
+    void input_formatter(Iterator i_first, Iterator i_last)
+    {
+        m_input_symbol.insert(i_first, i_last);
+    }
+
     /**
      * @brief Drop input formatters for Q (reverting to default format).
      */
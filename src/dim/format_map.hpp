@@ -4,8 +4,14 @@
 #include "dynamic_quantity.hpp"
 #include "io.hpp"
 #include <algorithm>
+#include <cassert>
 #include <cstring>
 #include <initializer_list>
+#include <iterator>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+#include <utility>
 #include <vector>
 
 /**
@@ -18,7 +24,9 @@
  *
  * These maps are all implemented as sorted arrays, so insertion and deletion are
  * O(n log(n)), but search is O(log n).  (This is to improve performance during
- * look-up time at the expense of modification time.)
+ * look-up time at the expense of modification time.) An input_format_map may
+ * instead view a static table of formatters with a perfect-hash index, giving
+ * O(1) search until it is first modified.
  */
 
 namespace dim
@@ -50,6 +58,273 @@ typename Container::iterator find(Container& i_container, Key const& i_key, Comp
     }
     return it;
 }
+
+/**
+ * @brief Open-addressing index from dynamic_unit codes to positions in a
+ * sorted container, so that finding an element by unit is one probe instead
+ * of a bisection search.
+ *
+ * The index stores positions, not pointers, so it remains valid when its
+ * owner is copied. Single insertions and erasures update it in place; the
+ * table is only rehashed when it would grow past half full.
+ */
+class unit_index
+{
+  public:
+    /// Returned by find() for a code that is not in the index
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    /**
+     * Index the elements of i_container, where i_unit(element) gives the
+     * dynamic_unit of an element. The table is kept at most half full.
+     */
+    template <class Container, class UnitOf>
+    void rebuild(Container const& i_container, UnitOf const& i_unit)
+    {
+        std::size_t capacity = 0;
+        if (!i_container.empty()) {
+            capacity = 8;
+            while (capacity < 2 * i_container.size()) {
+                capacity *= 2;
+            }
+        }
+        m_slots.assign(capacity, slot{0, 0});
+        m_count = 0;
+        for (auto const& element : i_container) {
+            place(slot{i_unit(element).raw(), ++m_count});
+        }
+    }
+
+    /**
+     * Record that an element with unit code i_code was inserted at
+     * i_position, moving the elements from i_position on up by one.
+     */
+    void insert(uint64_t i_code, std::size_t i_position)
+    {
+        if (2 * (m_count + 1) > m_slots.size()) {
+            grow();
+        }
+        // Stored positions are one more than the real position
+        for (slot& entry : m_slots) {
+            if (entry.position > i_position) {
+                ++entry.position;
+            }
+        }
+        place(slot{i_code, i_position + 1});
+        ++m_count;
+    }
+
+    /**
+     * Record that the element with unit code i_code at i_position was erased,
+     * moving the elements after it down by one.
+     */
+    void erase(uint64_t i_code, std::size_t i_position)
+    {
+        std::size_t i = locate(i_code);
+        if (i == npos) {
+            return;
+        }
+        // Shift later members of the probe run back so no gap breaks it
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t j = (i + 1) & mask; m_slots[j].position; j = (j + 1) & mask) {
+            std::size_t home = static_cast<std::size_t>(unit_hash(m_slots[j].code)) & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                m_slots[i] = m_slots[j];
+                i = j;
+            }
+        }
+        m_slots[i] = slot{0, 0};
+        --m_count;
+        for (slot& entry : m_slots) {
+            if (entry.position > i_position + 1) {
+                --entry.position;
+            }
+        }
+    }
+
+    /**
+     * Position of the element with unit code i_code, or npos
+     */
+    std::size_t find(uint64_t i_code) const
+    {
+        std::size_t i = locate(i_code);
+        return (i != npos ? m_slots[i].position - 1 : npos);
+    }
+
+    /// Drop all entries
+    void clear()
+    {
+        m_slots.clear();
+        m_count = 0;
+    }
+
+  private:
+    /// A unit code and one more than its element's position (zero marks an empty slot)
+    struct slot {
+        uint64_t code;
+        std::size_t position;
+    };
+
+    /// Slot holding i_code, or npos
+    std::size_t locate(uint64_t i_code) const
+    {
+        if (m_slots.empty()) {
+            return npos;
+        }
+        std::size_t mask = m_slots.size() - 1;
+        for (std::size_t i = static_cast<std::size_t>(unit_hash(i_code)) & mask;; i = (i + 1) & mask) {
+            slot const& entry = m_slots[i];
+            if (!entry.position) {
+                return npos;
+            }
+            if (entry.code == i_code) {
+                return i;
+            }
+        }
+    }
+
+    /// Put i_entry in the first free slot of its probe sequence
+    void place(slot const& i_entry)
+    {
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t i = static_cast<std::size_t>(unit_hash(i_entry.code)) & mask;
+        while (m_slots[i].position) {
+            i = (i + 1) & mask;
+        }
+        m_slots[i] = i_entry;
+    }
+
+    /// Double the table (or start it at 8 slots) and rehash the entries
+    void grow()
+    {
+        std::vector<slot> old_slots(m_slots.empty() ? 8 : 2 * m_slots.size(), slot{0, 0});
+        old_slots.swap(m_slots);
+        for (slot const& entry : old_slots) {
+            if (entry.position) {
+                place(entry);
+            }
+        }
+    }
+
+    std::vector<slot> m_slots;
+    std::size_t m_count = 0;
+};
+
+/// Slot of a symbol in a power-of-two hash table of i_mask + 1 slots
+DIM_CONSTEXPR14 inline std::size_t symbol_slot(char const* i_symbol, uint32_t i_basis, std::size_t i_mask)
+{
+    uint32_t hash = symbol_hash(i_symbol, i_basis);
+    return (hash ^ (hash >> 16)) & i_mask;
+}
+
+/// Slot of the symbol [i_symbol, i_symbol + i_length) in a power-of-two hash table of i_mask + 1 slots
+inline std::size_t symbol_slot(char const* i_symbol, std::size_t i_length, uint32_t i_basis, std::size_t i_mask)
+{
+    uint32_t hash = symbol_hash(i_symbol, i_symbol + i_length, i_basis);
+    return (hash ^ (hash >> 16)) & i_mask;
+}
+
+/// A symbol that need not be nul-terminated. Used as a search key.
+struct symbol_key {
+    char const* data;
+    std::size_t length;
+};
+
+/**
+ * @brief Perfect-hash index over the symbols of a fixed array of N formatters.
+ *
+ * The index finds a hash basis under which every distinct symbol lands in its
+ * own slot of a power-of-two table, so a lookup is one hash and one string
+ * compare. With C++14 the index can be built at compile time. If a symbol
+ * appears more than once, the last formatter wins (as with repeated insert()
+ * calls). The formatters must all have the same index(), which is asserted
+ * (at compile time if the index is constexpr).
+ */
+template <std::size_t N>
+class symbol_hash_index
+{
+  public:
+    static_assert(N > 0 && N < 255, "symbol_hash_index supports 1 to 254 formatters");
+
+    /// Marks an empty slot
+    static constexpr uint8_t kEmpty = 0xff;
+
+    /// Number of slots, at least twice the number of formatters
+    static constexpr std::size_t kSlots = (N <= 4 ? 8 : N <= 8 ? 16 : N <= 16 ? 32 : N <= 32 ? 64 : N <= 64 ? 128 : 512);
+
+    template <class Formatter>
+    DIM_CONSTEXPR14 explicit symbol_hash_index(Formatter const (&i_formatters)[N])
+        : m_basis(kSymbolHashBasis),
+          m_slot{}
+    {
+        assert(same_index(i_formatters) && "symbol_hash_index formatters must share one index()");
+        while (!place(i_formatters)) {
+            m_basis = m_basis * 16777619u + 0x9e3779b9u;
+        }
+    }
+
+    /// Slot to check for a symbol
+    DIM_CONSTEXPR14 std::size_t slot(char const* i_symbol) const { return symbol_slot(i_symbol, m_basis, kSlots - 1); }
+
+    /// Index of the formatter that may match the symbol, or kEmpty
+    DIM_CONSTEXPR14 uint8_t lookup(char const* i_symbol) const { return m_slot[slot(i_symbol)]; }
+
+    constexpr uint32_t basis() const { return m_basis; }
+
+    constexpr uint8_t const* slots() const { return m_slot; }
+
+  private:
+    /// Try to place all symbols using the current basis
+    template <class Formatter>
+    DIM_CONSTEXPR14 bool place(Formatter const (&i_formatters)[N])
+    {
+        for (std::size_t i = 0; i < kSlots; ++i) {
+            m_slot[i] = kEmpty;
+        }
+        for (std::size_t i = 0; i < N; ++i) {
+            std::size_t s = slot(i_formatters[i].symbol());
+            if (m_slot[s] != kEmpty && !same_symbol(i_formatters[m_slot[s]].symbol(), i_formatters[i].symbol())) {
+                return false;
+            }
+            m_slot[s] = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
+
+    /// True if every formatter has the index of the first
+    template <class Formatter>
+    static DIM_CONSTEXPR14 bool same_index(Formatter const (&i_formatters)[N])
+    {
+        for (std::size_t i = 1; i < N; ++i) {
+            if (i_formatters[i].index() != i_formatters[0].index()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static DIM_CONSTEXPR14 bool same_symbol(char const* i_left, char const* i_right)
+    {
+        for (int i = 0; i < kMaxSymbol; ++i) {
+            if (i_left[i] != i_right[i]) {
+                return false;
+            }
+            if (!i_left[i]) {
+                return true;
+            }
+        }
+        return true;
+    }
+
+    uint32_t m_basis;
+    uint8_t m_slot[kSlots];
+};
+
+template <std::size_t N>
+constexpr uint8_t symbol_hash_index<N>::kEmpty;
+
+template <std::size_t N>
+constexpr std::size_t symbol_hash_index<N>::kSlots;
 } // namespace detail
 
 /**
@@ -77,7 +352,12 @@ class input_format_map
      * Create an empty map for a given unit_type.
      */
     explicit input_format_map(unit_type i_unit_code)
-        : m_index(i_unit_code)
+        : m_index(i_unit_code),
+          m_static_data(nullptr),
+          m_static_slots(nullptr),
+          m_static_mask(0),
+          m_static_basis(0),
+          m_static_size(0)
     {
     }
 
@@ -86,7 +366,12 @@ class input_format_map
      */
     template <class U, DIM_IS_UNIT(U)>
     explicit input_format_map(U const& i_unit_code)
-        : m_index(i_unit_code)
+        : m_index(i_unit_code),
+          m_static_data(nullptr),
+          m_static_slots(nullptr),
+          m_static_mask(0),
+          m_static_basis(0),
+          m_static_size(0)
     {
     }
 
@@ -95,7 +380,12 @@ class input_format_map
      * this formatter into the map.
      */
     explicit input_format_map(formatter_type i_first_formater)
-        : m_index(i_first_formater.index())
+        : m_index(i_first_formater.index()),
+          m_static_data(nullptr),
+          m_static_slots(nullptr),
+          m_static_mask(0),
+          m_static_basis(0),
+          m_static_size(0)
     {
         insert(i_first_formater);
     }
@@ -106,13 +396,41 @@ class input_format_map
      * Items with types not matching the first item will be rejected.
      */
     input_format_map(std::initializer_list<formatter_type> const& i_formatter_list)
-        : m_index(i_formatter_list.size() > 0 ? formatter_type(*i_formatter_list.begin()).index() : unit_type::bad_unit())
+        : m_index(i_formatter_list.size() > 0 ? formatter_type(*i_formatter_list.begin()).index() : unit_type::bad_unit()),
+          m_static_data(nullptr),
+          m_static_slots(nullptr),
+          m_static_mask(0),
+          m_static_basis(0),
+          m_static_size(0)
     {
         for (auto const& item : i_formatter_list) {
             insert(item);
         }
     }
 
+    /**
+     * Create a map that reads a static table of formatters through a
+     * perfect-hash index. The type will be set to that of the first item, and
+     * every item must have this type (symbol_hash_index asserts this).
+     *
+     * The map does not copy the table, so i_formatters and i_index must outlive
+     * it (use static storage). The first modification of the map copies the
+     * table into the map's own storage.
+     */
+    template <std::size_t N>
+    input_format_map(formatter_type const (&i_formatters)[N], detail::symbol_hash_index<N> const& i_index)
+        : m_index(i_formatters[0].index()),
+          m_static_data(i_formatters),
+          m_static_slots(i_index.slots()),
+          m_static_mask(detail::symbol_hash_index<N>::kSlots - 1),
+          m_static_basis(i_index.basis()),
+          m_static_size(0)
+    {
+        for (std::size_t i = 0; i <= m_static_mask; ++i) {
+            m_static_size += (m_static_slots[i] != kEmptySlot);
+        }
+    }
+
     /**
      * Add a formatter to the map. Q::unit must match the type of the map.
      * @return True if insertion occurred. False if the item has the wrong index
@@ -132,6 +450,7 @@ class input_format_map
         if (i_item.index() != index()) {
             return false;
         }
+        copy_static_table();
         auto it = find(i_item.symbol());
         if (it != m_sorted_data.end()) {
             *it = i_item;
@@ -150,12 +469,23 @@ class input_format_map
      */
     template <class Q, DIM_IS_QUANTITY(Q)>
     Q to_quantity(typename Q::scalar const& i_scalar, char const* i_symbol) const
+    {
+        return to_quantity<Q>(i_scalar, i_symbol, detail::symbol_length(i_symbol));
+    }
+
+    /**
+     * Transform the scalar and the symbol [i_symbol, i_symbol + i_length) into
+     * a quantity. If Q::unit is the wrong type, or symbol is not in the map,
+     * return a bad_quantity().
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    Q to_quantity(typename Q::scalar const& i_scalar, char const* i_symbol, std::size_t i_length) const
     {
         if (::dim::index<Q>() != index()) {
             return Q::bad_quantity();
         }
-        auto it = find(i_symbol);
-        return (it != m_sorted_data.end() ? it->template input<Q>(i_scalar) : Q::bad_quantity());
+        formatter_type const* item = lookup(i_symbol, i_length);
+        return (item ? item->template input<Q>(i_scalar) : Q::bad_quantity());
     }
 
     /**
@@ -176,8 +506,18 @@ class input_format_map
      */
     quantity_type to_quantity(Scalar const& i_scalar, char const* i_symbol) const
     {
-        auto it = find(i_symbol);
-        return (it != m_sorted_data.end() ? it->input(i_scalar) : quantity_type::bad_quantity());
+        return to_quantity(i_scalar, i_symbol, detail::symbol_length(i_symbol));
+    }
+
+    /**
+     * Transform the scalar and the symbol [i_symbol, i_symbol + i_length) into
+     * a dynamic_quantity. If the symbol is not in the map, return a
+     * bad_quantity().
+     */
+    quantity_type to_quantity(Scalar const& i_scalar, char const* i_symbol, std::size_t i_length) const
+    {
+        formatter_type const* item = lookup(i_symbol, i_length);
+        return (item ? item->input(i_scalar) : quantity_type::bad_quantity());
     }
 
     /**
@@ -193,21 +533,47 @@ class input_format_map
      * Get a pointer to a formatter by symbol type. If the symbol is unknown,
      * this returns a nullptr. Do not delete this pointer.
      */
-    formatter_type const* get(char const* i_symbol) const
-    {
-        auto it = find(i_symbol);
-        return (it != m_sorted_data.end() ? &(*it) : nullptr);
-    }
+    formatter_type const* get(char const* i_symbol) const { return lookup(i_symbol, detail::symbol_length(i_symbol)); }
+
+    /**
+     * Get a pointer to the formatter for the symbol [i_symbol, i_symbol +
+     * i_length), which need not be nul-terminated. If the symbol is unknown,
+     * this returns a nullptr. Do not delete this pointer.
+     */
+    formatter_type const* get(char const* i_symbol, std::size_t i_length) const { return lookup(i_symbol, i_length); }
 
     /**
      * Get the number of items in the map.
      */
-    std::size_t size() const { return m_sorted_data.size(); }
+    std::size_t size() const { return (m_static_data ? m_static_size : m_sorted_data.size()); }
+
+    /**
+     * Call i_function with each formatter in the map.
+     */
+    template <class Function>
+    void for_each(Function&& i_function) const
+    {
+        if (m_static_data) {
+            for (std::size_t i = 0; i <= m_static_mask; ++i) {
+                if (m_static_slots[i] != kEmptySlot) {
+                    i_function(m_static_data[m_static_slots[i]]);
+                }
+            }
+        } else {
+            for (auto const& item : m_sorted_data) {
+                i_function(item);
+            }
+        }
+    }
 
     /**
      * Clear all items from the map.
      */
-    void clear() { m_sorted_data.clear(); }
+    void clear()
+    {
+        m_static_data = nullptr;
+        m_sorted_data.clear();
+    }
 
     /**
      * Obtain the unit type that this formatter handles.
@@ -219,6 +585,7 @@ class input_format_map
      */
     bool erase(char const* i_symbol)
     {
+        copy_static_table();
         auto it = find(i_symbol);
         if (it != m_sorted_data.end()) {
             m_sorted_data.erase(it);
@@ -228,12 +595,42 @@ class input_format_map
     }
 
   private:
+    /// Marks an empty slot of a static table
+    static constexpr uint8_t kEmptySlot = 0xff;
+
     /**
-     * Look up an entry by symbol
+     * Look up an entry by symbol in either the static table or the sorted
+     * formatters. Returns nullptr if the symbol is unknown.
      */
-    const_iterator find(char const* i_symbol) const
+    formatter_type const* lookup(char const* i_symbol, std::size_t i_length) const
     {
-        return detail::find(m_sorted_data, i_symbol, compare_item_formatter, equal_item_formatter);
+        detail::symbol_key key{i_symbol, i_length};
+        if (m_static_data) {
+            uint8_t i = m_static_slots[detail::symbol_slot(i_symbol, i_length, m_static_basis, m_static_mask)];
+            return (i != kEmptySlot && equal_item_formatter(m_static_data[i], key) ? m_static_data + i : nullptr);
+        }
+        auto it = detail::find(m_sorted_data, key, compare_item_formatter, equal_item_formatter);
+        return (it != m_sorted_data.end() ? &(*it) : nullptr);
+    }
+
+    /**
+     * Move the contents of a static table into m_sorted_data so that the map
+     * can be modified.
+     */
+    void copy_static_table()
+    {
+        if (!m_static_data) {
+            return;
+        }
+        m_sorted_data.clear();
+        m_sorted_data.reserve(m_static_size);
+        for (std::size_t i = 0; i <= m_static_mask; ++i) {
+            if (m_static_slots[i] != kEmptySlot) {
+                m_sorted_data.push_back(m_static_data[m_static_slots[i]]);
+            }
+        }
+        std::sort(m_sorted_data.begin(), m_sorted_data.end(), compare_formatter);
+        m_static_data = nullptr;
     }
 
     /**
@@ -241,7 +638,8 @@ class input_format_map
      */
     iterator find(char const* i_symbol)
     {
-        return detail::find(m_sorted_data, i_symbol, compare_item_formatter, equal_item_formatter);
+        detail::symbol_key key{i_symbol, detail::symbol_length(i_symbol)};
+        return detail::find(m_sorted_data, key, compare_item_formatter, equal_item_formatter);
     }
 
     /**
@@ -255,17 +653,17 @@ class input_format_map
     /**
      * Compare a formatter to a symbol. For bisection search.
      */
-    static bool compare_item_formatter(formatter_type const& i_element, char const* i_query)
+    static bool compare_item_formatter(formatter_type const& i_element, detail::symbol_key const& i_query)
     {
-        return strncmp(i_element.symbol(), i_query, kMaxSymbol) < 0;
+        return detail::compare_symbol(i_element.symbol(), i_query.data, i_query.length) < 0;
     }
 
     /**
      * Compare a formatter to a symbol. For bisection search.
      */
-    static bool equal_item_formatter(formatter_type const& i_element, char const* i_query)
+    static bool equal_item_formatter(formatter_type const& i_element, detail::symbol_key const& i_query)
     {
-        return strncmp(i_element.symbol(), i_query, kMaxSymbol) == 0;
+        return detail::compare_symbol(i_element.symbol(), i_query.data, i_query.length) == 0;
     }
 
     /// Unit type for this map
@@ -273,13 +671,36 @@ class input_format_map
 
     /// Formatters sorted by symbol
     std::vector<formatter_type> m_sorted_data;
+
+    /// Static table of formatters, or nullptr if the map uses m_sorted_data
+    formatter_type const* m_static_data;
+
+    /// Perfect-hash slots (indices into m_static_data) for the static table
+    uint8_t const* m_static_slots;
+
+    /// Number of slots in m_static_slots minus one
+    std::size_t m_static_mask;
+
+    /// Hash basis for the static table
+    uint32_t m_static_basis;
+
+    /// Number of distinct symbols in the static table
+    std::size_t m_static_size;
 };
 
+template <class Scalar, class System>
+constexpr uint8_t input_format_map<Scalar, System>::kEmptySlot;
+
 /**
  * @brief A group of input_format_maps organized by index.
  *
  * For each index, there's an input_format_map of formatters representing
  * different symbols for that quantity.
+ *
+ * For lookups where the quantity type isn't known, the group also keeps an
+ * open-addressing hash index from symbol to formatter across all maps. When a
+ * symbol appears in more than one map (e.g. "lb" is both a Mass and a Force),
+ * the map with the lowest index (the dynamic_unit ordering) wins.
  */
 template <class Scalar, class System>
 class input_format_map_group
@@ -296,6 +717,23 @@ class input_format_map_group
     using iterator = typename std::vector<map_type>::iterator;
 
   public:
+    input_format_map_group() { }
+
+    input_format_map_group(input_format_map_group const& i_other)
+        : m_sorted_data(i_other.m_sorted_data)
+    {
+        rebuild_indexes();
+    }
+
+    input_format_map_group& operator=(input_format_map_group const& i_other)
+    {
+        if (this != &i_other) {
+            m_sorted_data = i_other.m_sorted_data;
+            rebuild_indexes();
+        }
+        return *this;
+    }
+
     /**
      * Insert a formatter constructed from these arguments into the map group.
      * If a map for index<Q>() exists, this formatter is added to that group.
@@ -314,15 +752,9 @@ class input_format_map_group
      */
     bool insert(formatter_type const& i_item)
     {
-        iterator it = find(i_item.index());
-        if (it != m_sorted_data.end()) {
-            return it->insert(i_item);
-        }
-        map_type new_map(i_item.index());
-        new_map.insert(i_item);
-        m_sorted_data.push_back(new_map);
-        std::sort(m_sorted_data.begin(), m_sorted_data.end(), compare_formatter);
-        return true;
+        bool status = add(i_item);
+        rebuild_symbol_index();
+        return status;
     }
 
     /**
@@ -331,14 +763,23 @@ class input_format_map_group
      */
     bool insert(map_type const& i_whole_map)
     {
-        auto it = find(i_whole_map.index());
-        if (it != m_sorted_data.end()) {
-            *it = i_whole_map;
-            return true;
+        bool status = add(i_whole_map);
+        rebuild_symbol_index();
+        return status;
+    }
+
+    /**
+     * Insert each formatter or map in [i_first, i_last) as above. The symbol
+     * index is rebuilt once, so prefer this to repeated single inserts when
+     * building a group.
+     */
+    template <class Iterator>
+    void insert(Iterator i_first, Iterator i_last)
+    {
+        for (; i_first != i_last; ++i_first) {
+            add(*i_first);
         }
-        m_sorted_data.push_back(i_whole_map);
-        std::sort(m_sorted_data.begin(), m_sorted_data.end(), compare_formatter);
-        return true;
+        rebuild_symbol_index();
     }
 
     /**
@@ -348,7 +789,8 @@ class input_format_map_group
     {
         auto it = find(i_index);
         if (it != m_sorted_data.end()) {
-            m_sorted_data.erase(it);
+            remove(it);
+            rebuild_symbol_index();
             return true;
         }
         return false;
@@ -364,8 +806,9 @@ class input_format_map_group
         if (it != m_sorted_data.end()) {
             bool status = it->erase(i_symbol);
             if (it->size() == 0) {
-                m_sorted_data.erase(it);
+                remove(it);
             }
+            rebuild_symbol_index();
             return status;
         }
         return false;
@@ -380,9 +823,21 @@ class input_format_map_group
      */
     template <class Q, DIM_IS_QUANTITY(Q)>
     Q to_quantity(typename Q::scalar const& i_scalar, char const* i_symbol) const
+    {
+        return to_quantity<Q>(i_scalar, i_symbol, detail::symbol_length(i_symbol));
+    }
+
+    /**
+     * Format a scalar and the symbol [i_symbol, i_symbol + i_length) into a
+     * quantity of type Q. If no map for index<Q>() exists, or there is no
+     * matching symbol in the map, this returns a bad_quantity.
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    Q to_quantity(typename Q::scalar const& i_scalar, char const* i_symbol, std::size_t i_length) const
     {
         auto it = find(::dim::index<Q>());
-        return (it != m_sorted_data.end() ? it->template to_quantity<Q>(i_scalar, i_symbol) : Q::bad_quantity());
+        return (it != m_sorted_data.end() ? it->template to_quantity<Q>(i_scalar, i_symbol, i_length)
+                                          : Q::bad_quantity());
     }
 
     /**
@@ -398,28 +853,33 @@ class input_format_map_group
 
     /**
      * Format a scalar/symbol pair into a dynamic quantity. Unlike the templated
-     * version, this version searchs *all* maps for the symbol, using the first
-     * formatter found. If the symbol is not in any maps, this returns a
-     * bad_quantity.
+     * version, this version searchs *all* maps for the symbol, using the
+     * formatter from the map with the lowest index. If the symbol is not in any
+     * maps, this returns a bad_quantity.
      *
      * @note This form is not preferred. It can suffer buffer overruns.
      */
     quantity_type to_quantity(Scalar const& i_scalar, char const* i_symbol) const
     {
-        for (auto const& map : m_sorted_data) {
-            quantity_type value = map.to_quantity(i_scalar, i_symbol);
-            if (!value.is_bad()) {
-                return value;
-            }
-        }
-        return quantity_type::bad_quantity();
+        return to_quantity(i_scalar, i_symbol, detail::symbol_length(i_symbol));
+    }
+
+    /**
+     * Format a scalar and the symbol [i_symbol, i_symbol + i_length) into a
+     * dynamic quantity, searching all maps as above. If the symbol is not in
+     * any maps, this returns a bad_quantity.
+     */
+    quantity_type to_quantity(Scalar const& i_scalar, char const* i_symbol, std::size_t i_length) const
+    {
+        formatter_type const* item = find_symbol(i_symbol, i_length);
+        return (item ? item->input(i_scalar) : quantity_type::bad_quantity());
     }
 
     /**
      * Format a scalar/symbol pair into a dynamic quantity. Unlike the templated
-     * version, this version searchs *all* maps for the symbol, using the first
-     * formatter found. If the symbol is not in any maps, this returns a
-     * bad_quantity.
+     * version, this version searchs *all* maps for the symbol, using the
+     * formatter from the map with the lowest index. If the symbol is not in any
+     * maps, this returns a bad_quantity.
      */
     quantity_type to_quantity(formatted const& i_input) const { return to_quantity(i_input.value(), i_input.symbol()); }
 
@@ -432,10 +892,47 @@ class input_format_map_group
         return (it != m_sorted_data.end() ? &(*it) : nullptr);
     }
 
+    /**
+     * Find the formatter for a symbol in any map, preferring the map with the
+     * lowest index. Returns nullptr if the symbol is unknown. Do not delete this
+     * pointer.
+     */
+    formatter_type const* find_symbol(char const* i_symbol) const
+    {
+        return find_symbol(i_symbol, detail::symbol_length(i_symbol));
+    }
+
+    /**
+     * Find the formatter for the symbol [i_symbol, i_symbol + i_length), which
+     * need not be nul-terminated, as above.
+     */
+    formatter_type const* find_symbol(char const* i_symbol, std::size_t i_length) const
+    {
+        if (m_symbol_index.empty()) {
+            return nullptr;
+        }
+        uint32_t hash = detail::symbol_hash(i_symbol, i_symbol + i_length);
+        std::size_t mask = m_symbol_index.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            symbol_entry const& entry = m_symbol_index[i];
+            if (!entry.item) {
+                return nullptr;
+            }
+            if (entry.hash == hash && detail::compare_symbol(entry.item->symbol(), i_symbol, i_length) == 0) {
+                return entry.item;
+            }
+        }
+    }
+
     /**
      * Drop all maps.
      */
-    void clear() { m_sorted_data.clear(); }
+    void clear()
+    {
+        m_sorted_data.clear();
+        m_unit_index.clear();
+        m_symbol_index.clear();
+    }
 
     /**
      * Get the number of maps contained in the group.
@@ -444,35 +941,126 @@ class input_format_map_group
 
   private:
     /**
-     * Look up a may by index type.
+     * Look up a map by index type.
      */
     const_iterator find(unit_type i_index) const
     {
-        return detail::find(m_sorted_data, i_index, compare_item_formatter, equal_item_formatter);
+        std::size_t position = m_unit_index.find(i_index.raw());
+        return (position != detail::unit_index::npos ? m_sorted_data.begin() + position : m_sorted_data.end());
     }
 
     /**
-     * Look up a may by index type.
+     * Look up a map by index type.
      */
-    iterator find(unit_type i_index) { return detail::find(m_sorted_data, i_index, compare_item_formatter, equal_item_formatter); }
+    iterator find(unit_type i_index)
+    {
+        std::size_t position = m_unit_index.find(i_index.raw());
+        return (position != detail::unit_index::npos ? m_sorted_data.begin() + position : m_sorted_data.end());
+    }
 
     /**
      * Compare maps by index type. Used for sorting.
      */
     static bool compare_formatter(map_type const& i_left, map_type const& i_right) { return i_left.index() < i_right.index(); }
 
+
     /**
-     * Compare a map to an index type. Used for searching.
+     * Add a formatter to the map for its index, creating the map if needed.
+     * This keeps the unit index current but not the symbol index.
      */
-    static bool compare_item_formatter(map_type const& i_element, unit_type i_query) { return i_element.index() < i_query; }
+    bool add(formatter_type const& i_item)
+    {
+        iterator it = find(i_item.index());
+        if (it != m_sorted_data.end()) {
+            return it->insert(i_item);
+        }
+        map_type new_map(i_item.index());
+        new_map.insert(i_item);
+        return add(new_map);
+    }
+
+    /**
+     * Add or replace the map for i_whole_map.index(). This keeps the unit
+     * index current but not the symbol index.
+     */
+    bool add(map_type const& i_whole_map)
+    {
+        iterator it = find(i_whole_map.index());
+        if (it != m_sorted_data.end()) {
+            *it = i_whole_map;
+            return true;
+        }
+        it = std::upper_bound(m_sorted_data.begin(), m_sorted_data.end(), i_whole_map, compare_formatter);
+        std::size_t position = static_cast<std::size_t>(it - m_sorted_data.begin());
+        m_sorted_data.insert(it, i_whole_map);
+        m_unit_index.insert(i_whole_map.index().raw(), position);
+        return true;
+    }
+
+    /// Remove the map at i_position, keeping the unit index current
+    void remove(iterator i_position)
+    {
+        m_unit_index.erase(i_position->index().raw(), static_cast<std::size_t>(i_position - m_sorted_data.begin()));
+        m_sorted_data.erase(i_position);
+    }
+
+    /// Entry in the symbol index
+    struct symbol_entry {
+        uint32_t hash;
+        formatter_type const* item;
+    };
+
+    /// Rebuild the unit and symbol indexes after the maps are replaced wholesale
+    void rebuild_indexes()
+    {
+        m_unit_index.rebuild(m_sorted_data, [](map_type const& i_map) { return i_map.index(); });
+        rebuild_symbol_index();
+    }
 
     /**
-     * Compare a map to an index type. Used for searching.
+     * Rebuild the symbol index after the maps change. Formatters may move when
+     * a map changes, so the index is rebuilt rather than patched. It is kept at
+     * most half full, so probe sequences stay short.
      */
-    static bool equal_item_formatter(map_type const& i_element, unit_type i_query) { return i_element.index() == i_query; }
+    void rebuild_symbol_index()
+    {
+        std::size_t count = 0;
+        for (auto const& map : m_sorted_data) {
+            count += map.size();
+        }
+        std::size_t capacity = 0;
+        if (count > 0) {
+            capacity = 16;
+            while (capacity < 2 * count) {
+                capacity *= 2;
+            }
+        }
+        m_symbol_index.assign(capacity, symbol_entry{0, nullptr});
+        std::size_t mask = capacity - 1;
+        // Maps are visited in index order, so the first symbol placed wins
+        for (auto const& map : m_sorted_data) {
+            map.for_each([this, mask](formatter_type const& i_item) {
+                uint32_t hash = detail::symbol_hash(i_item.symbol());
+                std::size_t i = hash & mask;
+                for (; m_symbol_index[i].item; i = (i + 1) & mask) {
+                    if (m_symbol_index[i].hash == hash
+                        && strncmp(m_symbol_index[i].item->symbol(), i_item.symbol(), kMaxSymbol) == 0) {
+                        return;
+                    }
+                }
+                m_symbol_index[i] = symbol_entry{hash, &i_item};
+            });
+        }
+    }
 
     /// input_format_maps sorted by index type
     std::vector<map_type> m_sorted_data;
+
+    /// Index from unit code to position in m_sorted_data
+    detail::unit_index m_unit_index;
+
+    /// Open-addressing index from symbol to formatter over all maps
+    std::vector<symbol_entry> m_symbol_index;
 };
 
 /**
@@ -537,11 +1125,39 @@ class output_format_map
             *it = i_item;
             return true;
         }
-        m_sorted_data.push_back(i_item);
-        std::sort(m_sorted_data.begin(), m_sorted_data.end(), compare_formatter);
+        it = std::upper_bound(m_sorted_data.begin(), m_sorted_data.end(), i_item, compare_formatter);
+        std::size_t position = static_cast<std::size_t>(it - m_sorted_data.begin());
+        m_sorted_data.insert(it, i_item);
+        m_unit_index.insert(i_item.index().raw(), position);
         return true;
     }
 
+    /**
+     * Add or replace each formatter in [i_first, i_last). When two share an
+     * index, the later one wins. The formatters are sorted and indexed once.
+     */
+    template <class Iterator>
+    void insert(Iterator i_first, Iterator i_last)
+    {
+        std::vector<formatter_type> sorted(i_first, i_last);
+        std::stable_sort(sorted.begin(), sorted.end(), compare_formatter);
+        // Keep the last of each run of formatters for one index
+        std::vector<formatter_type> merged;
+        merged.reserve(sorted.size());
+        for (std::size_t i = 0; i < sorted.size(); ++i) {
+            if (i + 1 == sorted.size() || sorted[i].index() != sorted[i + 1].index()) {
+                merged.push_back(sorted[i]);
+            }
+        }
+        // New formatters replace existing ones for the same index
+        std::vector<formatter_type> existing;
+        existing.swap(m_sorted_data);
+        m_sorted_data.reserve(existing.size() + merged.size());
+        std::set_union(merged.begin(), merged.end(), existing.begin(), existing.end(),
+                       std::back_inserter(m_sorted_data), compare_formatter);
+        rebuild_unit_index();
+    }
+
     /**
      * Get a pointer for the formatter for a given unit_type (or nullptr if not found).
      */
@@ -558,6 +1174,7 @@ class output_format_map
     {
         auto it = find(i_index);
         if (it != m_sorted_data.end()) {
+            m_unit_index.erase(i_index.raw(), static_cast<std::size_t>(it - m_sorted_data.begin()));
             m_sorted_data.erase(it);
             return true;
         }
@@ -567,7 +1184,11 @@ class output_format_map
     /**
      * Remove all formatters.
      */
-    void clear() { m_sorted_data.clear(); }
+    void clear()
+    {
+        m_sorted_data.clear();
+        m_unit_index.clear();
+    }
 
     /**
      * Get the number of formatters in the map.
@@ -580,13 +1201,24 @@ class output_format_map
      */
     const_iterator find(unit_type id) const
     {
-        return detail::find(m_sorted_data, id, compare_item_formatter, equal_item_formatter);
+        std::size_t position = m_unit_index.find(id.raw());
+        return (position != detail::unit_index::npos ? m_sorted_data.begin() + position : m_sorted_data.end());
     }
 
     /**
      * Look up a unit_type in the map
      */
-    iterator find(unit_type id) { return detail::find(m_sorted_data, id, compare_item_formatter, equal_item_formatter); }
+    iterator find(unit_type id)
+    {
+        std::size_t position = m_unit_index.find(id.raw());
+        return (position != detail::unit_index::npos ? m_sorted_data.begin() + position : m_sorted_data.end());
+    }
+
+    /// Rebuild the unit index after the formatters change
+    void rebuild_unit_index()
+    {
+        m_unit_index.rebuild(m_sorted_data, [](formatter_type const& i_item) { return i_item.index(); });
+    }
 
     /**
      * Sorting function for the map
@@ -596,20 +1228,13 @@ class output_format_map
         return i_left.index() < i_right.index();
     }
 
-    /**
-     * Searching function for the map (used for bisection search).
-     */
-    static bool compare_item_formatter(formatter_type const& i_element, unit_type i_query) { return i_element.index() < i_query; }
-
-    /**
-     * Equality function for the map (used in final phase of search).
-     */
-    static bool equal_item_formatter(formatter_type const& i_element, unit_type i_query) { return i_element.index() == i_query; }
-
     /**
      * A list of formatters sorted by index.
      */
     std::vector<formatter_type> m_sorted_data;
+
+    /// Index from unit code to position in m_sorted_data
+    detail::unit_index m_unit_index;
 };
 
 
@@ -631,21 +1256,35 @@ input_format_map<typename Q::scalar, typename Q::system> const& get_default_form
  * Works in two phases: (1) Look up unit_str in unit_map (backed by the
  * default_format map if not specified) (2) If not found, use Q::system's
  * dynamic quantity parser
+ *
+ * The symbol [i_symbol, i_symbol + i_length) need not be nul-terminated, so it
+ * can point straight into the text being parsed.
  */
 template <class Q, DIM_IS_QUANTITY(Q)>
-bool parse_quantity(Q& o_q, formatted_quantity<typename Q::scalar> const& i_formatted,
+bool parse_quantity(Q& o_q, typename Q::scalar const& i_value, char const* i_symbol, std::size_t i_length,
                     input_format_map<typename Q::scalar, typename Q::system> const& i_unit_map = get_default_format<Q>())
 {
-    o_q = i_unit_map.template to_quantity<Q>(i_formatted.value(), i_formatted.symbol());
+    o_q = i_unit_map.template to_quantity<Q>(i_value, i_symbol, i_length);
     if (!o_q.is_bad()) {
         return true;
     }
-    auto dynamic_q = detail::parse_standard_rep<typename Q::scalar, typename Q::system>(
-        i_formatted.symbol(), i_formatted.symbol() + kMaxSymbol);
-    o_q = (i_formatted.value() * dynamic_q).template as<Q>();
+    auto dynamic_q = detail::parse_standard_rep<typename Q::scalar, typename Q::system>(i_symbol, i_symbol + i_length);
+    o_q = (i_value * dynamic_q).template as<Q>();
     return !(o_q.is_bad());
 }
 
+/**
+ * @brief Default input parsing for quantities. Returns false if unit_str is
+ * wrong for Q. See the version taking a scalar and symbol range.
+ */
+template <class Q, DIM_IS_QUANTITY(Q)>
+bool parse_quantity(Q& o_q, formatted_quantity<typename Q::scalar> const& i_formatted,
+                    input_format_map<typename Q::scalar, typename Q::system> const& i_unit_map = get_default_format<Q>())
+{
+    return parse_quantity(o_q, i_formatted.value(), i_formatted.symbol(), detail::symbol_length(i_formatted.symbol()),
+                          i_unit_map);
+}
+
 /**
  * @brief Default input parsing for dynamic_quantities. Returns false if
  * unit_str could not be understood. This is the recommended parser entrypoint.
@@ -656,18 +1295,29 @@ bool parse_quantity(Q& o_q, formatted_quantity<typename Q::scalar> const& i_form
  * @note This version searches all maps in a map group to match a symbol.
  */
 template<class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
-bool parse_quantity(DQ& o_q, formatted_quantity<typename DQ::scalar> const& i_formatted,
+bool parse_quantity(DQ& o_q, typename DQ::scalar const& i_value, char const* i_symbol, std::size_t i_length,
                     input_format_map_group<typename DQ::scalar, typename DQ::system> const& i_unit_map)
 {
-    o_q = i_unit_map.to_quantity(i_formatted.value(), i_formatted.symbol());
+    o_q = i_unit_map.to_quantity(i_value, i_symbol, i_length);
     if (!o_q.is_bad()) {
         return true;
     }
-    o_q = i_formatted.value() *
-          detail::parse_standard_rep<typename DQ::scalar, typename DQ::system>(i_formatted.symbol(), i_formatted.symbol() + kMaxSymbol);
+    o_q = i_value * detail::parse_standard_rep<typename DQ::scalar, typename DQ::system>(i_symbol, i_symbol + i_length);
     return !o_q.is_bad();
 }
 
+/**
+ * @brief Default input parsing for dynamic_quantities, searching all maps in a
+ * map group. See the version taking a scalar and symbol range.
+ */
+template<class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+bool parse_quantity(DQ& o_q, formatted_quantity<typename DQ::scalar> const& i_formatted,
+                    input_format_map_group<typename DQ::scalar, typename DQ::system> const& i_unit_map)
+{
+    return parse_quantity(o_q, i_formatted.value(), i_formatted.symbol(), detail::symbol_length(i_formatted.symbol()),
+                          i_unit_map);
+}
+
 /**
  * @brief Default input parsing for quantities. Returns false if unit_str could
  * not be understood. This is the recommended parser entrypoint.
@@ -679,18 +1329,357 @@ bool parse_quantity(DQ& o_q, formatted_quantity<typename DQ::scalar> const& i_fo
  * know the quantity type.
  */
 template<class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
-bool parse_quantity(DQ& o_q, formatted_quantity<typename DQ::scalar> const& i_formatted,
+bool parse_quantity(DQ& o_q, typename DQ::scalar const& i_value, char const* i_symbol, std::size_t i_length,
                     input_format_map<typename DQ::scalar, typename DQ::system> const& i_unit_map)
 {
-    o_q = i_unit_map.to_quantity(i_formatted.value(), i_formatted.symbol());
+    o_q = i_unit_map.to_quantity(i_value, i_symbol, i_length);
     if (!o_q.is_bad()) {
         return true;
     }
-    o_q = i_formatted.value() *
-          detail::parse_standard_rep<typename DQ::scalar, typename DQ::system>(i_formatted.symbol(), i_formatted.symbol() + kMaxSymbol);
+    o_q = i_value * detail::parse_standard_rep<typename DQ::scalar, typename DQ::system>(i_symbol, i_symbol + i_length);
     return !o_q.is_bad();
 }
 
+/**
+ * @brief Default input parsing for dynamic_quantities, searching one map. See
+ * the version taking a scalar and symbol range.
+ */
+template<class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+bool parse_quantity(DQ& o_q, formatted_quantity<typename DQ::scalar> const& i_formatted,
+                    input_format_map<typename DQ::scalar, typename DQ::system> const& i_unit_map)
+{
+    return parse_quantity(o_q, i_formatted.value(), i_formatted.symbol(), detail::symbol_length(i_formatted.symbol()),
+                          i_unit_map);
+}
+
+/**
+ * @brief Summary of a parse_quantities() call.
+ */
+struct parse_batch_result {
+    /// Number of elements written to the output arrays
+    std::size_t count;
+    /// Number of those elements that failed to parse
+    std::size_t failed;
+};
+
+namespace detail
+{
+
+/// Find a formatter for a symbol in a single map
+template <class Scalar, class System>
+formatter<Scalar, System> const* find_formatter(input_format_map<Scalar, System> const& i_map, char const* i_symbol,
+                                                std::size_t i_length)
+{
+    return i_map.get(i_symbol, i_length);
+}
+
+/// Find a formatter for a symbol in any map of a group
+template <class Scalar, class System>
+formatter<Scalar, System> const* find_formatter(input_format_map_group<Scalar, System> const& i_group,
+                                                char const* i_symbol, std::size_t i_length)
+{
+    return i_group.find_symbol(i_symbol, i_length);
+}
+
+/**
+ * @brief Parses a sequence of fields, resolving each distinct run of unit
+ * symbols only once.
+ *
+ * The resolved symbol is kept as an affine transform (scale, offset, unit),
+ * so consecutive fields sharing a symbol cost one from_chars() and one
+ * multiply-add. The arithmetic matches parse_quantity() exactly.
+ */
+template <class Scalar, class System, class Maps>
+class batch_parser
+{
+  public:
+    explicit batch_parser(Maps const& i_maps)
+        : m_maps(i_maps), m_value(), m_length(0), m_current(), m_default(), m_resolved(false), m_has_default(false)
+    {
+    }
+
+    /**
+     * Use the unit i_symbol for fields that have no unit symbol of their own,
+     * e.g. when the unit is given once in a column header.
+     * @return false if i_symbol could not be understood. The default is then
+     * left unset.
+     */
+    bool default_symbol(char const* i_symbol)
+    {
+        m_default = resolve(i_symbol, symbol_length(i_symbol));
+        m_has_default = !m_default.unit.is_bad();
+        return m_has_default;
+    }
+
+    /**
+     * Parse the field [i_begin, i_end) into a quantity.
+     * @return std::errc{} on success, otherwise the error code. o_q is a
+     * bad_quantity() on failure.
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    std::errc parse(Q& o_q, char const* i_begin, char const* i_end)
+    {
+        transform const* item = nullptr;
+        std::errc ec = scan(item, i_begin, i_end);
+        if (ec == std::errc{} && item->unit != ::dim::index<Q>()) {
+            ec = std::errc::invalid_argument;
+        }
+        o_q = (ec == std::errc{} ? Q(m_value * item->scale + item->offset) : Q::bad_quantity());
+        return ec;
+    }
+
+    /**
+     * Parse the field [i_begin, i_end) into a dynamic_quantity.
+     * @return std::errc{} on success, otherwise the error code. o_q is a
+     * bad_quantity() on failure.
+     */
+    template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+    std::errc parse(DQ& o_q, char const* i_begin, char const* i_end)
+    {
+        transform const* item = nullptr;
+        std::errc ec = scan(item, i_begin, i_end);
+        if (ec == std::errc{} && item->unit.is_bad()) {
+            ec = std::errc::invalid_argument;
+        }
+        o_q = (ec == std::errc{} ? DQ(m_value * item->scale + item->offset, item->unit)
+                                 : DQ::bad_quantity());
+        return ec;
+    }
+
+  private:
+    /// Affine transform from a symbol's units to System's units
+    struct transform {
+        transform() : scale(), offset(), unit(dynamic_unit<System>::bad_unit()) {}
+        Scalar scale;
+        Scalar offset;
+        dynamic_unit<System> unit;
+    };
+
+    /// Read the scalar and symbol, then find the transform matching the symbol
+    std::errc scan(transform const*& o_item, char const* i_begin, char const* i_end)
+    {
+        while (i_begin < i_end && (*i_begin == ' ' || *i_begin == '\t')) {
+            ++i_begin;
+        }
+        if (i_begin == i_end) {
+            return std::errc::invalid_argument;
+        }
+        char const* symbol;
+        std::size_t length;
+        std::from_chars_result result = from_chars(i_begin, i_end, m_value, symbol, length);
+        if (result.ec != std::errc{}) {
+            return result.ec;
+        }
+        if (m_has_default && length == 0) {
+            o_item = &m_default;
+            return std::errc{};
+        }
+        if (!m_resolved || length != m_length || memcmp(m_symbol, symbol, length) != 0) {
+            m_current = resolve(symbol, length);
+            memcpy(m_symbol, symbol, length);
+            m_length = length;
+            m_resolved = true;
+        }
+        o_item = &m_current;
+        return std::errc{};
+    }
+
+    transform resolve(char const* i_symbol, std::size_t i_length) const
+    {
+        transform result;
+        formatter<Scalar, System> const* item = find_formatter(m_maps, i_symbol, i_length);
+        if (item && !item->scale().is_bad()) {
+            result.scale = item->scale().value();
+            result.offset = item->offset().value();
+            result.unit = item->index();
+        } else {
+            dynamic_quantity<Scalar, System> dq = parse_standard_rep<Scalar, System>(i_symbol, i_symbol + i_length);
+            result.scale = dq.value();
+            result.offset = Scalar(0);
+            result.unit = dq.unit();
+        }
+        return result;
+    }
+
+    Maps const& m_maps;
+    Scalar m_value;
+    char m_symbol[kMaxSymbol];
+    std::size_t m_length;
+    transform m_current;
+    transform m_default;
+    bool m_resolved;
+    bool m_has_default;
+};
+
+/// Parse i_count fields into o_quantities, where i_field(i) is the [first, last) pair of field i's text
+template <class Parser, class Q, class Field>
+parse_batch_result parse_fields(Parser& io_parser, Q* o_quantities, std::errc* o_errors, std::size_t i_count,
+                                Field const& i_field)
+{
+    parse_batch_result result{0, 0};
+    for (; result.count < i_count; ++result.count) {
+        std::pair<char const*, char const*> text = i_field(result.count);
+        std::errc ec = io_parser.parse(o_quantities[result.count], text.first, text.second);
+        if (o_errors) {
+            o_errors[result.count] = ec;
+        }
+        result.failed += (ec != std::errc{});
+    }
+    return result;
+}
+
+/**
+ * Split [i_begin, i_end) at i_delimiter and parse up to i_capacity fields into
+ * o_quantities. An empty buffer has no fields, but a delimiter is always
+ * followed by one, so "1_m," is two fields.
+ */
+template <class Parser, class Q>
+parse_batch_result parse_delimited(Parser& io_parser, Q* o_quantities, std::errc* o_errors, std::size_t i_capacity,
+                                   char const* i_begin, char const* i_end, char i_delimiter)
+{
+    parse_batch_result result{0, 0};
+    bool more = i_begin < i_end;
+    while (more && result.count < i_capacity) {
+        char const* field_end = static_cast<char const*>(memchr(i_begin, i_delimiter, i_end - i_begin));
+        more = field_end != nullptr;
+        if (!more) {
+            field_end = i_end;
+        }
+        std::errc ec = io_parser.parse(o_quantities[result.count], i_begin, field_end);
+        if (o_errors) {
+            o_errors[result.count] = ec;
+        }
+        result.failed += (ec != std::errc{});
+        ++result.count;
+        i_begin = field_end + 1;
+    }
+    return result;
+}
+
+} // namespace detail
+
+/**
+ * @brief Parse many strings into quantities in one call.
+ *
+ * Element i of o_quantities receives the parse of [i_texts[i], i_texts[i] +
+ * i_lengths[i]). Results are identical to calling from_chars() and
+ * parse_quantity() on each element, but a unit symbol is only looked up when it
+ * differs from the previous element's symbol, so columns of values sharing a
+ * unit convert with one multiply-add each. Leading blanks are skipped.
+ *
+ * @param[out] o_quantities Array of i_count results. Failed elements are bad_quantity().
+ * @param[out] o_errors Array of i_count error codes, std::errc{} on success. May be nullptr.
+ * Errors from from_chars() are passed through; a symbol that is not understood
+ * or has the wrong dimensions for Q gives invalid_argument.
+ * @param i_texts Array of i_count pointers to the text of each element
+ * @param i_lengths Array of i_count lengths of each element
+ * @param i_count Number of elements
+ * @param i_unit_map Map searched for symbols before the system's parser
+ */
+template <class Q, DIM_IS_QUANTITY(Q)>
+parse_batch_result parse_quantities(Q* o_quantities, std::errc* o_errors, char const* const* i_texts,
+                                    std::size_t const* i_lengths, std::size_t i_count,
+                                    input_format_map<typename Q::scalar, typename Q::system> const& i_unit_map =
+                                        get_default_format<Q>())
+{
+    using map_type = input_format_map<typename Q::scalar, typename Q::system>;
+    detail::batch_parser<typename Q::scalar, typename Q::system, map_type> parser(i_unit_map);
+    return detail::parse_fields(parser, o_quantities, o_errors, i_count, [=](std::size_t i) {
+        return std::make_pair(i_texts[i], i_texts[i] + i_lengths[i]);
+    });
+}
+
+/**
+ * @brief Parse one delimited buffer into quantities in one call.
+ *
+ * [i_begin, i_end) is split at each i_delimiter and the fields are parsed as
+ * in the array version of parse_quantities(). At most i_capacity fields are
+ * read; the count in the result tells how many were written. An empty field,
+ * including one after a trailing delimiter, is reported as invalid_argument.
+ */
+template <class Q, DIM_IS_QUANTITY(Q)>
+parse_batch_result parse_quantities(Q* o_quantities, std::errc* o_errors, std::size_t i_capacity,
+                                    char const* i_begin, char const* i_end, char i_delimiter,
+                                    input_format_map<typename Q::scalar, typename Q::system> const& i_unit_map =
+                                        get_default_format<Q>())
+{
+    using map_type = input_format_map<typename Q::scalar, typename Q::system>;
+    detail::batch_parser<typename Q::scalar, typename Q::system, map_type> parser(i_unit_map);
+    return detail::parse_delimited(parser, o_quantities, o_errors, i_capacity, i_begin, i_end, i_delimiter);
+}
+
+/**
+ * @brief Parse many strings into dynamic_quantities in one call.
+ *
+ * Symbols are searched for in every map of the group (see
+ * input_format_map_group::find_symbol()) before the system's parser. A symbol
+ * that is not understood gives invalid_argument. See the quantity version for
+ * the other parameters.
+ */
+template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+parse_batch_result parse_quantities(DQ* o_quantities, std::errc* o_errors, char const* const* i_texts,
+                                    std::size_t const* i_lengths, std::size_t i_count,
+                                    input_format_map_group<typename DQ::scalar, typename DQ::system> const& i_unit_map)
+{
+    using map_type = input_format_map_group<typename DQ::scalar, typename DQ::system>;
+    detail::batch_parser<typename DQ::scalar, typename DQ::system, map_type> parser(i_unit_map);
+    return detail::parse_fields(parser, o_quantities, o_errors, i_count, [=](std::size_t i) {
+        return std::make_pair(i_texts[i], i_texts[i] + i_lengths[i]);
+    });
+}
+
+/**
+ * @brief Parse one delimited buffer into dynamic_quantities in one call.
+ *
+ * See the quantity version for the parameters.
+ */
+template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+parse_batch_result parse_quantities(DQ* o_quantities, std::errc* o_errors, std::size_t i_capacity,
+                                    char const* i_begin, char const* i_end, char i_delimiter,
+                                    input_format_map_group<typename DQ::scalar, typename DQ::system> const& i_unit_map)
+{
+    using map_type = input_format_map_group<typename DQ::scalar, typename DQ::system>;
+    detail::batch_parser<typename DQ::scalar, typename DQ::system, map_type> parser(i_unit_map);
+    return detail::parse_delimited(parser, o_quantities, o_errors, i_capacity, i_begin, i_end, i_delimiter);
+}
+
+#if __cplusplus >= 201703L
+/**
+ * @brief Parse a span of string_views into quantities in one call.
+ *
+ * See the pointer/length version for the parameters.
+ */
+template <class Q, DIM_IS_QUANTITY(Q)>
+parse_batch_result parse_quantities(Q* o_quantities, std::errc* o_errors, std::string_view const* i_texts,
+                                    std::size_t i_count,
+                                    input_format_map<typename Q::scalar, typename Q::system> const& i_unit_map =
+                                        get_default_format<Q>())
+{
+    using map_type = input_format_map<typename Q::scalar, typename Q::system>;
+    detail::batch_parser<typename Q::scalar, typename Q::system, map_type> parser(i_unit_map);
+    return detail::parse_fields(parser, o_quantities, o_errors, i_count, [=](std::size_t i) {
+        return std::make_pair(i_texts[i].data(), i_texts[i].data() + i_texts[i].size());
+    });
+}
+
+/**
+ * @brief Parse a span of string_views into dynamic_quantities in one call.
+ *
+ * See the pointer/length version for the parameters.
+ */
+template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+parse_batch_result parse_quantities(DQ* o_quantities, std::errc* o_errors, std::string_view const* i_texts,
+                                    std::size_t i_count,
+                                    input_format_map_group<typename DQ::scalar, typename DQ::system> const& i_unit_map)
+{
+    using map_type = input_format_map_group<typename DQ::scalar, typename DQ::system>;
+    detail::batch_parser<typename DQ::scalar, typename DQ::system, map_type> parser(i_unit_map);
+    return detail::parse_fields(parser, o_quantities, o_errors, i_count, [=](std::size_t i) {
+        return std::make_pair(i_texts[i].data(), i_texts[i].data() + i_texts[i].size());
+    });
+}
+#endif
+
 /**
  * @brief Turn a quantity into a formatted_quantity. 
  *
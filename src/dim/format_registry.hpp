@@ -0,0 +1,341 @@
+#pragma once
+#include "codec.hpp"
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef DIM_EXCEPTIONS
+#include "dim/incommensurable_exception.hpp"
+#endif
+
+/**
+ * Unit format configuration that can be reloaded while other threads format.
+ *
+ * A format_snapshot is an immutable set of input and output format maps, read
+ * from a text file on top of a base set. A format_registry publishes the
+ * current snapshot with a generation number. Each reading thread keeps its own
+ * shared pointer to the snapshot and only refreshes it when the generation
+ * changes, so reading is one atomic load and formatting in flight finishes on
+ * the snapshot it started with.
+ */
+
+namespace dim
+{
+
+/**
+ * @brief An immutable (once published) set of input and output format maps
+ * with a quantity_codec using them.
+ *
+ * read() adds formatters from a text stream with one formatter per line:
+ * ```
+ * # direction symbol scale [offset]
+ * output psi  6894.757293168_Pa
+ * both   degF 0.5555555555555556_K 255.3722222222222_K
+ * input  kt   0.5144444444444445_m/s
+ * ```
+ * The direction is `input`, `output` or `both`. The scale (and optional
+ * offset) are quantities as read by from_string(), using the maps already in
+ * the snapshot, so `1_in` works if `in` is an input symbol. Blank lines and
+ * text after a `#` are ignored.
+ */
+template <class Scalar, class System>
+class format_snapshot
+{
+  public:
+    using codec_type = quantity_codec<Scalar, System>;
+    using dynamic_type = dynamic_quantity<Scalar, System>;
+    using formatter_type = formatter<Scalar, System>;
+    using map_group_type = input_format_map_group<Scalar, System>;
+    using output_map_type = output_format_map<Scalar, System>;
+
+    /// A snapshot with no formatters
+    format_snapshot()
+        : m_codec(&m_input, &m_output)
+    {
+    }
+
+    /// A snapshot starting from copies of the given maps
+    format_snapshot(map_group_type const& i_input, output_map_type const& i_output)
+        : m_input(i_input),
+          m_output(i_output),
+          m_codec(&m_input, &m_output)
+    {
+    }
+
+    /// A snapshot starting from copies of the maps in a facet
+    explicit format_snapshot(quantity_facet<Scalar, System> const& i_facet)
+        : format_snapshot(i_facet.input_formats(), i_facet.output_formats())
+    {
+    }
+
+    format_snapshot(format_snapshot const& i_other)
+        : format_snapshot(i_other.m_input, i_other.m_output)
+    {
+    }
+
+    format_snapshot& operator=(format_snapshot const&) = delete;
+
+    /**
+     * @brief Add the formatters defined in a text stream (see the class
+     * description), replacing formatters with the same symbol.
+     *
+     * Nothing is added unless every line is valid.
+     *
+     * @param io_input Stream to read to the end
+     * @param[out] o_error_line If not null, set to the (1-based) number of the
+     * first bad line, or 0 if there was none
+     * @return True if every line was valid
+     */
+    bool read(std::istream& io_input, std::size_t* o_error_line = nullptr)
+    {
+        struct definition {
+            bool input;
+            bool output;
+            formatter_type format;
+        };
+        std::vector<definition> definitions;
+        std::string line;
+        std::size_t line_number = 0;
+        if (o_error_line) {
+            *o_error_line = 0;
+        }
+        while (std::getline(io_input, line)) {
+            ++line_number;
+            std::string fields[4];
+            std::size_t count = split(line, fields);
+            if (count == 0) {
+                continue;
+            }
+            bool input = (fields[0] == "input" || fields[0] == "both");
+            bool output = (fields[0] == "output" || fields[0] == "both");
+            dynamic_type scale = dynamic_type::bad_quantity();
+            dynamic_type offset = dynamic_type::bad_quantity();
+            bool valid = (input || output) && count >= 3 && count <= 4 &&
+                         fields[1].size() < static_cast<std::size_t>(kMaxSymbol) &&
+                         m_codec.parse(scale, fields[2].data(), fields[2].size()) &&
+                         (count < 4 || m_codec.parse(offset, fields[3].data(), fields[3].size()));
+            if (valid) {
+#ifdef DIM_EXCEPTIONS
+                try {
+                    definitions.push_back(definition{input, output, formatter_type(fields[1].c_str(), scale, offset)});
+                } catch (incommensurable_exception const&) {
+                    valid = false;
+                }
+#else
+                definitions.push_back(definition{input, output, formatter_type(fields[1].c_str(), scale, offset)});
+                valid = !definitions.back().format.scale().is_bad();
+#endif
+            }
+            if (!valid) {
+                if (o_error_line) {
+                    *o_error_line = line_number;
+                }
+                return false;
+            }
+        }
+        for (definition const& item : definitions) {
+            if (item.input) {
+                m_input.insert(item.format);
+            }
+            if (item.output) {
+                m_output.insert(item.format);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Codec using this snapshot's maps
+     */
+    codec_type const& codec() const { return m_codec; }
+
+    /**
+     * Input format maps
+     */
+    map_group_type const& input_formats() const { return m_input; }
+
+    /**
+     * Output format map
+     */
+    output_map_type const& output_formats() const { return m_output; }
+
+  private:
+    /**
+     * Split a line into up to four whitespace separated fields, dropping any
+     * comment. Returns the number of fields, or 5 if there are too many.
+     */
+    static std::size_t split(std::string const& i_line, std::string (&o_fields)[4])
+    {
+        std::size_t count = 0;
+        std::size_t end = i_line.find('#');
+        if (end == std::string::npos) {
+            end = i_line.size();
+        }
+        for (std::size_t pos = 0; pos < end;) {
+            while (pos < end && std::isspace(static_cast<unsigned char>(i_line[pos]))) {
+                ++pos;
+            }
+            std::size_t first = pos;
+            while (pos < end && !std::isspace(static_cast<unsigned char>(i_line[pos]))) {
+                ++pos;
+            }
+            if (pos > first) {
+                if (count == 4) {
+                    return 5;
+                }
+                o_fields[count++] = i_line.substr(first, pos - first);
+            }
+        }
+        return count;
+    }
+
+    map_group_type m_input;
+    output_map_type m_output;
+    codec_type m_codec;
+};
+
+/**
+ * @brief Publishes format_snapshots to any number of reading threads.
+ *
+ * load() builds a new snapshot from the base maps and a text stream, then
+ * publishes it under a lock with a new generation number. current() returns
+ * the calling thread's cached pointer to the snapshot, and only takes the lock
+ * to refresh it when the generation has changed, so in the common case it is
+ * one acquire load and a compare, with no lock and no reference count touched.
+ *
+ * A replaced snapshot is freed when the last pointer to it is released, so a
+ * reader still using it is unaffected and nothing accumulates however often
+ * formats are reloaded. Each thread's cache holds its snapshot until that
+ * thread next calls current() on a registry of the same type.
+ *
+ * ```
+ * std::unique_ptr<si::facet> defaults(si::system::make_default_facet());
+ * dim::format_registry<double, si::system> formats(*defaults);
+ * formats.load_file("units.conf"); // On startup and on SIGHUP
+ * ...
+ * formats.current()->codec().to_chars(first, last, pressure); // In any thread
+ * ```
+ * A reader formatting many values should hold one current() for the batch
+ * rather than calling it per value.
+ */
+template <class Scalar, class System>
+class format_registry
+{
+  public:
+    using snapshot_type = format_snapshot<Scalar, System>;
+    using snapshot_pointer = std::shared_ptr<snapshot_type const>;
+
+    /// A registry whose base has no formatters
+    format_registry()
+        : m_base(new snapshot_type),
+          m_generation(0)
+    {
+        publish(snapshot_pointer(new snapshot_type(*m_base)));
+    }
+
+    /// A registry whose base is a copy of the maps in i_facet
+    explicit format_registry(quantity_facet<Scalar, System> const& i_facet)
+        : m_base(new snapshot_type(i_facet)),
+          m_generation(0)
+    {
+        publish(snapshot_pointer(new snapshot_type(*m_base)));
+    }
+
+    format_registry(format_registry const&) = delete;
+    format_registry& operator=(format_registry const&) = delete;
+
+    /**
+     * @brief The current snapshot, as this thread's cached pointer to it.
+     *
+     * The reference is valid until this thread next calls current() on a
+     * registry of the same type. Copy the pointer to keep the snapshot for
+     * longer; a copy stays valid after the snapshot has been replaced.
+     */
+    snapshot_pointer const& current() const
+    {
+        reader_cache& cache = thread_cache();
+        if (cache.generation != m_generation.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            cache.snapshot = m_current;
+            cache.generation = m_generation.load(std::memory_order_relaxed);
+        }
+        return cache.snapshot;
+    }
+
+    /**
+     * @brief Read a new snapshot (the base maps plus the formatters in
+     * io_input) and make it current. On error the current snapshot is kept.
+     * @see format_snapshot::read()
+     */
+    bool load(std::istream& io_input, std::size_t* o_error_line = nullptr)
+    {
+        std::unique_ptr<snapshot_type> next(new snapshot_type(*m_base));
+        if (!next->read(io_input, o_error_line)) {
+            return false;
+        }
+        publish(snapshot_pointer(std::move(next)));
+        return true;
+    }
+
+    /**
+     * @brief Read a new snapshot from the file at i_path. Returns false,
+     * leaving o_error_line zero, if the file cannot be opened.
+     */
+    bool load_file(char const* i_path, std::size_t* o_error_line = nullptr)
+    {
+        std::ifstream input(i_path);
+        if (!input) {
+            if (o_error_line) {
+                *o_error_line = 0;
+            }
+            return false;
+        }
+        return load(input, o_error_line);
+    }
+
+    /**
+     * @brief Make i_snapshot current. The previous snapshot is freed once no
+     * reader holds it.
+     */
+    void publish(snapshot_pointer i_snapshot)
+    {
+        uint64_t generation = next_generation();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_current.swap(i_snapshot);
+        m_generation.store(generation, std::memory_order_release);
+    }
+
+  private:
+    /// A thread's pointer to the snapshot it last read, and the generation that snapshot was published as
+    struct reader_cache {
+        uint64_t generation = 0;
+        snapshot_pointer snapshot;
+    };
+
+    /// The calling thread's cache, shared by all registries of this type since generations are never reused
+    static reader_cache& thread_cache()
+    {
+        static thread_local reader_cache s_cache;
+        return s_cache;
+    }
+
+    /// A generation number that no registry of this type has published, never 0
+    static uint64_t next_generation()
+    {
+        static std::atomic<uint64_t> s_generation(0);
+        return s_generation.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    std::unique_ptr<snapshot_type const> m_base;
+    mutable std::mutex m_mutex;
+    snapshot_pointer m_current; // Guarded by m_mutex
+    std::atomic<uint64_t> m_generation;
+};
+
+} // namespace dim
@@ -4,6 +4,9 @@
 #if __cplusplus >= 201703L
 #include <charconv>
 #endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace dim
 {
@@ -151,6 +154,102 @@ unit_parse_state unit_string_scanner::handle_exponent(char c)
     return unit_parse_state::kEnd;
 }
 
+/// Character classes used by scan_simple_symbol(), one bit per class
+enum symbol_class : uint32_t {
+    kClassLetter = 1,
+    kClassOperator = 2,
+    kClassSpecial = 4,
+};
+
+/// Classify one character for scan_simple_symbol()
+static uint32_t classify(char c)
+{
+    unsigned char u = static_cast<unsigned char>(c);
+    if (((u | 0x20) >= 'a' && (u | 0x20) <= 'z')) {
+        return kClassLetter;
+    } else if (isoperator(c)) {
+        return kClassOperator;
+    } else if (c == '^' || c == '(' || c == ')' || u >= 0x80) {
+        return kClassSpecial;
+    }
+    return 0;
+}
+
+/// Index of the lowest set bit of a non-zero mask
+static int lowest_bit(uint32_t i_mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(i_mask);
+#else
+    int index = 0;
+    while (!(i_mask & 1u)) {
+        i_mask >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+char const* scan_simple_symbol(char const* i_begin, char const* i_end, unit_parse_state& o_state)
+{
+    static_assert(kMaxSymbol <= 32, "Symbol masks hold 32 bits");
+    int size = static_cast<int>(i_end - i_begin < kMaxSymbol ? i_end - i_begin : kMaxSymbol);
+    uint32_t letters = 0;
+    uint32_t operators = 0;
+    uint32_t specials = 0;
+    int i = 0;
+#ifdef __SSE2__
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(i_begin + i));
+        __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+        // Bytes >= 0x80 are negative, so they fall outside ['a', 'z']
+        __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                       _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+        __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('*')),
+                                               _mm_cmpeq_epi8(bytes, _mm_set1_epi8('/'))),
+                                  _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')));
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('^')),
+                                                    _mm_cmpeq_epi8(bytes, _mm_set1_epi8('('))),
+                                       _mm_cmpeq_epi8(bytes, _mm_set1_epi8(')')));
+        letters |= static_cast<uint32_t>(_mm_movemask_epi8(letter)) << i;
+        operators |= static_cast<uint32_t>(_mm_movemask_epi8(op)) << i;
+        specials |= static_cast<uint32_t>(_mm_movemask_epi8(special) | _mm_movemask_epi8(bytes)) << i;
+    }
+#endif
+    for (; i < size; ++i) {
+        uint32_t type = classify(i_begin[i]);
+        letters |= ((type & kClassLetter) ? 1u : 0u) << i;
+        operators |= ((type & kClassOperator) ? 1u : 0u) << i;
+        specials |= ((type & kClassSpecial) ? 1u : 0u) << i;
+    }
+
+    // The symbol run is the prefix of letters and operators
+    uint32_t outside = ~(letters | operators);
+    int length = (outside ? lowest_bit(outside) : 32);
+    length = (length < size ? length : size);
+    if (length < size && (specials >> length) & 1u) {
+        return nullptr;
+    }
+    uint32_t run = (length < 32 ? (1u << length) - 1u : ~0u);
+
+    // An operator at the start or after another operator is an error there
+    uint32_t errors = operators & ((operators << 1) | 1u) & run;
+    if (errors) {
+        o_state = unit_parse_state::kError;
+        return i_begin + lowest_bit(errors);
+    }
+    bool ends_in_letter = (length > 0 && ((letters >> (length - 1)) & 1u));
+    if (length < size) {
+        // Any other character ends a symbol, but can't follow an operator
+        o_state = (ends_in_letter ? unit_parse_state::kEnd : unit_parse_state::kError);
+    } else if (length == 0) {
+        o_state = unit_parse_state::kStart;
+    } else {
+        o_state = (ends_in_letter ? unit_parse_state::kSymbol : unit_parse_state::kOperator);
+    }
+    return i_begin + length;
+}
+
 // requires at most 4 chars of space, no null terminator
 #if __cplusplus >= 201703L
 char* print_int8(char* o_buf, int8_t d)
@@ -4,6 +4,8 @@
 #endif
 #include "dynamic_quantity.hpp"
 #include "io_detail.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <limits>
 #include <system_error>
@@ -81,7 +83,11 @@ class formatted_quantity
  * regardless of the underlying rep.
  *
  * Formatters have the quantity type erased, tracking it at runtime via a unit_code.
- *
+ * The transform is checked once, on construction, and kept as plain scalars,
+ * so input costs a unit comparison and a multiply and add, and output a unit
+ * comparison and a subtract and divide. Output divides rather than multiplying
+ * by a stored 1/scale, because that rounds to the value that reads back
+ * exactly through input() more often.
  */
 template <class Scalar, class System>
 class formatter
@@ -103,22 +109,23 @@ class formatter
      *
      * @throws (with DIM_EXCEPTIONS defined) If i_scale and i_add do not have matching units.
      */
-    formatter(char const* i_symbol, dynamic_type const& i_scale, dynamic_type const& i_add = dynamic_type::bad_quantity())
-        : m_scale(i_scale),
-          m_add(i_add)
+    DIM_CONSTEXPR14 formatter(char const* i_symbol, dynamic_type const& i_scale,
+                              dynamic_type const& i_add = dynamic_type::bad_quantity())
+        : m_symbol{'\0'},
+          m_unit(i_scale.unit()),
+          m_scale(i_scale.value()),
+          m_offset(i_add.is_bad() ? scalar(0) : i_add.value())
     {
-        strncpy(m_symbol, i_symbol, kMaxSymbol - 1);
-        if (m_add.is_bad()) {
-            m_add = dynamic_type(0, m_scale.unit());
-        }
-        if (m_add.unit() != m_scale.unit()) {
+        copy_symbol(i_symbol);
+        if (!i_add.is_bad() && i_add.unit() != i_scale.unit()) {
 #ifdef DIM_EXCEPTIONS
             throw incommensurable_exception(i_scale.unit(), i_add.unit(),
                                             "Units of affine transformation in formatter are incompatible");
 #else
-            m_add = dynamic_type::bad_quantity();
-            m_scale = dynamic_type::bad_quantity();
-            strncpy(m_symbol, "INCONSISTENT", kMaxSymbol - 1);
+            m_unit = dynamic_unit<System>::bad_unit();
+            m_scale = dynamic_type::bad_quantity().value();
+            m_offset = m_scale;
+            copy_symbol("INCONSISTENT");
 #endif
         }
     }
@@ -132,13 +139,14 @@ class formatter
      * @param i_add The additive part of the affine transform. 
      */
     template <class Q, DIM_IS_QUANTITY(Q)>
-    formatter(char const* i_symbol, Q const& i_scale, Q const& i_add = Q(0))
+    DIM_CONSTEXPR14 formatter(char const* i_symbol, Q const& i_scale, Q const& i_add = Q(0))
         : formatter(i_symbol, dynamic_type(i_scale), dynamic_type(i_add))
     {
     }
 
     /**
-     * Non-dimensionalize a quantity to match this format's units.
+     * Non-dimensionalize a quantity to match this format's units, as
+     * (q - offset) / scale.
      * @param q Quantity to nondimensionalize
      * @return A scalar measuring q in units of this transform
      * @throws (with DIM_EXCEPTIONS defined) If Q is not compatible with this format's unit
@@ -146,7 +154,7 @@ class formatter
     template <class Q, DIM_IS_QUANTITY(Q)>
     scalar non_dim(Q const& q) const
     {
-        return non_dim(dynamic_type(q));
+        return non_dim(::dim::index<Q>(), dimensionless_cast(q));
     }
 
     /**
@@ -155,19 +163,7 @@ class formatter
      * @return A scalar measuring q in units of this transform
      * @throws (with DIM_EXCEPTIONS defined) If Q is not compatible with this format's unit
      */
-    scalar non_dim(dynamic_type const& q) const
-    {
-        dynamic_type result = (q + m_add) / m_scale;
-#ifdef DIM_EXCEPTIONS
-        if (result.dimensionless()) {
-            return dimensionless_cast(result);
-        }
-        throw incommensurable_exception(::dim::index(q), m_scale.unit(),
-                                        "Could not nondimensionalize quantity. Dimensions are incompatible");
-#else
-        return (result.dimensionless() ? dimensionless_cast(result) : std::numeric_limits<scalar>::quiet_NaN());
-#endif
-    }
+    scalar non_dim(dynamic_type const& q) const { return non_dim(q.unit(), q.value()); }
 
     /**
      * Format a dynamic_quantity into a scalar and a unit symbol string.
@@ -192,28 +188,136 @@ class formatter
     template <class Q, DIM_IS_QUANTITY(Q)>
     Q input(scalar const& s) const
     {
-        return (s * m_scale + m_add).template as<Q>();
+        if (m_unit == ::dim::index<Q>()) {
+            return Q(s * m_scale + m_offset);
+        }
+#ifdef DIM_EXCEPTIONS
+        throw incommensurable_exception(m_unit, ::dim::index<Q>(), "Could not convert dynamic_quantity to quantity");
+#else
+        return Q::bad_quantity();
+#endif
     }
 
     /**
      * Transform a scalar value matching this unit symbol string into a dynamic_quantity.
      */
-    dynamic_type input(scalar const& s) const { return m_scale * dynamic_type(s) + m_add; }
+    dynamic_type input(scalar const& s) const { return dynamic_type(s * m_scale + m_offset, m_unit); }
+
+    /**
+     * Transform i_count scalars matching this unit symbol string into scalars
+     * in the units of System, like input() for each one. This uses SIMD
+     * kernels for float and double, which never fuse the multiply and add, so
+     * the results can differ from input() in the last bit where the calling
+     * code is compiled with fused multiply-adds. o_values may be i_values for
+     * an in-place conversion.
+     */
+    void input(scalar const* i_values, scalar* o_values, std::size_t i_count) const
+    {
+        detail::affine_transform(i_values, o_values, i_count, scalar(0), m_scale, m_offset);
+    }
+
+    /**
+     * Transform i_count scalars matching this unit symbol string into
+     * quantities. The unit is checked once for the whole array.
+     * @throws (with DIM_EXCEPTIONS defined) If Q is not compatible with this format's unit
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    void input(scalar const* i_values, Q* o_values, std::size_t i_count) const
+    {
+        static_assert(sizeof(Q) == sizeof(scalar), "Quantities must be laid out as bare scalars");
+        if (m_unit != ::dim::index<Q>()) {
+#ifdef DIM_EXCEPTIONS
+            throw incommensurable_exception(m_unit, ::dim::index<Q>(), "Could not convert dynamic_quantity to quantity");
+#else
+            std::fill(o_values, o_values + i_count, Q::bad_quantity());
+            return;
+#endif
+        }
+        input(i_values, reinterpret_cast<scalar*>(o_values), i_count);
+    }
+
+    /**
+     * Non-dimensionalize i_count scalars in the units of System to match this
+     * format's units, like non_dim() for each one. o_values may be i_values
+     * for an in-place conversion.
+     */
+    void non_dim(scalar const* i_values, scalar* o_values, std::size_t i_count) const
+    {
+        detail::affine_divide(i_values, o_values, i_count, -m_offset, m_scale, scalar(0));
+    }
+
+    /**
+     * Non-dimensionalize i_count quantities to match this format's units. The
+     * unit is checked once for the whole array.
+     * @throws (with DIM_EXCEPTIONS defined) If Q is not compatible with this format's unit
+     */
+    template <class Q, DIM_IS_QUANTITY(Q)>
+    void non_dim(Q const* i_values, scalar* o_values, std::size_t i_count) const
+    {
+        static_assert(sizeof(Q) == sizeof(scalar), "Quantities must be laid out as bare scalars");
+        if (m_unit != ::dim::index<Q>()) {
+#ifdef DIM_EXCEPTIONS
+            throw incommensurable_exception(::dim::index<Q>(), m_unit,
+                                            "Could not nondimensionalize quantity. Dimensions are incompatible");
+#else
+            std::fill(o_values, o_values + i_count, dynamic_type::bad_quantity().value());
+            return;
+#endif
+        }
+        non_dim(reinterpret_cast<scalar const*>(i_values), o_values, i_count);
+    }
 
     /**
      * Obtain the dynamic_unit index value for this formatter.
      */
-    dynamic_unit<System> index() const { return m_scale.unit(); }
+    constexpr dynamic_unit<System> index() const { return m_unit; }
 
     /**
      * Inspect the unit symbol string.
      */ 
-    char const* symbol() const { return m_symbol; }
+    constexpr char const* symbol() const { return m_symbol; }
+
+    /**
+     * The scale of the affine transform from this symbol's units to the units of System.
+     */
+    constexpr dynamic_type scale() const { return dynamic_type(m_scale, m_unit); }
+
+    /**
+     * The additive part of the affine transform from this symbol's units to the units of System.
+     */
+    constexpr dynamic_type offset() const { return dynamic_type(m_offset, m_unit); }
 
   private:
+    /// Measure a value with unit i_unit in units of this transform
+    scalar non_dim(dynamic_unit<System> const& i_unit, scalar const& i_value) const
+    {
+        if (i_unit == m_unit) {
+            return (i_value - m_offset) / m_scale;
+        }
+#ifdef DIM_EXCEPTIONS
+        throw incommensurable_exception(i_unit, m_unit,
+                                        "Could not nondimensionalize quantity. Dimensions are incompatible");
+#else
+        return dynamic_type::bad_quantity().value();
+#endif
+    }
+
+    /// Copy up to kMaxSymbol - 1 characters of i_symbol, leaving m_symbol nul-terminated
+    DIM_CONSTEXPR14 void copy_symbol(char const* i_symbol)
+    {
+        int i = 0;
+        for (; i < kMaxSymbol - 1 && i_symbol[i]; ++i) {
+            m_symbol[i] = i_symbol[i];
+        }
+        for (; i < kMaxSymbol; ++i) {
+            m_symbol[i] = '\0';
+        }
+    }
+
     char m_symbol[kMaxSymbol];
-    dynamic_type m_scale;
-    dynamic_type m_add;
+    dynamic_unit<System> m_unit;
+    scalar m_scale;
+    scalar m_offset;
 };
 
 
@@ -230,12 +334,135 @@ std::from_chars_result parse_scalar(Scalar& o_result, char const* i_begin, char
     #if __cplusplus >= 201703L
     result = std::from_chars(i_begin, i_end, o_result);
     #else
+    result.ec = std::errc{};
     o_result = static_cast<Scalar>(std::strtold(i_begin, &result.ptr));
     #endif
     return result;
 }
 
 
+/**
+ * @brief Print i_value into [o_begin, i_end) in the shortest form that
+ * parse_scalar() reads back as the same value.
+ *
+ * This uses std::to_chars with C++17. Before C++17, it tries increasing
+ * precision with snprintf until the text round-trips. This can be specialized
+ * for particular Scalar types.
+ */
+template <class Scalar>
+std::to_chars_result format_scalar(char* o_begin, char* i_end, Scalar const& i_value)
+{
+#if __cplusplus >= 201703L
+    return std::to_chars(o_begin, i_end, i_value);
+#else
+    char buffer[64];
+    int length = 0;
+    for (int digits = std::numeric_limits<Scalar>::digits10; digits <= std::numeric_limits<Scalar>::max_digits10;
+         ++digits) {
+        length = snprintf(buffer, sizeof(buffer), "%.*Lg", digits, static_cast<long double>(i_value));
+        Scalar parsed;
+        if (parse_scalar(parsed, buffer, buffer + length).ec == std::errc{} && parsed == i_value) {
+            break;
+        }
+    }
+    std::to_chars_result result;
+    if (length > i_end - o_begin) {
+        result.ptr = i_end;
+        result.ec = std::errc::value_too_large;
+        return result;
+    }
+    memcpy(o_begin, buffer, static_cast<std::size_t>(length));
+    result.ptr = o_begin + length;
+    result.ec = std::errc{};
+    return result;
+#endif
+}
+
+/**
+ * @brief Write a formatted_quantity to [o_first, i_last) as the scalar, a '_'
+ * and the unit symbol. The text is not nul-terminated.
+ *
+ * The scalar is written in shortest round-trip form (see format_scalar()), so
+ * from_chars() reads back exactly the same value. Nothing is allocated. The
+ * '_' is left out if the symbol is empty.
+ *
+ * @return A pointer past the last character written and std::errc{}, or i_last
+ * and value_too_large if the text does not fit.
+ */
+template <class Scalar>
+std::to_chars_result to_chars(char* o_first, char* i_last, formatted_quantity<Scalar> const& i_formatted)
+{
+    std::to_chars_result result = format_scalar(o_first, i_last, i_formatted.value());
+    if (result.ec != std::errc{}) {
+        return result;
+    }
+    std::size_t length = detail::symbol_length(i_formatted.symbol());
+    if (length == 0) {
+        return result;
+    }
+    if (static_cast<std::size_t>(i_last - result.ptr) < length + 1) {
+        result.ptr = i_last;
+        result.ec = std::errc::value_too_large;
+        return result;
+    }
+    *result.ptr++ = '_';
+    memcpy(result.ptr, i_formatted.symbol(), length);
+    result.ptr += length;
+    return result;
+}
+
+/**
+ * @brief Split a region of characters into a scalar and a unit symbol without
+ * copying the symbol.
+ *
+ * This works like the formatted_quantity version of from_chars(), but on exit
+ * [o_symbol, o_symbol + o_length) is the unit symbol inside [i_start, i_end).
+ * The symbol is not nul-terminated. The error codes are the same.
+ */
+template <class Scalar>
+std::from_chars_result from_chars(char const* i_start, char const* i_end, Scalar& o_value, char const*& o_symbol,
+                                  std::size_t& o_length)
+{
+    o_symbol = i_start;
+    o_length = 0;
+    std::from_chars_result result = parse_scalar(o_value, i_start, i_end);
+    if (result.ptr == i_start) {
+        if (result.ec == std::errc{}) {
+            result.ec = std::errc::invalid_argument;
+        }
+        return result;
+    }
+    if (result.ptr < i_end && detail::isseparator(*result.ptr)) {
+        ++result.ptr;
+    }
+    char const* symbol_end = nullptr;
+    detail::unit_parse_state state;
+    char const* run_end = detail::scan_simple_symbol(result.ptr, i_end, state);
+    if (run_end) {
+        // Plain ASCII symbol, so the prescan found the end
+        symbol_end = run_end;
+    } else {
+        char const* limit = (i_end - result.ptr > kMaxSymbol ? result.ptr + kMaxSymbol : i_end);
+        detail::unit_string_scanner scanner;
+        symbol_end = result.ptr;
+        while (symbol_end < limit && scanner.accept(*symbol_end)) {
+            ++symbol_end;
+        }
+        state = scanner.state();
+    }
+    o_symbol = result.ptr;
+    o_length = static_cast<std::size_t>(symbol_end - result.ptr);
+    result.ptr += o_length;
+    if (o_length == static_cast<std::size_t>(kMaxSymbol)) {
+        result.ec = std::errc::no_buffer_space;
+    }
+    // Pack in scanner errors
+    if (state == detail::unit_parse_state::kError) {
+        result.ec = std::errc::invalid_argument;
+    }
+    return result;
+}
+
 /**
  * @brief Transform a region of characters into a formatted_quantity.
  *
@@ -263,37 +490,22 @@ template <class Scalar>
 std::from_chars_result from_chars(char const* i_start, char const* i_end, formatted_quantity<Scalar>& o_formatted)
 {
     Scalar s;
+    char const* symbol;
+    std::size_t length;
     o_formatted.symbol()[0] = '\0';
     
-    std::from_chars_result result = parse_scalar(s, i_start, i_end);
+    std::from_chars_result result = from_chars(i_start, i_end, s, symbol, length);
     if (result.ptr == i_start) {
-        if (result.ec == std::errc{}) {
-            result.ec = std::errc::invalid_argument;
-        }
         o_formatted = formatted_quantity<Scalar>::bad_format();
         return result;
     }
     o_formatted.value(s);
-    if (detail::isseparator(*result.ptr)) {
-        ++result.ptr;
-    }
-    char* cursor = o_formatted.symbol();
-    char* symbolEnd = o_formatted.symbol() + kMaxSymbol;
-    detail::unit_string_scanner scanner;
-    while (cursor < symbolEnd && result.ptr < i_end && scanner.accept(*result.ptr)) {
-        *cursor++ = *result.ptr++;
-    }
     // Ensure the string is nul terminated
-    if (cursor == symbolEnd) {
-        result.ec = std::errc::no_buffer_space;
-        o_formatted.symbol()[kMaxSymbol - 1] = '\0';
-    } else {
-        *cursor = '\0';
-    }
-    // Pack in scanner errors
-    if (scanner.state() == detail::unit_parse_state::kError) {
-        result.ec = std::errc::invalid_argument;
+    if (length >= static_cast<std::size_t>(kMaxSymbol)) {
+        length = kMaxSymbol - 1;
     }
+    memcpy(o_formatted.symbol(), symbol, length);
+    o_formatted.symbol()[length] = '\0';
     return result;
 }
 
@@ -198,6 +198,135 @@ class unit_string_scanner
     bool m_exponent_parenthesis;
 };
 
+/**
+ * @brief Find the end of a plain ASCII unit symbol without running the
+ * unit_string_scanner.
+ *
+ * Classifies up to kMaxSymbol bytes of [i_begin, i_end) at once (16 at a time
+ * with SSE2). If the symbol is a run of letters and the operators '*', '/'
+ * and '_', this returns where unit_string_scanner would have stopped and sets
+ * o_state to the scanner's final state. If the symbol contains '^', '(', ')'
+ * or non-ASCII bytes, this returns nullptr and the scanner must be used.
+ */
+char const* scan_simple_symbol(char const* i_begin, char const* i_end, unit_parse_state& o_state);
+
+/**
+ * @brief Set o_values[i] = (i_values[i] + i_shift) * i_scale + i_offset for
+ * i_count values.
+ *
+ * The float and double versions use AVX-512 or AVX2 when the processor has
+ * them (checked once, at run time), and scalar code otherwise. Every version
+ * rounds the same way. i_values and o_values may be the same array, but must
+ * not otherwise overlap.
+ */
+void affine_transform(double const* i_values, double* o_values, std::size_t i_count, double i_shift, double i_scale,
+                      double i_offset);
+void affine_transform(float const* i_values, float* o_values, std::size_t i_count, float i_shift, float i_scale,
+                      float i_offset);
+
+/// affine_transform() for other scalar types
+template <class Scalar>
+void affine_transform(Scalar const* i_values, Scalar* o_values, std::size_t i_count, Scalar i_shift, Scalar i_scale,
+                      Scalar i_offset)
+{
+    for (std::size_t i = 0; i < i_count; ++i) {
+        o_values[i] = (i_values[i] + i_shift) * i_scale + i_offset;
+    }
+}
+
+/**
+ * @brief Set o_values[i] = (i_values[i] + i_shift) / i_scale + i_offset for
+ * i_count values, with SIMD as for affine_transform().
+ *
+ * This is the inverse of affine_transform() when i_shift is minus its offset.
+ * Dividing rounds the same as one formatter::non_dim() call (a divide cannot
+ * be fused) and round-trips more values than multiplying by 1 / i_scale.
+ */
+void affine_divide(double const* i_values, double* o_values, std::size_t i_count, double i_shift, double i_scale,
+                   double i_offset);
+void affine_divide(float const* i_values, float* o_values, std::size_t i_count, float i_shift, float i_scale,
+                   float i_offset);
+
+/// affine_divide() for other scalar types
+template <class Scalar>
+void affine_divide(Scalar const* i_values, Scalar* o_values, std::size_t i_count, Scalar i_shift, Scalar i_scale,
+                   Scalar i_offset)
+{
+    for (std::size_t i = 0; i < i_count; ++i) {
+        o_values[i] = (i_values[i] + i_shift) / i_scale + i_offset;
+    }
+}
+
+/// affine_transform() without SIMD, for comparison
+void affine_transform_scalar(double const* i_values, double* o_values, std::size_t i_count, double i_shift,
+                             double i_scale, double i_offset);
+void affine_transform_scalar(float const* i_values, float* o_values, std::size_t i_count, float i_shift,
+                             float i_scale, float i_offset);
+
+/// Name of the instruction set affine_transform() uses: "avx512f", "avx2" or "scalar"
+char const* affine_transform_isa();
+
+/// Default basis for symbol_hash()
+constexpr uint32_t kSymbolHashBasis = 2166136261u;
+
+/**
+ * FNV-1a hash of the symbol bytes [i_begin, i_end). Used to key symbol caches
+ * and indexes. Different values of i_basis give independent hash functions.
+ */
+DIM_CONSTEXPR14 inline uint32_t symbol_hash(char const* i_begin, char const* i_end, uint32_t i_basis = kSymbolHashBasis)
+{
+    uint32_t hash = i_basis;
+    for (; i_begin < i_end; ++i_begin) {
+        hash = (hash ^ static_cast<uint8_t>(*i_begin)) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * FNV-1a hash of a nul-terminated symbol, reading at most kMaxSymbol
+ * characters (matching strncmp(..., kMaxSymbol)).
+ */
+DIM_CONSTEXPR14 inline uint32_t symbol_hash(char const* i_symbol, uint32_t i_basis = kSymbolHashBasis)
+{
+    uint32_t hash = i_basis;
+    for (int i = 0; i < kMaxSymbol && i_symbol[i]; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(i_symbol[i])) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Length of a nul-terminated symbol, reading at most kMaxSymbol characters.
+ */
+DIM_CONSTEXPR14 inline std::size_t symbol_length(char const* i_symbol)
+{
+    std::size_t length = 0;
+    while (length < static_cast<std::size_t>(kMaxSymbol) && i_symbol[length]) {
+        ++length;
+    }
+    return length;
+}
+
+/**
+ * Compare the nul-terminated i_symbol with the symbol [i_query, i_query +
+ * i_length). The ordering matches strncmp(i_symbol, query, kMaxSymbol) on a
+ * nul-terminated copy of the query.
+ */
+inline int compare_symbol(char const* i_symbol, char const* i_query, std::size_t i_length)
+{
+    for (std::size_t i = 0; i < i_length && i < static_cast<std::size_t>(kMaxSymbol); ++i) {
+        unsigned char left = static_cast<unsigned char>(i_symbol[i]);
+        unsigned char right = static_cast<unsigned char>(i_query[i]);
+        if (left != right) {
+            return (left < right ? -1 : 1);
+        }
+        if (!left) {
+            return 0;
+        }
+    }
+    return (i_length < static_cast<std::size_t>(kMaxSymbol) && i_symbol[i_length] ? 1 : 0);
+}
+
 /**
  * Is c a separator between a scalar and a unit string?
  * Valid values are '*', '_', and ' '.
@@ -240,7 +369,7 @@ std::string incommensurable_exception::print_error(dynamic_unit<S1> const& u1, d
 } // namespace dim
 #endif
 
-// For compatibility, replicate from_chars_result for
+// For compatibility, replicate from_chars_result and to_chars_result for
 // C++ < 17
 #if __cplusplus < 201703L
 #include <system_error>
@@ -250,5 +379,10 @@ struct from_chars_result {
     char* ptr;
     errc ec;
 };
+
+struct to_chars_result {
+    char* ptr;
+    errc ec;
+};
 } // namespace std
 #endif
\ No newline at end of file
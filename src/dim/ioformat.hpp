@@ -1,5 +1,6 @@
 #pragma once
 #include "DimConfig.hpp"
+#include "codec.hpp"
 #include "format_map.hpp"
 #include "io.hpp"
 #include <locale>
@@ -8,8 +9,47 @@
 #include "dim/incommensurable_exception.hpp"
 #endif
 
+namespace dim
+{
+
+/**
+ * Write a quantity to [o_first, i_last) using the facet, without allocating.
+ *
+ * The text is the scalar in shortest round-trip form, a '_' and the unit
+ * symbol, so from_chars() and from_string() read back exactly the same
+ * quantity. The text is not nul-terminated.
+ *
+ * @return A pointer past the last character written and std::errc{}, or
+ * i_last and value_too_large if the text does not fit.
+ *
+ * @note This finds the facet in the global locale on every call. In a hot loop,
+ * make a quantity_codec once and use its to_chars().
+ */
+template <class Q, DIM_IS_QUANTITY(Q)>
+std::to_chars_result to_chars(char* o_first, char* i_last, Q const& i_quantity)
+{
+    quantity_codec<typename Q::scalar, typename Q::system> const codec{std::locale()}; // Get the global locale
+    return codec.to_chars(o_first, i_last, i_quantity);
+}
+
+/**
+ * Write a dynamic_quantity to [o_first, i_last) using the facet, without
+ * allocating. See the quantity version.
+ */
+template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
+std::to_chars_result to_chars(char* o_first, char* i_last, DQ const& i_quantity)
+{
+    quantity_codec<typename DQ::scalar, typename DQ::system> const codec{std::locale()}; // Get the global locale
+    return codec.to_chars(o_first, i_last, i_quantity);
+}
+
+} // namespace dim
+
 #ifdef DIM_STRING
 #include <string>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 
 namespace dim
 {
@@ -27,14 +67,8 @@ namespace dim
 template <class Q, DIM_IS_QUANTITY(Q)>
 std::string to_string(Q const& i_quantity)
 {
-    using facet = typename Q::system::facet;
-    std::locale loc; // Get the global locale
-    dim::formatted_quantity<typename Q::scalar> formatted;
-    if (std::has_facet<facet>(loc)) {
-        formatted = std::use_facet<facet>(loc).format(i_quantity);
-    } else {
-        format_quantity(formatted, i_quantity);
-    }
+    quantity_codec<typename Q::scalar, typename Q::system> const codec{std::locale()}; // Get the global locale
+    dim::formatted_quantity<typename Q::scalar> formatted = codec.format(i_quantity);
     return std::to_string(formatted.value()) + '_' + formatted.symbol();
 }
 
@@ -46,14 +80,8 @@ std::string to_string(Q const& i_quantity)
 template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
 std::string to_string(DQ const& i_quantity)
 {
-    using facet = typename DQ::system::facet;
-    std::locale loc; // Get the global locale
-    dim::formatted_quantity<typename DQ::scalar> formatted;
-    if (std::has_facet<facet>(loc)) {
-        formatted = std::use_facet<facet>(loc).format(i_quantity);
-    } else {
-        format_quantity(formatted, i_quantity);
-    }
+    quantity_codec<typename DQ::scalar, typename DQ::system> const codec{std::locale()}; // Get the global locale
+    dim::formatted_quantity<typename DQ::scalar> formatted = codec.format(i_quantity);
     return std::to_string(formatted.value()) + '_' + formatted.symbol();
 }
 
@@ -62,41 +90,20 @@ std::string to_string(DQ const& i_quantity)
  * represent a quantity of type Q, set o_quantity to a bad_quantity() and return
  * false.
  *
+ * The text is read in place, so [i_text, i_text + i_length) can be a field of
+ * a larger buffer. Nothing is copied and no terminator is needed.
+ *
  * @param[out] o_quantity On exit, the deserialized quantity
- * @param[in] i_string String containing the serialized scalar and unit symbol
+ * @param[in] i_text Text containing the serialized scalar and unit symbol
  * string.
+ * @param[in] i_length Length of i_text
  * @return True if parsing was successful.
  */
 template <class Q, DIM_IS_QUANTITY(Q)>
-bool from_string(Q& o_quantity, std::string const& i_string)
+bool from_string(Q& o_quantity, char const* i_text, std::size_t i_length)
 {
-    using facet = typename Q::system::facet;
-    using scalar = typename Q::scalar;
-    formatted_quantity<scalar> formatted;
-    auto result = from_chars(i_string.data(), i_string.data() + i_string.size(), formatted);
-    if (result.ec != std::errc{}) {
-        o_quantity = Q::bad_quantity();
-        return false;
-    }
-    std::locale loc; // Get the global locale
-#ifdef DIM_EXCEPTIONS
-    try {
-        if (std::has_facet<facet>(loc)) {
-            o_quantity = std::use_facet<facet>(loc).template format<Q>(formatted);
-            return true;
-        }
-        return parse_quantity<Q>(o_quantity, formatted);
-    } catch (incommensurable_exception const& e) {
-        o_quantity = Q::bad_quantity();
-        return false;
-    }
-#else
-    if (std::has_facet<facet>(loc)) {
-        o_quantity = std::use_facet<facet>(loc).template format<Q>(formatted);
-        return o_quantity.is_bad() ? false : true;
-    }
-    return parse_quantity<Q>(o_quantity, formatted);
-#endif
+    quantity_codec<typename Q::scalar, typename Q::system> const codec{std::locale()}; // Get the global locale
+    return codec.parse(o_quantity, i_text, i_length);
 }
 
 /**
@@ -104,42 +111,53 @@ bool from_string(Q& o_quantity, std::string const& i_string)
  * represent a dynamic_quantity of any known type, set o_quantity to a
  * bad_quantity() and return false.
  *
+ * The text is read in place, so [i_text, i_text + i_length) can be a field of
+ * a larger buffer. Nothing is copied and no terminator is needed.
+ *
  * @param[out] o_quantity On exit, the deserialized dynamic_quantity
- * @param[in] i_string String containing the serialized scalar and unit symbol
+ * @param[in] i_text Text containing the serialized scalar and unit symbol
  * string.
+ * @param[in] i_length Length of i_text
  * @return True if parsing was successful.
  */
 template <class DQ, DIM_IS_DYNAMIC_QUANTITY(DQ)>
-bool from_string(DQ& o_quantity, std::string const& i_string)
+bool from_string(DQ& o_quantity, char const* i_text, std::size_t i_length)
 {
-    using facet = typename DQ::system::facet;
-    using scalar = typename DQ::scalar;
-    formatted_quantity<scalar> formatted;
-    auto result = from_chars(i_string.data(), i_string.data() + i_string.size(), formatted);
-    if (result.ec != std::errc{}) {
-        o_quantity = DQ::bad_quantity();
-        return false;
-    }
-    std::locale loc; // Get the global locale
-#ifdef DIM_EXCEPTIONS
-    try {
-        if (std::has_facet<facet>(loc)) {
-            o_quantity = std::use_facet<facet>(loc).format(formatted);
-            return true;
-        }
-        return parse_quantity(o_quantity, formatted);
-    } catch (incommensurable_exception const& e) {
-        o_quantity = DQ::bad_quantity();
-        return false;
-    }
-#else
-    if (std::has_facet<facet>(loc)) {
-        o_quantity = std::use_facet<facet>(loc).format(formatted);
-        return o_quantity.is_bad() ? false : true;
-    }
-    return parse_quantity(o_quantity, formatted);
-#endif
+    quantity_codec<typename DQ::scalar, typename DQ::system> const codec{std::locale()}; // Get the global locale
+    return codec.parse(o_quantity, i_text, i_length);
+}
+
+/**
+ * Parse a string representation using the facet. See the (pointer, length)
+ * version.
+ */
+template <class Q>
+bool from_string(Q& o_quantity, std::string const& i_string)
+{
+    return from_string(o_quantity, i_string.data(), i_string.size());
+}
+
+/**
+ * Parse a nul-terminated string representation using the facet. See the
+ * (pointer, length) version.
+ */
+template <class Q>
+bool from_string(Q& o_quantity, char const* i_string)
+{
+    return from_string(o_quantity, i_string, strlen(i_string));
+}
+
+#if __cplusplus >= 201703L
+/**
+ * Parse a string representation using the facet. See the (pointer, length)
+ * version.
+ */
+template <class Q>
+bool from_string(Q& o_quantity, std::string_view i_string)
+{
+    return from_string(o_quantity, i_string.data(), i_string.size());
 }
+#endif
 
 } // namespace dim
 #endif
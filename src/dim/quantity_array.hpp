@@ -0,0 +1,904 @@
+#pragma once
+#include "quantity.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef DIM_EXCEPTIONS
+#include <stdexcept>
+#endif
+
+/**
+ * Contiguous arrays of quantities with lazy elementwise arithmetic.
+ *
+ * quantity_array owns its values and quantity_span views values owned by
+ * something else (a std::vector, a quantity_array, a buffer from a file).
+ * Both store bare scalars (a quantity is exactly one scalar), so scalars()
+ * can be passed straight to BLAS or SIMD code.
+ *
+ * The arithmetic operators work on any mix of arrays, spans, quantities and
+ * scalars. They do not compute anything: each returns an array_expression
+ * recording the operation, with the units of the result resolved at compile
+ * time just as for single quantities. The whole expression is evaluated in
+ * one loop when it is assigned to an array (or reduced), so
+ * ```
+ * si::quantity_array<si::Force> force = mass * acceleration + drag * speed * speed;
+ * ```
+ * reads each input once, writes the result once and makes no temporary
+ * arrays. Expressions hold pointers to their arrays, so assign them before
+ * the arrays go away (beware `auto`).
+ *
+ * The loops are plain, branch-free loops over the scalars in fixed-size
+ * blocks, which the compiler vectorizes at -O2 (GCC 12 and later, Clang) or
+ * -O3. Reductions keep several partial results so that they vectorize
+ * without -ffast-math. Evaluation can be split across threads by passing a
+ * parallel_policy.
+ */
+
+namespace dim
+{
+
+namespace detail
+{
+
+/// Block size of the array loops and partial results kept by reductions (one AVX-512 register of floats)
+constexpr std::size_t kArrayLanes = 16;
+
+} // namespace detail
+
+/**
+ * @brief Evaluate array expressions on the calling thread (the default).
+ */
+struct sequential_policy {
+    /// Number of parts run() splits i_count values into
+    std::size_t parts(std::size_t) const { return 1; }
+
+    /// Call i_function(part, first, last) for each part of [0, i_count)
+    template <class Function>
+    void run(std::size_t i_count, Function const& i_function) const
+    {
+        i_function(std::size_t(0), std::size_t(0), i_count);
+    }
+};
+
+/**
+ * @brief Evaluate array expressions on several threads.
+ *
+ * The values are split into one part per thread, but never into parts of
+ * fewer than grain() values, since starting a thread costs about as much as
+ * converting tens of thousands of values. The calling thread evaluates the
+ * first part. Results do not depend on the number of threads, except for
+ * rounding in sum() and dot(), which add the parts in order.
+ *
+ * ```
+ * force.assign(mass * acceleration, dim::parallel_policy());
+ * ```
+ */
+class parallel_policy
+{
+  public:
+    /**
+     * @param i_threads Most threads to use, or 0 for
+     * std::thread::hardware_concurrency()
+     * @param i_grain Fewest values per thread
+     */
+    explicit parallel_policy(unsigned i_threads = 0, std::size_t i_grain = std::size_t(1) << 16)
+        : m_threads(i_threads ? i_threads : std::thread::hardware_concurrency()),
+          m_grain(i_grain ? i_grain : 1)
+    {
+        if (m_threads == 0) {
+            m_threads = 1;
+        }
+    }
+
+    unsigned threads() const { return m_threads; }
+    std::size_t grain() const { return m_grain; }
+
+    /// Number of parts run() splits i_count values into
+    std::size_t parts(std::size_t i_count) const
+    {
+        std::size_t size = part_size(i_count);
+        return i_count > size ? (i_count + size - 1) / size : 1;
+    }
+
+    /**
+     * @brief Call i_function(part, first, last) for each part of [0, i_count),
+     * each part on its own thread. If a thread cannot be started, the
+     * std::system_error is thrown once the threads already started have finished.
+     */
+    template <class Function>
+    void run(std::size_t i_count, Function const& i_function) const
+    {
+        std::size_t size = part_size(i_count);
+        if (size >= i_count) {
+            i_function(std::size_t(0), std::size_t(0), i_count);
+            return;
+        }
+        workers started;
+        started.threads.reserve(parts(i_count) - 1);
+        std::size_t part = 1;
+        for (std::size_t first = size; first < i_count; first += size, ++part) {
+            std::size_t last = std::min(i_count, first + size);
+            started.threads.emplace_back([&i_function, part, first, last] { i_function(part, first, last); });
+        }
+        i_function(std::size_t(0), std::size_t(0), size);
+    }
+
+  private:
+    /// Threads joined on destruction, so none is left running (and joinable) if run() exits by an exception
+    struct workers {
+        std::vector<std::thread> threads;
+
+        workers() = default;
+        workers(workers const&) = delete;
+        workers& operator=(workers const&) = delete;
+        ~workers()
+        {
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+        }
+    };
+
+    /// Values per part, a whole number of blocks so that only the last part has a tail
+    std::size_t part_size(std::size_t i_count) const
+    {
+        std::size_t parts = std::min<std::size_t>(m_threads, i_count / m_grain);
+        if (parts <= 1) {
+            return i_count;
+        }
+        std::size_t size = (i_count + parts - 1) / parts;
+        return (size + detail::kArrayLanes - 1) / detail::kArrayLanes * detail::kArrayLanes;
+    }
+
+    unsigned m_threads;
+    std::size_t m_grain;
+};
+
+namespace detail
+{
+
+/// Size of a broadcast operand, which matches any size
+constexpr std::size_t kBroadcastSize = static_cast<std::size_t>(-1);
+
+/**
+ * @brief Call i_body(i) for each i in [i_first, i_last). The inner loop has
+ * a fixed count so that GCC vectorizes it at -O2, where it skips loops that
+ * need a scalar epilogue.
+ */
+template <class Body>
+void array_loop(std::size_t i_first, std::size_t i_last, Body const& i_body)
+{
+    std::size_t i = i_first;
+    for (; i + kArrayLanes <= i_last; i += kArrayLanes) {
+        for (std::size_t j = 0; j < kArrayLanes; ++j) {
+            i_body(i + j);
+        }
+    }
+    for (; i < i_last; ++i) {
+        i_body(i);
+    }
+}
+
+/**
+ * @brief True if two arrays have the same size. Otherwise throws
+ * std::length_error if DIM_EXCEPTIONS is set, or returns false.
+ */
+inline bool array_sizes_match(std::size_t i_left, std::size_t i_right)
+{
+    if (i_left == i_right) {
+        return true;
+    }
+#ifdef DIM_EXCEPTIONS
+    throw std::length_error("quantity arrays have different sizes");
+#else
+    return false;
+#endif
+}
+
+/// Expression operand reading the scalars of an array or span
+template <class Scalar>
+class array_leaf
+{
+  public:
+    using scalar = Scalar;
+
+    array_leaf(Scalar const* i_values, std::size_t i_size)
+        : m_values(i_values),
+          m_size(i_size)
+    {
+    }
+
+    std::size_t size() const { return m_size; }
+    bool valid() const { return true; }
+    Scalar scalar_at(std::size_t i_index) const { return m_values[i_index]; }
+    bool overlaps(Scalar const* i_first, Scalar const* i_last) const
+    {
+        return m_values < i_last && i_first < m_values + m_size;
+    }
+    bool overlaps_shifted(Scalar const* i_first, Scalar const* i_last) const
+    {
+        return m_values != i_first && overlaps(i_first, i_last);
+    }
+
+  private:
+    Scalar const* m_values;
+    std::size_t m_size;
+};
+
+/// Expression operand repeating one scalar (from a quantity or scalar)
+template <class Scalar>
+class broadcast_leaf
+{
+  public:
+    using scalar = Scalar;
+
+    explicit broadcast_leaf(Scalar i_value)
+        : m_value(i_value)
+    {
+    }
+
+    std::size_t size() const { return kBroadcastSize; }
+    bool valid() const { return true; }
+    Scalar scalar_at(std::size_t) const { return m_value; }
+    bool overlaps(Scalar const*, Scalar const*) const { return false; }
+    bool overlaps_shifted(Scalar const*, Scalar const*) const { return false; }
+
+  private:
+    Scalar m_value;
+};
+
+} // namespace detail
+
+/**
+ * @brief A deferred elementwise operation on arrays, giving quantities of
+ * type Q. Made by the arithmetic operators on quantity_array and
+ * quantity_span; assign it to an array to evaluate it.
+ *
+ * If the arrays in the expression differ in size, making the expression
+ * throws std::length_error when DIM_EXCEPTIONS is set. Otherwise the
+ * expression is not valid() and evaluates to bad quantities.
+ */
+template <class Q, class Left, class Right, class Op>
+class array_expression : public quantity_array_tag
+{
+  public:
+    using value_type = Q;
+    using scalar = typename Q::scalar;
+    using unit = typename Q::unit;
+
+    static_assert(std::is_same<typename Left::scalar, typename Right::scalar>::value, "Scalar types do not match.");
+
+    array_expression(Left const& i_left, Right const& i_right)
+        : m_left(i_left),
+          m_right(i_right),
+          m_size(i_left.size() == detail::kBroadcastSize ? i_right.size() : i_left.size()),
+          m_valid(i_left.valid() && i_right.valid() &&
+                  (i_left.size() == detail::kBroadcastSize || i_right.size() == detail::kBroadcastSize ||
+                   detail::array_sizes_match(i_left.size(), i_right.size())))
+    {
+    }
+
+    std::size_t size() const { return m_size; }
+
+    /// False if the arrays in the expression differ in size
+    bool valid() const { return m_valid; }
+
+    /// Scalar value of element i_index
+    scalar scalar_at(std::size_t i_index) const { return Op()(m_left.scalar_at(i_index), m_right.scalar_at(i_index)); }
+
+    /// Evaluate one element
+    value_type operator[](std::size_t i_index) const { return value_type(scalar_at(i_index)); }
+
+    /// True if the expression reads any of the scalars [i_first, i_last)
+    bool overlaps(scalar const* i_first, scalar const* i_last) const
+    {
+        return m_left.overlaps(i_first, i_last) || m_right.overlaps(i_first, i_last);
+    }
+
+    /// True if the expression reads any of the scalars [i_first, i_last) other than at the index it evaluates
+    bool overlaps_shifted(scalar const* i_first, scalar const* i_last) const
+    {
+        return m_left.overlaps_shifted(i_first, i_last) || m_right.overlaps_shifted(i_first, i_last);
+    }
+
+  private:
+    Left m_left;
+    Right m_right;
+    std::size_t m_size;
+    bool m_valid;
+};
+
+namespace detail
+{
+
+/// True for array_expression types
+template <class T>
+struct is_array_expression : std::false_type {
+};
+template <class Q, class Left, class Right, class Op>
+struct is_array_expression<array_expression<Q, Left, Right, Op>> : std::true_type {
+};
+
+/// Operand for an array or span
+template <class A>
+array_leaf<typename A::scalar> make_operand(A const& i_values, decltype(i_values.scalars())* = nullptr)
+{
+    return array_leaf<typename A::scalar>(i_values.scalars(), i_values.size());
+}
+
+/// Operand for a nested expression
+template <class Q, class Left, class Right, class Op>
+array_expression<Q, Left, Right, Op> make_operand(array_expression<Q, Left, Right, Op> const& i_expression)
+{
+    return i_expression;
+}
+
+/// Operand for a quantity, repeated for every element
+template <class Q, DIM_IS_QUANTITY(Q)>
+broadcast_leaf<typename Q::scalar> make_operand(Q const& i_quantity)
+{
+    return broadcast_leaf<typename Q::scalar>(dimensionless_cast(i_quantity));
+}
+
+/// Operand for a scalar, repeated for every element
+template <class S, DIM_IS_SCALAR(S)>
+broadcast_leaf<S> make_operand(S const& i_value)
+{
+    return broadcast_leaf<S>(i_value);
+}
+
+/// Expression operand type for T
+template <class T>
+using operand_t = decltype(make_operand(std::declval<T const&>()));
+
+/// Quantity type of A times B, where each is a quantity or an array
+template <class A, class B>
+using product_t = quantity<unit_multiply_t<typename A::unit, typename B::unit>, typename A::scalar>;
+
+/// Quantity type of A divided by B, where each is a quantity or an array
+template <class A, class B>
+using quotient_t = quantity<unit_divide_t<typename A::unit, typename B::unit>, typename A::scalar>;
+
+/// Quantity type of the elements of array A
+template <class A>
+using element_t = typename A::value_type;
+
+/// Expression applying Op to A and B, giving quantities of type Q
+template <class Q, template <class> class Op, class A, class B>
+using expression_t = array_expression<Q, operand_t<A>, operand_t<B>, Op<typename Q::scalar>>;
+
+/// Make the expression applying Op to i_left and i_right
+template <class Q, template <class> class Op, class A, class B>
+expression_t<Q, Op, A, B> make_expression(A const& i_left, B const& i_right)
+{
+    return expression_t<Q, Op, A, B>(make_operand(i_left), make_operand(i_right));
+}
+
+/// Store elements [i_first, i_last) of i_values to o_values, which i_values does not read
+template <class E>
+void array_store(E const& i_values, typename E::scalar* DIM_RESTRICT o_values, std::size_t i_first,
+                 std::size_t i_last)
+{
+    E const values = i_values;
+    array_loop(i_first, i_last, [=](std::size_t i) { o_values[i] = values.scalar_at(i); });
+}
+
+/// Store elements [i_first, i_last) of i_values to o_values, which i_values may read (at the same index)
+template <class E>
+void array_store_overlapping(E const& i_values, typename E::scalar* o_values, std::size_t i_first,
+                             std::size_t i_last)
+{
+    E const values = i_values;
+    array_loop(i_first, i_last, [=](std::size_t i) { o_values[i] = values.scalar_at(i); });
+}
+
+/**
+ * @brief Evaluate i_values into o_values, which has room for i_values.size()
+ * scalars. If i_values reads o_values at other indices (say a span assigned
+ * from itself shifted by one), it is evaluated into a temporary first, as
+ * storing in place would overwrite values before they are read.
+ */
+template <class E, class Policy>
+void array_evaluate(E const& i_values, typename E::scalar* o_values, Policy const& i_policy)
+{
+    using scalar = typename E::scalar;
+    std::size_t size = i_values.size();
+    if (!i_values.valid()) {
+        std::fill(o_values, o_values + size, static_cast<scalar>(bad_double__()));
+        return;
+    }
+    bool overlapping = i_values.overlaps(o_values, o_values + size);
+    if (overlapping && i_values.overlaps_shifted(o_values, o_values + size)) {
+        std::vector<scalar> values(size);
+        array_evaluate(i_values, values.data(), i_policy);
+        std::copy(values.begin(), values.end(), o_values);
+        return;
+    }
+    i_policy.run(size, [&](std::size_t, std::size_t i_first, std::size_t i_last) {
+        if (overlapping) {
+            array_store_overlapping(i_values, o_values, i_first, i_last);
+        } else {
+            array_store(i_values, o_values, i_first, i_last);
+        }
+    });
+}
+
+/// Sum of elements [i_first, i_last)
+template <class E>
+typename E::scalar array_sum(E const& i_values, std::size_t i_first, std::size_t i_last)
+{
+    using scalar = typename E::scalar;
+    scalar lanes[kArrayLanes] = {};
+    std::size_t i = i_first;
+    for (; i + kArrayLanes <= i_last; i += kArrayLanes) {
+        for (std::size_t j = 0; j < kArrayLanes; ++j) {
+            lanes[j] += i_values.scalar_at(i + j);
+        }
+    }
+    for (std::size_t j = 0; i < i_last; ++i, ++j) {
+        lanes[j] += i_values.scalar_at(i);
+    }
+    for (std::size_t width = kArrayLanes / 2; width > 0; width /= 2) {
+        for (std::size_t j = 0; j < width; ++j) {
+            lanes[j] += lanes[j + width];
+        }
+    }
+    return lanes[0];
+}
+
+/// Smallest (i_sign = 1) or largest (i_sign = -1) value, skipping NaN; o_found is false if all values are NaN
+template <class E>
+typename E::scalar array_extreme(E const& i_values, typename E::scalar i_sign, bool& o_found)
+{
+    using scalar = typename E::scalar;
+    scalar lanes[kArrayLanes];
+    bool found[kArrayLanes];
+    for (std::size_t j = 0; j < kArrayLanes; ++j) {
+        lanes[j] = std::numeric_limits<scalar>::infinity();
+        found[j] = false;
+    }
+    std::size_t i = 0;
+    std::size_t count = i_values.size();
+    for (; i + kArrayLanes <= count; i += kArrayLanes) {
+        for (std::size_t j = 0; j < kArrayLanes; ++j) {
+            scalar value = i_values.scalar_at(i + j) * i_sign;
+            lanes[j] = value < lanes[j] ? value : lanes[j];
+            found[j] = found[j] | (value == value);
+        }
+    }
+    for (std::size_t j = 0; i < count; ++i, ++j) {
+        scalar value = i_values.scalar_at(i) * i_sign;
+        lanes[j] = value < lanes[j] ? value : lanes[j];
+        found[j] = found[j] | (value == value);
+    }
+    for (std::size_t width = kArrayLanes / 2; width > 0; width /= 2) {
+        for (std::size_t j = 0; j < width; ++j) {
+            lanes[j] = lanes[j + width] < lanes[j] ? lanes[j + width] : lanes[j];
+            found[j] = found[j] | found[j + width];
+        }
+    }
+    o_found = found[0];
+    return lanes[0] * i_sign;
+}
+
+} // namespace detail
+
+/**
+ * @brief A view of a contiguous run of quantities.
+ *
+ * Q may be const for a read-only view. A span can be made from anything with
+ * data() and size() (std::vector, std::array, quantity_array, another span),
+ * and does not own the values.
+ */
+template <class Q>
+class quantity_span : public quantity_array_tag
+{
+  public:
+    using element_type = Q;
+    using value_type = typename std::remove_const<Q>::type;
+    using scalar = typename value_type::scalar;
+    using unit = typename value_type::unit;
+    using scalar_pointer = typename std::conditional<std::is_const<Q>::value, scalar const*, scalar*>::type;
+    using iterator = Q*;
+
+    static_assert(sizeof(value_type) == sizeof(scalar) && std::is_standard_layout<value_type>::value,
+                  "quantity_span requires quantities laid out as bare scalars");
+
+    /// An empty span
+    constexpr quantity_span() noexcept
+        : m_data(nullptr),
+          m_size(0)
+    {
+    }
+
+    /// A span of i_size quantities starting at i_data
+    constexpr quantity_span(Q* i_data, std::size_t i_size) noexcept
+        : m_data(i_data),
+          m_size(i_size)
+    {
+    }
+
+    /// A span of the values of a container with data() and size()
+    template <class Container,
+              typename std::enable_if_t<
+                  std::is_convertible<decltype(std::declval<Container&>().data()), Q*>::value>* = nullptr>
+    constexpr quantity_span(Container& i_values) noexcept
+        : m_data(i_values.data()),
+          m_size(i_values.size())
+    {
+    }
+
+    constexpr Q* data() const noexcept { return m_data; }
+
+    /// The values as bare scalars, e.g. for BLAS or SIMD code
+    scalar_pointer scalars() const noexcept { return reinterpret_cast<scalar_pointer>(m_data); }
+
+    constexpr std::size_t size() const noexcept { return m_size; }
+    constexpr bool empty() const noexcept { return m_size == 0; }
+    constexpr iterator begin() const noexcept { return m_data; }
+    constexpr iterator end() const noexcept { return m_data + m_size; }
+    constexpr Q& operator[](std::size_t i_index) const { return m_data[i_index]; }
+
+    /// The i_count values starting at i_offset
+    constexpr quantity_span subspan(std::size_t i_offset, std::size_t i_count) const
+    {
+        return quantity_span(m_data + i_offset, i_count);
+    }
+
+    /**
+     * @brief Overwrite the viewed values with those of an expression, array
+     * or span of the same size, which may overlap this span. If the sizes
+     * differ, the values become bad quantities (or std::length_error is
+     * thrown if DIM_EXCEPTIONS is set).
+     */
+    template <class A, class Policy = sequential_policy, DIM_IS_QUANTITY_ARRAY(A)>
+    quantity_span const& assign(A const& i_values, Policy const& i_policy = Policy()) const
+    {
+        static_assert(!std::is_const<Q>::value, "Cannot assign through a read-only span.");
+        DIM_CHECK_DIMENSIONS(unit, A::unit)
+        DIM_CHECK_SYSTEMS(unit, A::unit)
+        if (!detail::array_sizes_match(m_size, i_values.size())) {
+            std::fill(begin(), end(), value_type::bad_quantity());
+            return *this;
+        }
+        detail::array_evaluate(detail::make_operand(i_values), scalars(), i_policy);
+        return *this;
+    }
+
+  private:
+    Q* m_data;
+    std::size_t m_size;
+};
+
+/**
+ * @brief A contiguous, owning array of quantities.
+ */
+template <class Q>
+class quantity_array : public quantity_array_tag
+{
+  public:
+    using element_type = Q;
+    using value_type = Q;
+    using scalar = typename Q::scalar;
+    using unit = typename Q::unit;
+    using iterator = Q*;
+    using const_iterator = Q const*;
+
+    static_assert(sizeof(Q) == sizeof(scalar) && std::is_standard_layout<Q>::value,
+                  "quantity_array requires quantities laid out as bare scalars");
+
+    /// An empty array
+    quantity_array() {}
+
+    /// An array of i_size uninitialized quantities
+    explicit quantity_array(std::size_t i_size)
+        : m_values(i_size)
+    {
+    }
+
+    /// An array of i_size copies of i_value
+    quantity_array(std::size_t i_size, Q const& i_value)
+        : m_values(i_size, i_value)
+    {
+    }
+
+    quantity_array(std::initializer_list<Q> i_values)
+        : m_values(i_values)
+    {
+    }
+
+    /// Copy the values of another array or span with the same dimensions
+    template <class A, DIM_IS_QUANTITY_ARRAY(A),
+              typename std::enable_if_t<!detail::is_array_expression<A>::value>* = nullptr>
+    explicit quantity_array(A const& i_values)
+        : m_values(i_values.begin(), i_values.end())
+    {
+        DIM_CHECK_DIMENSIONS(unit, A::unit)
+        DIM_CHECK_SYSTEMS(unit, A::unit)
+    }
+
+    /// Evaluate an expression
+    template <class Q2, class Left, class Right, class Op, class Policy = sequential_policy>
+    quantity_array(array_expression<Q2, Left, Right, Op> const& i_expression, Policy const& i_policy = Policy())
+    {
+        assign(i_expression, i_policy);
+    }
+
+    /// Evaluate an expression, replacing the values
+    template <class Q2, class Left, class Right, class Op>
+    quantity_array& operator=(array_expression<Q2, Left, Right, Op> const& i_expression)
+    {
+        return assign(i_expression);
+    }
+
+    /**
+     * @brief Replace the values with those of an expression, array or span,
+     * resizing to match.
+     */
+    template <class A, class Policy = sequential_policy, DIM_IS_QUANTITY_ARRAY(A)>
+    quantity_array& assign(A const& i_values, Policy const& i_policy = Policy())
+    {
+        DIM_CHECK_DIMENSIONS(unit, A::unit)
+        DIM_CHECK_SYSTEMS(unit, A::unit)
+        // An expression can only read this array if the sizes already match, so this never moves values it reads
+        m_values.resize(i_values.size());
+        detail::array_evaluate(detail::make_operand(i_values), scalars(), i_policy);
+        return *this;
+    }
+
+    Q* data() noexcept { return m_values.data(); }
+    Q const* data() const noexcept { return m_values.data(); }
+
+    /// The values as bare scalars, e.g. for BLAS or SIMD code
+    scalar* scalars() noexcept { return reinterpret_cast<scalar*>(m_values.data()); }
+    scalar const* scalars() const noexcept { return reinterpret_cast<scalar const*>(m_values.data()); }
+
+    std::size_t size() const noexcept { return m_values.size(); }
+    bool empty() const noexcept { return m_values.empty(); }
+    iterator begin() noexcept { return data(); }
+    iterator end() noexcept { return data() + size(); }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end() const noexcept { return data() + size(); }
+    Q& operator[](std::size_t i_index) { return m_values[i_index]; }
+    Q const& operator[](std::size_t i_index) const { return m_values[i_index]; }
+
+    /// Change the size, keeping the first values
+    void resize(std::size_t i_size) { m_values.resize(i_size); }
+
+  private:
+    std::vector<Q> m_values;
+};
+
+// Array-array operators. A and B may each be an array, span or expression.
+
+template <class A, class B, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY_ARRAY(B)>
+detail::expression_t<detail::element_t<A>, std::plus, A, B> operator+(A const& i_left, B const& i_right)
+{
+    DIM_CHECK_DIMENSIONS(A::unit, B::unit)
+    DIM_CHECK_SYSTEMS(A::unit, B::unit)
+    return detail::make_expression<detail::element_t<A>, std::plus>(i_left, i_right);
+}
+
+template <class A, class B, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY_ARRAY(B)>
+detail::expression_t<detail::element_t<A>, std::minus, A, B> operator-(A const& i_left, B const& i_right)
+{
+    DIM_CHECK_DIMENSIONS(A::unit, B::unit)
+    DIM_CHECK_SYSTEMS(A::unit, B::unit)
+    return detail::make_expression<detail::element_t<A>, std::minus>(i_left, i_right);
+}
+
+template <class A, class B, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY_ARRAY(B)>
+detail::expression_t<detail::product_t<A, B>, std::multiplies, A, B> operator*(A const& i_left, B const& i_right)
+{
+    DIM_CHECK_SYSTEMS(A::unit, B::unit)
+    return detail::make_expression<detail::product_t<A, B>, std::multiplies>(i_left, i_right);
+}
+
+template <class A, class B, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY_ARRAY(B)>
+detail::expression_t<detail::quotient_t<A, B>, std::divides, A, B> operator/(A const& i_left, B const& i_right)
+{
+    DIM_CHECK_SYSTEMS(A::unit, B::unit)
+    return detail::make_expression<detail::quotient_t<A, B>, std::divides>(i_left, i_right);
+}
+
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<detail::element_t<A>, std::multiplies, A, typename A::scalar> operator-(A const& i_values)
+{
+    return detail::make_expression<detail::element_t<A>, std::multiplies>(i_values, typename A::scalar(-1));
+}
+
+// Array-quantity operators, applying the quantity to every element
+
+template <class A, class Q, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY(Q)>
+detail::expression_t<detail::element_t<A>, std::plus, A, Q> operator+(A const& i_left, Q const& i_right)
+{
+    DIM_CHECK_DIMENSIONS(A::unit, Q::unit)
+    DIM_CHECK_SYSTEMS(A::unit, Q::unit)
+    return detail::make_expression<detail::element_t<A>, std::plus>(i_left, i_right);
+}
+
+template <class Q, class A, DIM_IS_QUANTITY(Q), DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<detail::element_t<A>, std::plus, Q, A> operator+(Q const& i_left, A const& i_right)
+{
+    DIM_CHECK_DIMENSIONS(A::unit, Q::unit)
+    DIM_CHECK_SYSTEMS(A::unit, Q::unit)
+    return detail::make_expression<detail::element_t<A>, std::plus>(i_left, i_right);
+}
+
+template <class A, class Q, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY(Q)>
+detail::expression_t<detail::element_t<A>, std::minus, A, Q> operator-(A const& i_left, Q const& i_right)
+{
+    DIM_CHECK_DIMENSIONS(A::unit, Q::unit)
+    DIM_CHECK_SYSTEMS(A::unit, Q::unit)
+    return detail::make_expression<detail::element_t<A>, std::minus>(i_left, i_right);
+}
+
+template <class Q, class A, DIM_IS_QUANTITY(Q), DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<detail::element_t<A>, std::minus, Q, A> operator-(Q const& i_left, A const& i_right)
+{
+    DIM_CHECK_DIMENSIONS(A::unit, Q::unit)
+    DIM_CHECK_SYSTEMS(A::unit, Q::unit)
+    return detail::make_expression<detail::element_t<A>, std::minus>(i_left, i_right);
+}
+
+template <class A, class Q, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY(Q)>
+detail::expression_t<detail::product_t<A, Q>, std::multiplies, A, Q> operator*(A const& i_left, Q const& i_right)
+{
+    DIM_CHECK_SYSTEMS(A::unit, Q::unit)
+    return detail::make_expression<detail::product_t<A, Q>, std::multiplies>(i_left, i_right);
+}
+
+template <class Q, class A, DIM_IS_QUANTITY(Q), DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<detail::product_t<Q, A>, std::multiplies, Q, A> operator*(Q const& i_left, A const& i_right)
+{
+    DIM_CHECK_SYSTEMS(A::unit, Q::unit)
+    return detail::make_expression<detail::product_t<Q, A>, std::multiplies>(i_left, i_right);
+}
+
+template <class A, class Q, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY(Q)>
+detail::expression_t<detail::quotient_t<A, Q>, std::divides, A, Q> operator/(A const& i_left, Q const& i_right)
+{
+    DIM_CHECK_SYSTEMS(A::unit, Q::unit)
+    return detail::make_expression<detail::quotient_t<A, Q>, std::divides>(i_left, i_right);
+}
+
+template <class Q, class A, DIM_IS_QUANTITY(Q), DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<detail::quotient_t<Q, A>, std::divides, Q, A> operator/(Q const& i_left, A const& i_right)
+{
+    DIM_CHECK_SYSTEMS(A::unit, Q::unit)
+    return detail::make_expression<detail::quotient_t<Q, A>, std::divides>(i_left, i_right);
+}
+
+// Array-scalar operators
+
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<detail::element_t<A>, std::multiplies, A, typename A::scalar>
+operator*(A const& i_left, typename A::scalar const& i_right)
+{
+    return detail::make_expression<detail::element_t<A>, std::multiplies>(i_left, i_right);
+}
+
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<detail::element_t<A>, std::multiplies, typename A::scalar, A>
+operator*(typename A::scalar const& i_left, A const& i_right)
+{
+    return detail::make_expression<detail::element_t<A>, std::multiplies>(i_left, i_right);
+}
+
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<detail::element_t<A>, std::divides, A, typename A::scalar>
+operator/(A const& i_left, typename A::scalar const& i_right)
+{
+    return detail::make_expression<detail::element_t<A>, std::divides>(i_left, i_right);
+}
+
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+detail::expression_t<quantity<typename A::unit::inverse, typename A::scalar>, std::divides, typename A::scalar, A>
+operator/(typename A::scalar const& i_left, A const& i_right)
+{
+    return detail::make_expression<quantity<typename A::unit::inverse, typename A::scalar>, std::divides>(i_left,
+                                                                                                          i_right);
+}
+
+// In-place operators, evaluated in one pass. These also work on (non-const) spans, changing the viewed values.
+
+template <class A, class B, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY_ARRAY(B)>
+A& operator+=(A& io_left, B const& i_right)
+{
+    detail::array_evaluate(io_left + i_right, io_left.scalars(), sequential_policy());
+    return io_left;
+}
+
+template <class A, class B, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY_ARRAY(B)>
+A& operator-=(A& io_left, B const& i_right)
+{
+    detail::array_evaluate(io_left - i_right, io_left.scalars(), sequential_policy());
+    return io_left;
+}
+
+template <class A, class Q, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY(Q)>
+A& operator+=(A& io_left, Q const& i_right)
+{
+    detail::array_evaluate(io_left + i_right, io_left.scalars(), sequential_policy());
+    return io_left;
+}
+
+template <class A, class Q, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY(Q)>
+A& operator-=(A& io_left, Q const& i_right)
+{
+    detail::array_evaluate(io_left - i_right, io_left.scalars(), sequential_policy());
+    return io_left;
+}
+
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+A& operator*=(A& io_left, typename A::scalar const& i_right)
+{
+    detail::array_evaluate(io_left * i_right, io_left.scalars(), sequential_policy());
+    return io_left;
+}
+
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+A& operator/=(A& io_left, typename A::scalar const& i_right)
+{
+    detail::array_evaluate(io_left / i_right, io_left.scalars(), sequential_policy());
+    return io_left;
+}
+
+// Reductions. These evaluate expressions on the fly, so e.g. sum(a * b) makes no temporary array.
+
+/// Sum of the values (zero if there are none, a bad quantity if the expression is not valid)
+template <class A, class Policy = sequential_policy, DIM_IS_QUANTITY_ARRAY(A)>
+detail::element_t<A> sum(A const& i_values, Policy const& i_policy = Policy())
+{
+    using scalar = typename A::scalar;
+    detail::operand_t<A> values = detail::make_operand(i_values);
+    if (!values.valid()) {
+        return detail::element_t<A>::bad_quantity();
+    }
+    std::vector<scalar> parts(i_policy.parts(values.size()));
+    i_policy.run(values.size(), [&](std::size_t i_part, std::size_t i_first, std::size_t i_last) {
+        parts[i_part] = detail::array_sum(values, i_first, i_last);
+    });
+    scalar total = 0;
+    for (scalar part : parts) {
+        total += part;
+    }
+    return detail::element_t<A>(total);
+}
+
+/// Sum of the elementwise products, with the units of their product
+template <class A, class B, class Policy = sequential_policy, DIM_IS_QUANTITY_ARRAY(A), DIM_IS_QUANTITY_ARRAY(B)>
+detail::product_t<A, B> dot(A const& i_left, B const& i_right, Policy const& i_policy = Policy())
+{
+    return sum(i_left * i_right, i_policy);
+}
+
+/// Smallest value, skipping bad quantities, or a bad quantity if there are no good values
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+detail::element_t<A> min(A const& i_values)
+{
+    detail::operand_t<A> values = detail::make_operand(i_values);
+    bool found = false;
+    typename A::scalar extreme =
+        values.size() && values.valid() ? detail::array_extreme(values, typename A::scalar(1), found) : 0;
+    return found ? detail::element_t<A>(extreme) : detail::element_t<A>::bad_quantity();
+}
+
+/// Largest value, skipping bad quantities, or a bad quantity if there are no good values
+template <class A, DIM_IS_QUANTITY_ARRAY(A)>
+detail::element_t<A> max(A const& i_values)
+{
+    detail::operand_t<A> values = detail::make_operand(i_values);
+    bool found = false;
+    typename A::scalar extreme =
+        values.size() && values.valid() ? detail::array_extreme(values, typename A::scalar(-1), found) : 0;
+    return found ? detail::element_t<A>(extreme) : detail::element_t<A>::bad_quantity();
+}
+
+} // namespace dim
@@ -1,5 +1,12 @@
 #include "definition.hpp"
 #include "dim/si/si_facet.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace dim {
 namespace si {
@@ -7,57 +14,139 @@ const char* system::kSymbol[] = {"m", "s", "kg", "rad", "K", "mol", "A", "cd"};
 // If you cast the string "si" to a short* on a little-endian system, this is the numeric value
 const long system::id =  26995L;
 
-static si::output_format_map g_specialized_symbol_map;
+namespace
+{
+/// A unit code (dynamic_unit::raw()) and its symbol
+struct specialized_entry {
+    uint64_t code;
+    char const* symbol;
+};
 
-void system::set_specialized_symbol(dynamic_unit const& i_u, char const* i_symbol)
+/// Symbols for the named SI units, sorted by code
+constexpr specialized_entry kSpecializedSymbols[] = {
+    {::dim::index<Length>().raw(), "m"},
+    {::dim::index<Time>().raw(), "s"},
+    {::dim::index<Frequency>().raw(), "Hz"},
+    {::dim::index<Mass>().raw(), "kg"},
+    {::dim::index<Power>().raw(), "W"},
+    {::dim::index<Force>().raw(), "N"},
+    {::dim::index<Energy>().raw(), "J"},
+    {::dim::index<Pressure>().raw(), "Pa"},
+    {::dim::index<Viscosity>().raw(), "Pl"},
+    {::dim::index<Angle>().raw(), "rad"},
+    {::dim::index<SolidAngle>().raw(), "sr"},
+    {::dim::index<Temperature>().raw(), "K"},
+    {::dim::index<Amount>().raw(), "mol"},
+    {::dim::index<CatalyticActivity>().raw(), "kat"},
+    {::dim::index<Current>().raw(), "A"},
+    {::dim::index<Charge>().raw(), "C"},
+    {::dim::index<Capacitance>().raw(), "F"},
+    {::dim::index<Conductance>().raw(), "S"},
+    {::dim::index<Resistance>().raw(), "R"},
+    {::dim::index<Inductance>().raw(), "H"},
+    {::dim::index<Voltage>().raw(), "V"},
+    {::dim::index<MagneticFluxDensity>().raw(), "T"},
+    {::dim::index<MagneticFlux>().raw(), "Wb"},
+    {::dim::index<Luminosity>().raw(), "cd"},
+    {::dim::index<LuminousFlux>().raw(), "Im"},
+    {::dim::index<Luminance>().raw(), "Ix"},
+};
+
+constexpr std::size_t kSpecializedCount = sizeof(kSpecializedSymbols) / sizeof(kSpecializedSymbols[0]);
+
+constexpr bool specialized_sorted(std::size_t i)
+{
+    return i + 1 >= kSpecializedCount ||
+           (kSpecializedSymbols[i].code < kSpecializedSymbols[i + 1].code && specialized_sorted(i + 1));
+}
+static_assert(specialized_sorted(0), "kSpecializedSymbols must be sorted by code, without duplicates");
+
+/// Binary search [i_begin, i_end) for i_code. Returns nullptr if it's not there.
+char const* find_specialized(specialized_entry const* i_begin, specialized_entry const* i_end, uint64_t i_code)
+{
+    specialized_entry const* found = std::lower_bound(
+        i_begin, i_end, i_code, [](specialized_entry const& i_entry, uint64_t i_key) { return i_entry.code < i_key; });
+    return (found != i_end && found->code == i_code ? found->symbol : nullptr);
+}
+
+/// A sorted version of the symbols added by set_specialized_symbol()
+struct specialized_overlay {
+    std::vector<specialized_entry> entries;
+};
+
+/**
+ * Symbols added by set_specialized_symbol(), which take precedence over the
+ * built-in table. Writers copy the current version, add to it and publish the
+ * copy through an atomic pointer, so readers never lock: a lookup is one
+ * acquire load and a binary search. Replaced versions are kept until exit, as
+ * a reader may still be searching one; there is one per set that changed a
+ * symbol. Each distinct symbol string is also kept until exit, so a pointer
+ * returned by specialized_symbol() stays valid.
+ *
+ * This is a function-local static so set_specialized_symbol() can be called
+ * during static initialization.
+ */
+struct overlay_state {
+    std::atomic<specialized_overlay const*> current{nullptr};
+    std::mutex mutex; // Guards the members below, and writing current
+    std::set<std::string> symbols;
+    std::vector<std::unique_ptr<specialized_overlay const>> versions;
+};
+
+overlay_state& overlay()
 {
-    si::formatter special_format(i_symbol, dynamic_quantity(i_u));
-    g_specialized_symbol_map.insert(special_format);
+    static overlay_state state;
+    return state;
 }
+} // namespace
 
-static void initialize_specialized_symbol_map()
+void system::set_specialized_symbol(dynamic_unit const& i_u, char const* i_symbol)
 {
-    system::set_specialized_symbol(::dim::index<Length>(), "m");
-    system::set_specialized_symbol(::dim::index<Time>(), "s");
-    system::set_specialized_symbol(::dim::index<Mass>(), "kg");
-    system::set_specialized_symbol(::dim::index<Angle>(), "rad");
-    system::set_specialized_symbol(::dim::index<Temperature>(), "K");
-    system::set_specialized_symbol(::dim::index<Amount>(), "mol");
-    system::set_specialized_symbol(::dim::index<Current>(), "A");
-    system::set_specialized_symbol(::dim::index<Luminosity>(), "cd");
-
-    system::set_specialized_symbol(::dim::index<Frequency>(), "Hz");
-    system::set_specialized_symbol(::dim::index<SolidAngle>(), "sr");
-    system::set_specialized_symbol(::dim::index<Force>(), "N");
-    system::set_specialized_symbol(::dim::index<Pressure>(), "Pa");
-    system::set_specialized_symbol(::dim::index<Energy>(), "J");
-    system::set_specialized_symbol(::dim::index<Power>(), "W");
-    system::set_specialized_symbol(::dim::index<Charge>(), "C");
-    system::set_specialized_symbol(::dim::index<Voltage>(), "V");
-    system::set_specialized_symbol(::dim::index<Capacitance>(), "F");
-    system::set_specialized_symbol(::dim::index<Resistance>(), "R");
-    system::set_specialized_symbol(::dim::index<Conductance>(), "S");
-    system::set_specialized_symbol(::dim::index<MagneticFlux>(), "Wb");
-    system::set_specialized_symbol(::dim::index<MagneticFluxDensity>(), "T");
-    system::set_specialized_symbol(::dim::index<Inductance>(), "H");
-    system::set_specialized_symbol(::dim::index<LuminousFlux>(), "Im");
-    system::set_specialized_symbol(::dim::index<Luminance>(), "Ix");
-    system::set_specialized_symbol(::dim::index<CatalyticActivity>(), "kat");
-    system::set_specialized_symbol(::dim::index<Viscosity>(), "Pl");
+    overlay_state& state = overlay();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    char const* symbol = state.symbols.emplace(i_symbol, ::dim::detail::symbol_length(i_symbol)).first->c_str();
+    specialized_entry entry{i_u.raw(), symbol};
+
+    specialized_overlay const* current = state.current.load(std::memory_order_relaxed);
+    if (current && find_specialized(current->entries.data(), current->entries.data() + current->entries.size(),
+                                    entry.code) == symbol) {
+        return;
+    }
+    std::unique_ptr<specialized_overlay> next(new specialized_overlay);
+    if (current) {
+        next->entries = current->entries;
+    }
+    auto position = std::lower_bound(next->entries.begin(), next->entries.end(), entry,
+                                     [](specialized_entry const& i_left, specialized_entry const& i_right) {
+                                         return i_left.code < i_right.code;
+                                     });
+    if (position != next->entries.end() && position->code == entry.code) {
+        *position = entry;
+    } else {
+        next->entries.insert(position, entry);
+    }
+    state.current.store(next.get(), std::memory_order_release);
+    state.versions.emplace_back(std::move(next));
 }
 
 const char* system::specialized_symbol(dynamic_unit const& i_u)
 {
-    static bool s_init_map = true;
-    if (s_init_map) {
-        initialize_specialized_symbol_map();
+    specialized_overlay const* current = overlay().current.load(std::memory_order_acquire);
+    if (current) {
+        char const* symbol =
+            find_specialized(current->entries.data(), current->entries.data() + current->entries.size(), i_u.raw());
+        if (symbol) {
+            return symbol;
+        }
     }
-    auto const* special = g_specialized_symbol_map.get(i_u);
-    return (special? special->symbol() : "");    
+    char const* symbol = find_specialized(kSpecializedSymbols, kSpecializedSymbols + kSpecializedCount, i_u.raw());
+    return (symbol ? symbol : "");
 }
 
 }  // namespace si
 
 template class dynamic_unit<si::system>;
 
+constexpr si::dynamic_unit interned_units<si::system>::kUnits[];
+
 }  // namespace dim
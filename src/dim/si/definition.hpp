@@ -55,6 +55,9 @@ struct system : system_tag {
     /// Obtain the specialized symbol for a given dynamic_unit.
     /// If no such symbol exists for U, this will return an empty string
     static const char* specialized_symbol(dynamic_unit const& i_u);
+    /// Override the specialized symbol for i_u. This is safe to call while other threads
+    /// read symbols, which never lock. Each distinct symbol string, and each version of
+    /// the overrides, is kept until exit.
     static void set_specialized_symbol(dynamic_unit const& i_u, char const* i_symbol);
 
     /// The dimensionless dynamic_unit for si
@@ -119,6 +122,31 @@ using Torque              = quantity<unit_divide_t<Energy::unit, Angle::unit>, d
 using Density             = quantity<unit_divide_t<Mass::unit, Volume::unit>, double>;
 using KinematicViscosity  = quantity<unit_divide_t<Area::unit, Time::unit>, double>;
 
+} // end of namespace si
+
+/// The SI units interned with fixed compact IDs: the base and named derived units, then the compound ones
+template <> struct interned_units<si::system> {
+    // clang-format off
+    static constexpr si::dynamic_unit kUnits[] = {
+        index<si::Length>(), index<si::Time>(), index<si::Mass>(), index<si::Angle>(), index<si::Temperature>(),
+        index<si::Amount>(), index<si::Current>(), index<si::Luminosity>(),
+        index<si::Frequency>(), index<si::SolidAngle>(), index<si::Force>(), index<si::Pressure>(),
+        index<si::Energy>(), index<si::Power>(), index<si::Charge>(), index<si::Voltage>(), index<si::Capacitance>(),
+        index<si::Resistance>(), index<si::Conductance>(), index<si::MagneticFlux>(),
+        index<si::MagneticFluxDensity>(), index<si::Inductance>(), index<si::LuminousFlux>(),
+        index<si::Luminance>(), index<si::CatalyticActivity>(), index<si::Viscosity>(),
+        index<si::Area>(), index<si::Volume>(), index(si::second2), index<si::FlowRate>(),
+        index<si::Speed>(), index<si::Acceleration>(), index<si::AngularRate>(), index<si::AngularAcceleration>(),
+        index<si::Torque>(), index<si::Density>(), index<si::KinematicViscosity>()};
+    // clang-format on
+
+    static constexpr std::size_t count() { return sizeof(kUnits) / sizeof(kUnits[0]); }
+    static constexpr si::dynamic_unit get(std::size_t i) { return kUnits[i]; }
+};
+
+namespace si
+{
+
 
 /*****************************************************************************
  * CONVERSIONS
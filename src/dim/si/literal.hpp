@@ -1,5 +1,6 @@
 #pragma once
 #include "definition.hpp"
+#include "unit_string_parser.hpp"
 
 /**
  * Literal formatters for SI types. To use these, you must do `using namespace dim::si::literal;`. 
@@ -40,3 +41,99 @@ DIM_MAKE_LITERAL(kat, dim::si::katal_)
 }  // namespace literal
 }  // namespace si
 }  // namespace dim
+
+#if __cplusplus >= 201402L
+namespace dim
+{
+namespace detail
+{
+/**
+ * @brief The quantity for an SI unit string known at compile time.
+ *
+ * Text must have a static constexpr str() member returning the unit string.
+ * Malformed strings fail to compile.
+ */
+template <class Text>
+struct parsed_quantity {
+    static constexpr uint64_t kCode = parse_constant<Text>().unit().raw();
+    static constexpr double kScale = parse_constant<Text>().value();
+    static_assert(!si::dynamic_unit(kCode).is_bad(), "Malformed SI unit string");
+
+    // clang-format off
+    using type = quantity<unit<si::dynamic_unit(kCode).length(), si::dynamic_unit(kCode).time(),
+                               si::dynamic_unit(kCode).mass(), si::dynamic_unit(kCode).angle(),
+                               si::dynamic_unit(kCode).temperature(), si::dynamic_unit(kCode).amount(),
+                               si::dynamic_unit(kCode).current(), si::dynamic_unit(kCode).luminosity(), si::system>,
+                          double>;
+    // clang-format on
+
+    static constexpr type make() { return type(kScale); }
+};
+
+template <class Text>
+constexpr uint64_t parsed_quantity<Text>::kCode;
+
+template <class Text>
+constexpr double parsed_quantity<Text>::kScale;
+} // namespace detail
+} // namespace dim
+
+/**
+ * @brief Parse an SI unit string at compile time.
+ *
+ * The result is a static quantity holding the scale of the unit, so
+ * `DIM_UNIT("kN*m")` is an si::Energy of 1000 J. A malformed string fails the
+ * build. This requires C++14, and the result is a constant expression from
+ * C++17 on.
+ */
+#define DIM_UNIT(TEXT)                                                                                                 \
+    ([] {                                                                                                              \
+        struct dim_unit_text {                                                                                         \
+            static constexpr char const* str() { return TEXT; }                                                        \
+        };                                                                                                             \
+        return ::dim::detail::parsed_quantity<dim_unit_text>::make();                                                  \
+    }())
+#endif
+
+#if __cplusplus >= 202002L
+namespace dim
+{
+namespace detail
+{
+/// A string literal usable as a template parameter
+template <std::size_t N>
+struct fixed_string {
+    constexpr fixed_string(char const (&i_text)[N])
+    {
+        for (std::size_t i = 0; i < N; ++i) {
+            text[i] = i_text[i];
+        }
+    }
+
+    char text[N] = {};
+};
+
+/// Adapts a fixed_string for parsed_quantity
+template <fixed_string Text>
+struct fixed_text {
+    static constexpr char const* str() { return Text.text; }
+};
+} // namespace detail
+
+namespace si
+{
+namespace literal
+{
+/**
+ * @brief Parse an SI unit string at compile time, so `"kN*m"_unit` is an
+ * si::Energy of 1000 J. A malformed string fails the build.
+ */
+template <::dim::detail::fixed_string Text>
+constexpr auto operator""_unit()
+{
+    return ::dim::detail::parsed_quantity<::dim::detail::fixed_text<Text>>::make();
+}
+} // namespace literal
+} // namespace si
+} // namespace dim
+#endif
@@ -2,6 +2,7 @@
 #include "definition.hpp"
 #include "si_io.hpp"
 #include <iostream>
+#include <iterator>
 
 /**
  * The facet contains the formatters for SI.
@@ -41,79 +42,86 @@ void install_facet(si::facet* i_quantity_facet)
 facet* make_default_facet()
 {
     facet* instance = new facet();
-    instance->input_formatter(get_default_format<Acceleration>());
-    instance->input_formatter(get_default_format<Amount>());
-    instance->input_formatter(get_default_format<Angle>());
-    instance->input_formatter(get_default_format<AngularAcceleration>());
-    instance->input_formatter(get_default_format<AngularRate>());
-    instance->input_formatter(get_default_format<Area>());
-    instance->input_formatter(get_default_format<Capacitance>());
-    instance->input_formatter(get_default_format<CatalyticActivity>());
-    instance->input_formatter(get_default_format<Charge>());
-    instance->input_formatter(get_default_format<Conductance>());
-    instance->input_formatter(get_default_format<Current>());
-    instance->input_formatter(get_default_format<Density>());
-    instance->input_formatter(get_default_format<Energy>());
-    instance->input_formatter(get_default_format<FlowRate>());   
-    instance->input_formatter(get_default_format<Force>());
-    instance->input_formatter(get_default_format<Frequency>());
-    instance->input_formatter(get_default_format<Inductance>());
-    instance->input_formatter(get_default_format<KinematicViscosity>());
-    instance->input_formatter(get_default_format<Length>());
-    instance->input_formatter(get_default_format<Luminance>());
-    instance->input_formatter(get_default_format<Luminosity>());
-    instance->input_formatter(get_default_format<LuminousFlux>());
-    instance->input_formatter(get_default_format<MagneticFlux>());
-    instance->input_formatter(get_default_format<MagneticFluxDensity>());
-    instance->input_formatter(get_default_format<Mass>());
-    instance->input_formatter(get_default_format<Power>());
-    instance->input_formatter(get_default_format<Pressure>());
-    instance->input_formatter(get_default_format<Resistance>());
-    instance->input_formatter(get_default_format<SolidAngle>());
-    instance->input_formatter(get_default_format<Speed>());
-    instance->input_formatter(get_default_format<Temperature>());
-    instance->input_formatter(get_default_format<Time>());
-    instance->input_formatter(get_default_format<Torque>());
-    instance->input_formatter(get_default_format<Viscosity>());      
-    instance->input_formatter(get_default_format<Voltage>());
-    instance->input_formatter(get_default_format<Volume>());
-      
-    instance->output_formatter("m", meter);
-    instance->output_formatter("s", second);
-    instance->output_formatter("kg", kilogram);
-    instance->output_formatter("rad", radian);
-    instance->output_formatter("sr", steradian);
-    instance->output_formatter("K", kelvin);
-    instance->output_formatter("mol", mole);
-    instance->output_formatter("A", ampere);
-    instance->output_formatter("cd", candela);
-    instance->output_formatter("Hz", hertz);
-    instance->output_formatter("N", newton);
-    instance->output_formatter("Pa", pascal);
-    instance->output_formatter("J", joule);
-    instance->output_formatter("W", watt);
-    instance->output_formatter("C", coulomb);
-    instance->output_formatter("V", volt);
-    instance->output_formatter("F", farad);
-    instance->output_formatter("Ω", ohm);
-    instance->output_formatter("S", siemens);
-    instance->output_formatter("Wb", weber);
-    instance->output_formatter("T", tesla);
-    instance->output_formatter("H", henry);
-    instance->output_formatter("Im", lumen);
-    instance->output_formatter("Ix", lux);
-    instance->output_formatter("kat", katal);
-    instance->output_formatter("Pl", poiseuille);
-    instance->output_formatter("m^2", meter2);
-    instance->output_formatter("L", liter);
-    instance->output_formatter("L/s", liter / second);
-    instance->output_formatter("m/s", meter / second);
-    instance->output_formatter("m/s^2", meter / second / second);
-    instance->output_formatter("rad/s", radian / second);
-    instance->output_formatter("rad/s^2", radian / second / second);
-    instance->output_formatter("N*m/rad", newton * meter / radian);
-    instance->output_formatter("kg/m^3", kilogram / meter3);
-    instance->output_formatter("St", meter2 / second);
+    // Insert the maps and formatters as ranges, so each index is built once
+    input_format_map const inputs[] = {
+        get_default_format<Acceleration>(),
+        get_default_format<Amount>(),
+        get_default_format<Angle>(),
+        get_default_format<AngularAcceleration>(),
+        get_default_format<AngularRate>(),
+        get_default_format<Area>(),
+        get_default_format<Capacitance>(),
+        get_default_format<CatalyticActivity>(),
+        get_default_format<Charge>(),
+        get_default_format<Conductance>(),
+        get_default_format<Current>(),
+        get_default_format<Density>(),
+        get_default_format<Energy>(),
+        get_default_format<FlowRate>(),
+        get_default_format<Force>(),
+        get_default_format<Frequency>(),
+        get_default_format<Inductance>(),
+        get_default_format<KinematicViscosity>(),
+        get_default_format<Length>(),
+        get_default_format<Luminance>(),
+        get_default_format<Luminosity>(),
+        get_default_format<LuminousFlux>(),
+        get_default_format<MagneticFlux>(),
+        get_default_format<MagneticFluxDensity>(),
+        get_default_format<Mass>(),
+        get_default_format<Power>(),
+        get_default_format<Pressure>(),
+        get_default_format<Resistance>(),
+        get_default_format<SolidAngle>(),
+        get_default_format<Speed>(),
+        get_default_format<Temperature>(),
+        get_default_format<Time>(),
+        get_default_format<Torque>(),
+        get_default_format<Viscosity>(),
+        get_default_format<Voltage>(),
+        get_default_format<Volume>(),
+    };
+    instance->input_formatter(std::begin(inputs), std::end(inputs));
+
+    formatter const outputs[] = {
+        formatter("m", meter),
+        formatter("s", second),
+        formatter("kg", kilogram),
+        formatter("rad", radian),
+        formatter("sr", steradian),
+        formatter("K", kelvin),
+        formatter("mol", mole),
+        formatter("A", ampere),
+        formatter("cd", candela),
+        formatter("Hz", hertz),
+        formatter("N", newton),
+        formatter("Pa", pascal),
+        formatter("J", joule),
+        formatter("W", watt),
+        formatter("C", coulomb),
+        formatter("V", volt),
+        formatter("F", farad),
+        formatter("Ω", ohm),
+        formatter("S", siemens),
+        formatter("Wb", weber),
+        formatter("T", tesla),
+        formatter("H", henry),
+        formatter("Im", lumen),
+        formatter("Ix", lux),
+        formatter("kat", katal),
+        formatter("Pl", poiseuille),
+        formatter("m^2", meter2),
+        formatter("L", liter),
+        formatter("L/s", liter / second),
+        formatter("m/s", meter / second),
+        formatter("m/s^2", meter / second / second),
+        formatter("rad/s", radian / second),
+        formatter("rad/s^2", radian / second / second),
+        formatter("N*m/rad", newton * meter / radian),
+        formatter("kg/m^3", kilogram / meter3),
+        formatter("St", meter2 / second),
+    };
+    instance->output_formatter(std::begin(outputs), std::end(outputs));
 
     return instance;
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include "dim/codec.hpp"
 #include "dim/facet.hpp"
 
 /**
@@ -20,6 +21,7 @@ using formatted_quantity = dim::formatted_quantity<typename dynamic_quantity::sc
 using input_format_map = ::dim::input_format_map<typename dynamic_quantity::scalar, typename dynamic_quantity::system>;
 using input_format_map_group = ::dim::input_format_map_group<typename dynamic_quantity::scalar, typename dynamic_quantity::system>;
 using output_format_map = ::dim::output_format_map<typename dynamic_quantity::scalar, typename dynamic_quantity::system>;
+using codec = ::dim::quantity_codec<typename dynamic_quantity::scalar, typename dynamic_quantity::system>;
 
 /**
  * The facet for formatting SI types. This is a simple extension of the base quantity_facet that specifies
@@ -1,7 +1,9 @@
 #include "si_io.hpp"
 
 /**
- * Definitions of the SI formatters for each quantity
+ * Definitions of the SI formatters for each quantity. Each is a static table
+ * with a perfect-hash index over its symbols, built at compile time when
+ * constexpr allows (C++14) and on first use otherwise.
  */ 
 
 namespace dim {
@@ -11,19 +13,21 @@ using namespace si;
 // clang-format off
 
 template<> si::input_format_map const& get_default_format<Temperature>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"F", 5./9.*kelvin, (273.15 - 5./9.*32.)*kelvin},
         {"℉", 5./9.*kelvin, (273.15 - 5./9.*32.)*kelvin},
         {"R", rankine},
         {"C", kelvin, 273.15*kelvin},
         {"℃", kelvin, 273.15*kelvin}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Length>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"metre", meter},
         {"in", inch },
         {"inch", inch},
@@ -37,24 +41,28 @@ si::input_format_map const& get_default_format<Length>() {
         {"nautical_mile", nautical_mile},
         {"Å", 1e-10 * meter}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Time>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"min", minute},
         {"h", hour},
         {"hr", hour},
         {"minute", minute},
         {"hour", hour}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Mass>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"oz", pound_mass / 16.0},
         {"lb", pound_mass},
         {"lbm", pound_mass},
@@ -63,12 +71,14 @@ si::input_format_map const& get_default_format<Mass>() {
         {"pound", pound_mass},
         {"pound_mass", pound_mass}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Angle>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"radian", radian},
         {"deg", degree},
         {"°", degree},
@@ -88,24 +98,28 @@ si::input_format_map const& get_default_format<Angle>() {
         {"sec", degree / 3600.0},
         {"second", degree / 3600.0}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<SolidAngle>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"steradian", steradian},
         {"sr", steradian},
         {"sp", 4.0 * M_PI * steradian},
         {"spat", 4.0 * M_PI * steradian}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 
 template<>
 si::input_format_map const& get_default_format<Force>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"dyn", dyne},
         {"dyne", dyne},
         {"lb", pound_force},
@@ -113,12 +127,14 @@ si::input_format_map const& get_default_format<Force>() {
         {"pound", pound_force},
         {"pound_force", pound_force}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Pressure>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"lbf/in^2", pound_force / inch / inch},
         {"lbf_in^-2", pound_force / inch / inch},
         {"lb/in^2", pound_force / inch / inch},
@@ -129,12 +145,14 @@ si::input_format_map const& get_default_format<Pressure>() {
         {"atm", atmosphere},
         {"atmosphere", atmosphere}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Energy>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"kW_hr", 1e3*watt*hour},        
         {"kW_h", 1e3*watt*hour},
         {"kWh", 1e3*watt*hour},
@@ -145,21 +163,25 @@ si::input_format_map const& get_default_format<Energy>() {
         {"ft_lbf", foot * pound_force},
         {"BTU", 1055.06 * joule}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Power>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"hp", 33e3 * foot* pound_force / minute},
         {"horsepower", 33e3 * foot* pound_force / minute}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Area>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"acre", acre},
         {"ac", acre},
         {"sq_mi", mile * mile},
@@ -173,12 +195,14 @@ si::input_format_map const& get_default_format<Area>() {
         {"ha", 1e4*meter2},
         {"hectare", 1e4*meter2}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<Volume>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"cc", 1e-6 * meter3},
         {"liter", liter},
         {"litre", liter},
@@ -197,12 +221,14 @@ si::input_format_map const& get_default_format<Volume>() {
         {"yd^3", yard* yard * yard},
         {"cubic_yard", yard* yard * yard},
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 
 template<>
 si::input_format_map const& get_default_format<FlowRate>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"gal/s", gallon / second},
         {"gal/min", gallon / minute},
         {"meter3/second", meter3 / second},
@@ -211,11 +237,13 @@ si::input_format_map const& get_default_format<FlowRate>() {
         {"gallon/second", gallon / second},
         {"gallon/minute", gallon / minute},
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 template<>
 si::input_format_map const& get_default_format<Speed>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"mps", meter/second},
         {"kph", 1e3*meter/hour},
         {"mph", mile / hour},
@@ -226,19 +254,23 @@ si::input_format_map const& get_default_format<Speed>() {
         {"ft/s", foot / second},
         {"feet_per_second", foot / second}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 template<>
 si::input_format_map const& get_default_format<Acceleration>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"ft/s^2", foot / second / second},
         {"feet_per_second2", foot / second / second}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 template<>
 si::input_format_map const& get_default_format<AngularRate>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"deg/s", degree / second},
         {"°/s", degree / second},
         {"rpm", 2.0 * M_PI * radian / minute},
@@ -246,42 +278,182 @@ si::input_format_map const& get_default_format<AngularRate>() {
         {"degrees_per_second", degree / second},
         {"radians_per_second", radian / second}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 template<>
 si::input_format_map const& get_default_format<AngularAcceleration>() {
-    static const si::input_format_map s_known {
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"deg/s^2", degree / second / second},
         {"°/s^2", degree / second / second},
         {"degrees_per_second2", degree / second / second},
         {"radians_per_second2", radian / second / second}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 template<>
 si::input_format_map const& get_default_format<Torque>() {
-    static const si::input_format_map s_known {        
+    static DIM_CONSTEXPR14 const si::formatter s_formats[] = {
         {"ft_lbf", foot * pound_force/radian},        
         {"ft_lb", foot * pound_force/radian},
         {"foot_pound", foot * pound_force/radian}
     };
+    static DIM_CONSTEXPR14 const detail::symbol_hash_index<sizeof(s_formats) / sizeof(s_formats[0])> s_index(s_formats);
+    static const si::input_format_map s_known(s_formats, s_index);
     return s_known;
 }
 // clang-format on
 }  // namespace dim
 
-// Use the Bison/Flex parser.
-#include "quantity_parser_driver.hpp"
+// Use the hand-written unit string parser.
+#include "unit_string_parser.hpp"
+#include <atomic>
+#include <cstring>
+#include <vector>
 
 namespace dim {
+namespace si {
+
+namespace {
+
+/// Cache capacity shared by all threads. Each thread's cache follows this on use.
+std::atomic<std::size_t> g_parse_cache_capacity(512);
+
+/**
+ * Bounded memo of fallback parser results for one thread. Entries are grouped
+ * in sets of two selected by the symbol hash. A miss replaces the least
+ * recently used entry of its set.
+ */
+class parse_cache
+{
+  public:
+    parse_cache()
+        : m_capacity(0),
+          m_hits(0),
+          m_misses(0)
+    {
+    }
+
+    /// Look up [i_begin, i_end) in the cache, running the parser on a miss
+    dynamic_quantity parse(char const* i_begin, char const* i_end)
+    {
+        sync_capacity();
+        // The parser stops at the first nul, so that is the end of the key
+        char const* nul = static_cast<char const*>(memchr(i_begin, '\0', static_cast<std::size_t>(i_end - i_begin)));
+        char const* key_end = (nul ? nul : i_end);
+        std::size_t length = static_cast<std::size_t>(key_end - i_begin);
+        if (m_capacity == 0 || length >= static_cast<std::size_t>(kMaxSymbol)) {
+            return run_parser(i_begin, i_end);
+        }
+
+        std::size_t set = ::dim::detail::symbol_hash(i_begin, key_end) & (m_capacity / 2 - 1);
+        entry* ways = &m_entries[2 * set];
+        for (int way = 0; way < 2; way++) {
+            if (ways[way].matches(i_begin, length)) {
+                m_hits++;
+                m_victim[set] = static_cast<uint8_t>(1 - way);
+                return ways[way].result;
+            }
+        }
+        m_misses++;
+        entry& slot = ways[m_victim[set]];
+        m_victim[set] = static_cast<uint8_t>(1 - m_victim[set]);
+        slot.length = static_cast<int>(length);
+        memcpy(slot.symbol, i_begin, length);
+        slot.result = run_parser(i_begin, i_end);
+        return slot.result;
+    }
+
+    parse_cache_stats statistics() const { return {m_hits, m_misses, m_capacity}; }
+
+    void clear()
+    {
+        m_entries.assign(m_capacity, entry());
+        m_victim.assign(m_capacity / 2, 0);
+        m_hits = m_misses = 0;
+    }
+
+  private:
+    struct entry {
+        entry()
+            : length(-1)
+        {
+        }
+
+        bool matches(char const* i_symbol, std::size_t i_length) const
+        {
+            return length == static_cast<int>(i_length) && memcmp(symbol, i_symbol, i_length) == 0;
+        }
+
+        /// Length of the key in symbol, or -1 for an unused entry
+        int length;
+        char symbol[kMaxSymbol];
+        dynamic_quantity result;
+    };
+
+    static dynamic_quantity run_parser(char const* i_begin, char const* i_end)
+    {
+        return dim::detail::unit_string_parser(i_begin, i_end).parse();
+    }
+
+    /// Resize (and empty) the cache if parse_cache_capacity() was called
+    void sync_capacity()
+    {
+        std::size_t capacity = g_parse_cache_capacity.load(std::memory_order_relaxed);
+        if (capacity != m_capacity) {
+            m_capacity = capacity;
+            clear();
+        }
+    }
+
+    std::size_t m_capacity;
+    std::size_t m_hits;
+    std::size_t m_misses;
+    std::vector<entry> m_entries;
+    std::vector<uint8_t> m_victim;
+};
+
+parse_cache& local_parse_cache()
+{
+    thread_local parse_cache s_cache;
+    return s_cache;
+}
+
+} // namespace
+
+void parse_cache_capacity(std::size_t i_entries)
+{
+    std::size_t capacity = 0;
+    if (i_entries > 0) {
+        capacity = 2;
+        while (capacity < i_entries) {
+            capacity *= 2;
+        }
+    }
+    g_parse_cache_capacity.store(capacity, std::memory_order_relaxed);
+}
+
+parse_cache_stats parse_cache_statistics()
+{
+    parse_cache& cache = local_parse_cache();
+    parse_cache_stats stats = cache.statistics();
+    stats.capacity = g_parse_cache_capacity.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void parse_cache_clear() { local_parse_cache().clear(); }
+
+} // namespace si
+
 namespace detail {
 
 template <>
 ::dim::si::dynamic_quantity parse_standard_rep<double, si::system>(const char* i_unit_str, char const* i_end)
 {
-    dim::si::detail::quantity_parser_driver driver;
-    driver.parse(i_unit_str, i_end);
-    return driver.result;
+    return si::local_parse_cache().parse(i_unit_str, i_end);
 }
 }  // namespace detail
 }  // namespace dim
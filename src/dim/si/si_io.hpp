@@ -24,6 +24,44 @@ template <>::dim::si::dynamic_quantity parse_standard_rep<double, si::system>(ch
 
 } // namespace detail
 
+namespace si
+{
+
+/**
+ * @brief Statistics for the fallback parser cache.
+ *
+ * The cache is thread-local, so these counts describe the calling thread only.
+ */
+struct parse_cache_stats {
+    /// Number of parse_standard_rep() calls answered from the cache
+    std::size_t hits;
+    /// Number of parse_standard_rep() calls that ran the parser
+    std::size_t misses;
+    /// Number of entries the cache can hold (zero when disabled)
+    std::size_t capacity;
+};
+
+/**
+ * @brief Set the number of entries in the fallback parser cache.
+ *
+ * parse_standard_rep() remembers the result for recently parsed unit strings
+ * in a bounded, thread-local, two-way set-associative cache. The capacity is
+ * rounded up to a power of two and applies to every thread (each thread's
+ * cache is cleared the next time it is used). Pass zero to disable the cache.
+ */
+void parse_cache_capacity(std::size_t i_entries);
+
+/**
+ * @brief Obtain the cache statistics for the calling thread.
+ */
+parse_cache_stats parse_cache_statistics();
+
+/**
+ * @brief Empty the calling thread's cache and zero its statistics.
+ */
+void parse_cache_clear();
+
+} // namespace si
 
 template <> si::input_format_map const& get_default_format<si::Length>();
 template <> si::input_format_map const& get_default_format<si::Time>();
@@ -0,0 +1,451 @@
+#pragma once
+#include "definition.hpp"
+#include <climits>
+#include <type_traits>
+
+namespace dim
+{
+namespace detail
+{
+
+/**
+ * @brief Hand-written parser for SI unit strings. Use parse_standard_rep() to
+ * access this functionality.
+ *
+ * This accepts the same language as parser/quantity.y:
+ * ```
+ * output   := <empty> | [MULTIPLY] group
+ * group    := term { (MULTIPLY | '/') term }
+ * term     := ('(' group ')' | unit) { '^' exponent }
+ * exponent := '(' exponent ')' | INTEGER
+ * unit     := [prefix] literal
+ * ```
+ * where MULTIPLY is any of '*', '_', '.', or ' ', and INTEGER has an optional
+ * sign. Multiplication and division are left associative with equal
+ * precedence, while '^' binds tightest.
+ *
+ * The parser keeps its state on a fixed-depth stack (nesting deeper than
+ * kMaxDepth is an error), does not allocate, and does not throw. Parsing stops
+ * at i_end or at the first nul character.
+ *
+ * With C++14 the parser is constexpr. Since std::pow() is not, setting Constant
+ * computes exponents by repeated squaring so the parser can run at compile
+ * time. Otherwise exponents use power(), matching the results of the Bison
+ * parser exactly.
+ */
+template <bool Constant>
+class basic_unit_string_parser
+{
+  public:
+    using dynamic_quantity = si::dynamic_quantity;
+    using dynamic_unit = si::dynamic_unit;
+
+    /// Maximum nesting depth of parentheses
+    static constexpr int kMaxDepth = 32;
+
+    constexpr basic_unit_string_parser(char const* i_begin, char const* i_end)
+        : m_cursor(i_begin),
+          m_end(i_end),
+          m_depth(0)
+    {
+    }
+
+    /**
+     * @brief Parse the text. Returns a bad_quantity() if the text isn't a unit string.
+     */
+    DIM_CONSTEXPR14 dynamic_quantity parse()
+    {
+        token t = peek();
+        if (t.kind == kEnd) {
+            return dynamic_quantity(1.0, dynamic_unit::dimensionless());
+        }
+        if (t.kind == kMultiply) {
+            advance(t);
+        }
+        dynamic_quantity result;
+        if (!parse_group(result) || peek().kind != kEnd) {
+            return dynamic_quantity::bad_quantity();
+        }
+        return result;
+    }
+
+  private:
+    enum token_kind { kEnd, kMultiply, kDivide, kPower, kOpen, kClose, kInteger, kBad, kChar };
+
+    struct token {
+        token_kind kind;
+        /// Character for kChar tokens (non-ASCII symbols are mapped to ASCII equivalents)
+        char symbol;
+        /// Value of kInteger tokens
+        int integer;
+        /// Location of the following token
+        char const* next;
+    };
+
+    /// Entry in the table of unit symbols
+    struct literal {
+        char const* symbol;
+        double scale;
+        int8_t dimension[8];
+    };
+
+    /// Longest run of symbol characters making up a unit (prefix plus three letters)
+    static constexpr int kMaxUnitLength = 4;
+
+    static constexpr token make_token(token_kind i_kind, char const* i_next, char i_symbol = '\0', int i_integer = 0)
+    {
+        return {i_kind, i_symbol, i_integer, i_next};
+    }
+
+    /// Read the token starting at i_cursor
+    DIM_CONSTEXPR14 token lex(char const* i_cursor) const
+    {
+        if (i_cursor >= m_end) {
+            return make_token(kEnd, i_cursor);
+        }
+        unsigned char c = static_cast<unsigned char>(*i_cursor);
+        switch (c) {
+        case '\0':
+            return make_token(kEnd, i_cursor);
+        case '.':
+        case '*':
+        case '_':
+        case ' ':
+            return make_token(kMultiply, i_cursor + 1);
+        case '/':
+            return make_token(kDivide, i_cursor + 1);
+        case '^':
+            return make_token(kPower, i_cursor + 1);
+        case '(':
+            return make_token(kOpen, i_cursor + 1);
+        case ')':
+            return make_token(kClose, i_cursor + 1);
+        case '-':
+        case '+':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9':
+            return lex_integer(i_cursor);
+        case 0xce:
+            // Greek capital omega and mu
+            if (i_cursor + 1 < m_end) {
+                switch (static_cast<unsigned char>(i_cursor[1])) {
+                case 0xa9:
+                    return make_token(kChar, i_cursor + 2, 'R');
+                case 0xbc:
+                    return make_token(kChar, i_cursor + 2, 'u');
+                default:
+                    break;
+                }
+            }
+            return make_token(kBad, i_cursor + 1);
+        case 0xe2:
+            // Kelvin sign and ohm sign
+            if (i_cursor + 2 < m_end && static_cast<unsigned char>(i_cursor[1]) == 0x84) {
+                switch (static_cast<unsigned char>(i_cursor[2])) {
+                case 0xaa:
+                    return make_token(kChar, i_cursor + 3, 'K');
+                case 0xa6:
+                    return make_token(kChar, i_cursor + 3, 'R');
+                default:
+                    break;
+                }
+            }
+            return make_token(kBad, i_cursor + 1);
+        default:
+            return make_token(kChar, i_cursor + 1, static_cast<char>(c));
+        }
+    }
+
+    /// Read a signed integer, saturating like strtol()
+    DIM_CONSTEXPR14 token lex_integer(char const* i_cursor) const
+    {
+        char const* cursor = i_cursor;
+        bool negative = false;
+        if (*cursor == '-' || *cursor == '+') {
+            negative = (*cursor == '-');
+            ++cursor;
+        }
+        char const* digits = cursor;
+        long value = 0;
+        for (; cursor < m_end && *cursor >= '0' && *cursor <= '9'; ++cursor) {
+            long digit = *cursor - '0';
+            if (negative) {
+                value = (value < (LONG_MIN + digit) / 10 ? LONG_MIN : value * 10 - digit);
+            } else {
+                value = (value > (LONG_MAX - digit) / 10 ? LONG_MAX : value * 10 + digit);
+            }
+        }
+        if (cursor == digits) {
+            return make_token(kBad, i_cursor + 1);
+        }
+        return make_token(kInteger, cursor, '\0', static_cast<int>(value));
+    }
+
+    DIM_CONSTEXPR14 token peek() const { return lex(m_cursor); }
+
+    DIM_CONSTEXPR14 void advance(token const& i_token) { m_cursor = i_token.next; }
+
+    DIM_CONSTEXPR14 bool parse_group(dynamic_quantity& o_result)
+    {
+        if (!parse_term(o_result)) {
+            return false;
+        }
+        for (;;) {
+            token t = peek();
+            if (t.kind != kMultiply && t.kind != kDivide) {
+                return true;
+            }
+            advance(t);
+            dynamic_quantity rhs;
+            if (!parse_term(rhs)) {
+                return false;
+            }
+            o_result = (t.kind == kMultiply ? multiply(o_result, rhs) : divide(o_result, rhs));
+        }
+    }
+
+    DIM_CONSTEXPR14 bool parse_term(dynamic_quantity& o_result)
+    {
+        token t = peek();
+        if (t.kind == kOpen) {
+            if (++m_depth > kMaxDepth) {
+                return false;
+            }
+            advance(t);
+            if (!parse_group(o_result) || !expect(kClose)) {
+                return false;
+            }
+            --m_depth;
+        } else if (!parse_unit(o_result)) {
+            return false;
+        }
+        for (t = peek(); t.kind == kPower; t = peek()) {
+            advance(t);
+            int exponent = 0;
+            if (!parse_exponent(exponent)) {
+                return false;
+            }
+            o_result = raise(o_result, exponent, std::integral_constant<bool, Constant>());
+        }
+        return true;
+    }
+
+    DIM_CONSTEXPR14 bool parse_exponent(int& o_exponent)
+    {
+        token t = peek();
+        if (t.kind == kInteger) {
+            advance(t);
+            o_exponent = t.integer;
+            return true;
+        }
+        if (t.kind != kOpen || ++m_depth > kMaxDepth) {
+            return false;
+        }
+        advance(t);
+        if (!parse_exponent(o_exponent) || !expect(kClose)) {
+            return false;
+        }
+        --m_depth;
+        return true;
+    }
+
+    /**
+     * A unit is a run of symbol characters that is either a unit literal or a
+     * prefix followed by a literal.
+     */
+    DIM_CONSTEXPR14 bool parse_unit(dynamic_quantity& o_result)
+    {
+        char run[kMaxUnitLength + 1] = {};
+        int length = 0;
+        for (token t = peek(); t.kind == kChar; t = peek()) {
+            if (length == kMaxUnitLength) {
+                return false;
+            }
+            run[length++] = t.symbol;
+            advance(t);
+        }
+        run[length] = '\0';
+        if (length == 0) {
+            return false;
+        }
+        std::size_t unit = find_literal(run);
+        if (unit != kNoLiteral) {
+            o_result = dynamic_quantity(kLiterals[unit].scale, make_unit(kLiterals[unit]));
+            return true;
+        }
+        double scale = prefix(run[0]);
+        unit = find_literal(run + 1);
+        if (scale == 0.0 || unit == kNoLiteral) {
+            return false;
+        }
+        o_result = scale * dynamic_quantity(kLiterals[unit].scale, make_unit(kLiterals[unit]));
+        return true;
+    }
+
+    DIM_CONSTEXPR14 bool expect(token_kind i_kind)
+    {
+        token t = peek();
+        if (t.kind != i_kind) {
+            return false;
+        }
+        advance(t);
+        return true;
+    }
+
+    /// Exponentiation as done by the Bison parser
+    static dynamic_quantity raise(dynamic_quantity const& i_base, int i_exponent, std::false_type)
+    {
+        return power(i_base, i_exponent);
+    }
+
+    /// Exponentiation by repeated squaring, usable in constant expressions
+    static DIM_CONSTEXPR14 dynamic_quantity raise(dynamic_quantity const& i_base, int i_exponent, std::true_type)
+    {
+        double base = (i_exponent < 0 ? 1.0 / i_base.value() : i_base.value());
+        unsigned count = (i_exponent < 0 ? 0u - static_cast<unsigned>(i_exponent) : static_cast<unsigned>(i_exponent));
+        double value = 1.0;
+        for (; count != 0; count >>= 1) {
+            if (count & 1u) {
+                value *= base;
+            }
+            base *= base;
+        }
+        return dynamic_quantity(value, pow(i_base.unit(), i_exponent));
+    }
+
+    static constexpr dynamic_unit make_unit(literal const& i_literal)
+    {
+        int8_t const* d = i_literal.dimension;
+        return dynamic_unit(d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7]);
+    }
+
+    /// Magnitude of an SI prefix, or zero if c isn't a prefix
+    static DIM_CONSTEXPR14 double prefix(char c)
+    {
+        switch (c) {
+        case 'y': return 1e-24;
+        case 'z': return 1e-21;
+        case 'a': return 1e-18;
+        case 'f': return 1e-15;
+        case 'p': return 1e-12;
+        case 'n': return 1e-9;
+        case 'u': return 1e-6;
+        case 'm': return 1e-3;
+        case 'c': return 1e-2;
+        case 'd': return 1e-1;
+        case 'Y': return 1e24;
+        case 'Z': return 1e21;
+        case 'E': return 1e18;
+        case 'P': return 1e15;
+        case 'T': return 1e12;
+        case 'G': return 1e9;
+        case 'M': return 1e6;
+        case 'k': return 1e3;
+        case 'h': return 1e2;
+        default: return 0.0;
+        }
+    }
+
+    /// Returned by find_literal() for a symbol that is not a unit literal
+    static constexpr std::size_t kNoLiteral = static_cast<std::size_t>(-1);
+
+    /**
+     * Index in kLiterals of the unit literal exactly matching i_symbol, or
+     * kNoLiteral. An index rather than a pointer, since GCC with
+     * -fsanitize=undefined does not fold null tests of pointers into
+     * kLiterals in constant expressions.
+     */
+    static DIM_CONSTEXPR14 std::size_t find_literal(char const* i_symbol)
+    {
+        for (std::size_t i = 0; i < sizeof(kLiterals) / sizeof(kLiterals[0]); ++i) {
+            char const* a = kLiterals[i].symbol;
+            char const* b = i_symbol;
+            while (*a && *a == *b) {
+                ++a;
+                ++b;
+            }
+            if (*a == *b) {
+                return i;
+            }
+        }
+        return kNoLiteral;
+    }
+
+    static constexpr literal kLiterals[] = {
+        // clang-format off
+        {"m",   1e0,  { 1,  0,  0,  0,  0,  0,  0,  0}},
+        {"s",   1e0,  { 0,  1,  0,  0,  0,  0,  0,  0}},
+        {"g",   1e-3, { 0,  0,  1,  0,  0,  0,  0,  0}},
+        {"rad", 1e0,  { 0,  0,  0,  1,  0,  0,  0,  0}},
+        {"K",   1e0,  { 0,  0,  0,  0,  1,  0,  0,  0}},
+        {"mol", 1e0,  { 0,  0,  0,  0,  0,  1,  0,  0}},
+        {"A",   1e0,  { 0,  0,  0,  0,  0,  0,  1,  0}},
+        {"cd",  1e0,  { 0,  0,  0,  0,  0,  0,  0,  1}},
+        {"Hz",  1e0,  { 0, -1,  0,  0,  0,  0,  0,  0}},
+        {"sr",  1e0,  { 0,  0,  0,  2,  0,  0,  0,  0}},
+        {"N",   1e0,  { 1, -2,  1,  0,  0,  0,  0,  0}},
+        {"Pa",  1e0,  {-1, -2,  1,  0,  0,  0,  0,  0}},
+        {"J",   1e0,  { 2, -2,  1,  0,  0,  0,  0,  0}},
+        {"W",   1e0,  { 2, -3,  1,  0,  0,  0,  0,  0}},
+        {"C",   1e0,  { 0,  1,  0,  0,  0,  0,  1,  0}},
+        {"V",   1e0,  { 2, -3,  1,  0,  0,  0, -1,  0}},
+        {"F",   1e0,  {-2,  4, -1,  0,  0,  0,  2,  0}},
+        {"R",   1e0,  { 2, -3,  1,  0,  0,  0, -2,  0}},
+        {"S",   1e0,  {-2,  3, -1,  0,  0,  0,  2,  0}},
+        {"Wb",  1e0,  { 2, -2,  1,  0,  0,  0, -1,  0}},
+        {"T",   1e0,  { 0, -2,  1,  0,  0,  0, -1,  0}},
+        {"H",   1e0,  { 2, -2,  1,  0,  0,  0, -2,  0}},
+        {"Im",  1e0,  { 0,  0,  0,  2,  0,  0,  0,  1}},
+        {"Ix",  1e0,  {-2,  0,  0,  2,  0,  0,  0,  1}},
+        {"Bq",  1e0,  { 0, -1,  0,  0,  0,  0,  0,  0}},
+        {"Gy",  1e0,  { 2, -2,  0,  0,  0,  0,  0,  0}},
+        {"Sv",  1e0,  { 2, -2,  0,  0,  0,  0,  0,  0}},
+        {"kat", 1e0,  { 0, -1,  0,  0,  0,  1,  0,  0}},
+        {"L",   1e-3, { 3,  0,  0,  0,  0,  0,  0,  0}},
+        {"bar", 1e5,  {-1, -2,  1,  0,  0,  0,  0,  0}},
+        {"eV",  1.60218e-19, {2, -2, 1, 0, 0, 0, 0, 0}}
+        // clang-format on
+    };
+
+    char const* m_cursor;
+    char const* m_end;
+    int m_depth;
+};
+
+template <bool Constant>
+constexpr int basic_unit_string_parser<Constant>::kMaxDepth;
+
+template <bool Constant>
+constexpr typename basic_unit_string_parser<Constant>::literal basic_unit_string_parser<Constant>::kLiterals[];
+
+template <bool Constant>
+constexpr std::size_t basic_unit_string_parser<Constant>::kNoLiteral;
+
+/// The parser used by parse_standard_rep()
+using unit_string_parser = basic_unit_string_parser<false>;
+
+/// Length of a nul-terminated string
+constexpr std::size_t string_length(char const* i_text)
+{
+    return *i_text ? 1 + string_length(i_text + 1) : 0;
+}
+
+#if __cplusplus >= 201402L
+/// Parse a string at compile time. Text must have a static constexpr str() member.
+template <class Text>
+constexpr si::dynamic_quantity parse_constant()
+{
+    return basic_unit_string_parser<true>(Text::str(), Text::str() + string_length(Text::str())).parse();
+}
+#endif
+
+} // namespace detail
+} // namespace dim
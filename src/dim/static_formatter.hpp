@@ -0,0 +1,110 @@
+#pragma once
+#include "io.hpp"
+
+namespace dim
+{
+
+namespace detail
+{
+
+/// Format::offset() if Format has one
+template <class Format, class Q> constexpr auto static_format_offset(int) -> decltype(Format::offset())
+{
+    return Format::offset();
+}
+
+/// Otherwise a zero offset
+template <class Format, class Q> constexpr Q static_format_offset(long) { return Q(0); }
+
+/// True if i_symbol fits in i_room characters, including the terminating nul
+constexpr bool static_symbol_fits(char const* i_symbol, int i_room)
+{
+    return *i_symbol == '\0' || (i_room > 1 && static_symbol_fits(i_symbol + 1, i_room - 1));
+}
+
+} // namespace detail
+
+/**
+ * @brief A formatter for one quantity type, fixed at compile time.
+ *
+ * Where formatter checks the unit of every value at run time,
+ * static_formatter<Q, Format> only accepts Q, and its transform is a set of
+ * compile-time constants, so input() is a multiply and an add and non_dim() a
+ * subtract and a divide.
+ * Format is a type with constexpr static members giving the symbol, the scale
+ * from the symbol's units to Q, and optionally an offset:
+ * ```
+ * struct knots {
+ *     static constexpr char const* symbol() { return "kt"; }
+ *     static constexpr si::Speed scale() { return si::knot; }
+ * };
+ * using knot_format = dim::static_formatter<si::Speed, knots>;
+ *
+ * double logged = knot_format::non_dim(speed);
+ * si::Speed speed = knot_format::input(12.0);
+ * facet->output_formatter(knot_format()); // Also usable as a dynamic formatter
+ * ```
+ * non_dim() rounds exactly as the equivalent formatter's. input() and the
+ * formatter's do too, unless the compiler fuses the multiply and add of one
+ * of them.
+ */
+template <class Q, class Format>
+class static_formatter
+{
+  public:
+    using quantity_type = Q;
+    using scalar = typename Q::scalar;
+    using system = typename Q::system;
+    using formatted = formatted_quantity<scalar>;
+    using formatter_type = formatter<scalar, system>;
+
+    static_assert(std::is_base_of<quantity_tag, Q>::value, "static_formatter requires a quantity type");
+    static_assert(std::is_same<decltype(Format::scale()), Q>::value, "Format::scale() must return Q");
+    static_assert(detail::static_symbol_fits(Format::symbol(), kMaxSymbol), "Format::symbol() is too long");
+
+    /// The scale of the affine transform from the symbol's units to Q
+    static constexpr scalar kScale = dimensionless_cast(Format::scale());
+    /// The additive part of the affine transform from the symbol's units to Q
+    static constexpr scalar kOffset = dimensionless_cast(Q(detail::static_format_offset<Format, Q>(0)));
+
+    static constexpr char const* symbol() { return Format::symbol(); }
+    static constexpr Q scale() { return Q(kScale); }
+    static constexpr Q offset() { return Q(kOffset); }
+
+    /// Measure q in the symbol's units
+    static constexpr scalar non_dim(Q const& q) { return (dimensionless_cast(q) - kOffset) / kScale; }
+
+    /// Format q as a value in the symbol's units and the symbol
+    static formatted output(Q const& q) { return formatted(non_dim(q), symbol()); }
+
+    /// Transform a value in the symbol's units into a quantity
+    static constexpr Q input(scalar const& s) { return Q(s * kScale + kOffset); }
+
+    /// Transform i_count values in the symbol's units into quantities, like input() for each one (up to fusing, as
+    /// for formatter::input())
+    static void input(scalar const* i_values, Q* o_values, std::size_t i_count)
+    {
+        static_assert(sizeof(Q) == sizeof(scalar), "Quantities must be laid out as bare scalars");
+        detail::affine_transform(i_values, reinterpret_cast<scalar*>(o_values), i_count, scalar(0), kScale, kOffset);
+    }
+
+    /// Measure i_count quantities in the symbol's units, like non_dim() for each one
+    static void non_dim(Q const* i_values, scalar* o_values, std::size_t i_count)
+    {
+        static_assert(sizeof(Q) == sizeof(scalar), "Quantities must be laid out as bare scalars");
+        detail::affine_divide(reinterpret_cast<scalar const*>(i_values), o_values, i_count, -kOffset, kScale,
+                              scalar(0));
+    }
+
+    /// The same transform as a (type-erased) formatter, e.g. for an output_format_map or quantity_facet
+    static formatter_type dynamic() { return formatter_type(symbol(), scale(), offset()); }
+
+    operator formatter_type() const { return dynamic(); }
+};
+
+template <class Q, class Format>
+constexpr typename static_formatter<Q, Format>::scalar static_formatter<Q, Format>::kScale;
+template <class Q, class Format>
+constexpr typename static_formatter<Q, Format>::scalar static_formatter<Q, Format>::kOffset;
+
+} // namespace dim
@@ -0,0 +1,167 @@
+#pragma once
+#include "dynamic_quantity.hpp"
+
+/**
+ * Conversion between systems of units.
+ *
+ * Quantities of different systems (say si::system and a CGS system made with
+ * system_creation_helper.hpp) cannot be mixed; DIM_CHECK_SYSTEMS rejects them.
+ * Declaring how the base units of two systems relate lets system_cast convert
+ * between them:
+ * ```
+ * // One centimeter is 0.01 meters, one gram 0.001 kilograms
+ * DIM_DEFINE_SYSTEM_CONVERSION(cgs::system, dim::si::system, 0.01, 1.0, 0.001, 1.0, 1.0, 1.0, 1.0, 1.0)
+ *
+ * cgs::Force f = 5.0 * cgs::dyne;
+ * si::Force g = dim::system_cast<si::system>(f); // 5e-5 N
+ * ```
+ * The factor for a unit is the product of the base factors raised to the
+ * unit's exponents. For static quantities it is a compile-time constant, so
+ * system_cast is a single multiply; for dynamic quantities it is computed from
+ * the unit code.
+ *
+ * Only scale factors are supported, so the systems must agree on the zero of
+ * each base dimension (e.g. Kelvin and Rankine, but not Kelvin and Celsius).
+ */
+
+namespace dim
+{
+
+/**
+ * @brief How the base units of From relate to those of To.
+ *
+ * Specializations have a member `static constexpr double scale(int i_dimension)`
+ * giving the measure, in To's base unit, of one of From's base units for each
+ * dimension in base_dimension order. DIM_DEFINE_SYSTEM_CONVERSION declares both
+ * directions at once. There is no conversion unless one is declared.
+ */
+template <class From, class To> struct system_conversion;
+
+/// Every system converts to itself unchanged
+template <class System> struct system_conversion<System, System> {
+    static constexpr double scale(int) { return 1.0; }
+};
+
+namespace detail
+{
+
+/// i_base raised to the integer power i_exponent
+constexpr double conversion_pow(double i_base, int i_exponent)
+{
+    return i_exponent < 0    ? 1.0 / conversion_pow(i_base, -i_exponent)
+           : i_exponent == 0 ? 1.0
+           : i_exponent % 2  ? i_base * conversion_pow(i_base * i_base, i_exponent / 2)
+                             : conversion_pow(i_base * i_base, i_exponent / 2);
+}
+
+/// Conversion::scale(i) raised to each exponent of i_code from lane i on, multiplied together
+template <class Conversion> constexpr double conversion_factor(uint64_t i_code, unsigned i = 0)
+{
+    return i == 8 || (i_code >> (8 * i)) == 0
+               ? 1.0
+               : conversion_pow(Conversion::scale(static_cast<int>(i)), lane(i_code, i)) *
+                     conversion_factor<Conversion>(i_code, i + 1);
+}
+
+} // namespace detail
+
+/// The unit type with the same dimensions as U in the system To
+template <class U, class To>
+using system_unit_t = unit<U::length(), U::time(), U::mass(), U::angle(), U::temperature(), U::amount(), U::current(),
+                           U::luminosity(), To>;
+
+/**
+ * @brief The measure, in the system To, of a quantity of one unit U.
+ *
+ * For example, with a CGS system, system_factor<cgs::Force::unit, si::system>()
+ * is 1e-5: a dyne is 1e-5 newtons.
+ */
+template <class U, class To, DIM_IS_UNIT(U)> constexpr double system_factor()
+{
+    return detail::conversion_factor<system_conversion<typename U::system, To>>(index<U>().raw());
+}
+
+/// The measure, in the system To, of a quantity of one dynamic unit i_unit
+template <class To, class From> constexpr double system_factor(dynamic_unit<From> const& i_unit)
+{
+    return detail::conversion_factor<system_conversion<From, To>>(i_unit.raw());
+}
+
+namespace detail
+{
+/// system_factor<U, To>() as a constant, so it is never computed at run time
+template <class U, class To> struct system_factor_constant {
+    static constexpr double value = system_factor<U, To>();
+};
+template <class U, class To> constexpr double system_factor_constant<U, To>::value;
+} // namespace detail
+
+/**
+ * @brief Convert a quantity to the same quantity in the system To.
+ *
+ * The factor is computed at compile time, so this is a single multiply.
+ */
+template <class To, class Q, DIM_IS_QUANTITY(Q)>
+constexpr quantity<system_unit_t<typename Q::unit, To>, typename Q::scalar> system_cast(Q const& i_q)
+{
+    using result = quantity<system_unit_t<typename Q::unit, To>, typename Q::scalar>;
+    return result(dimensionless_cast(i_q) *
+                  static_cast<typename Q::scalar>(detail::system_factor_constant<typename Q::unit, To>::value));
+}
+
+/**
+ * @brief Convert a dynamic quantity to the same quantity in the system To.
+ *
+ * The unit code is unchanged; the factor is computed from it at run time. Bad
+ * quantities stay bad.
+ */
+template <class To, class S, class From>
+dynamic_quantity<S, To> system_cast(dynamic_quantity<S, From> const& i_q)
+{
+    if (i_q.is_bad()) {
+        return dynamic_quantity<S, To>::bad_quantity();
+    }
+    return dynamic_quantity<S, To>(i_q.value() * static_cast<S>(system_factor<To>(i_q.unit())),
+                                   dynamic_unit<To>(i_q.unit().raw()));
+}
+
+} // namespace dim
+
+/**
+ * DIM_DEFINE_SYSTEM_CONVERSION -- declare the conversion between two systems.
+ *
+ * Use at global scope.
+ *
+ * INPUT:
+ * 	From, To -- the systems (e.g. "cgs::system", "dim::si::system")
+ * 	L, T, M, A, Te, Mol, Cur, Lum -- the measure, in To's base unit, of one of
+ * 	    From's base units for the length, time, mass, angle, temperature, molar
+ * 	    amount, electric current and luminosity dimensions
+ *
+ * OUTPUT:
+ *   Specializes dim::system_conversion<From, To> and, with the reciprocal
+ *   factors, dim::system_conversion<To, From>
+ */
+#define DIM_DEFINE_SYSTEM_CONVERSION(From, To, L, T, M, A, Te, Mol, Cur, Lum)                                          \
+    namespace dim                                                                                                      \
+    {                                                                                                                  \
+    template <> struct system_conversion<From, To> {                                                                   \
+        static constexpr double scale(int i_dimension)                                                                 \
+        {                                                                                                              \
+            return i_dimension == 0   ? (L)                                                                            \
+                   : i_dimension == 1 ? (T)                                                                            \
+                   : i_dimension == 2 ? (M)                                                                            \
+                   : i_dimension == 3 ? (A)                                                                            \
+                   : i_dimension == 4 ? (Te)                                                                           \
+                   : i_dimension == 5 ? (Mol)                                                                          \
+                   : i_dimension == 6 ? (Cur)                                                                          \
+                                      : (Lum);                                                                         \
+        }                                                                                                              \
+    };                                                                                                                 \
+    template <> struct system_conversion<To, From> {                                                                   \
+        static constexpr double scale(int i_dimension)                                                                 \
+        {                                                                                                              \
+            return 1.0 / system_conversion<From, To>::scale(i_dimension);                                              \
+        }                                                                                                              \
+    };                                                                                                                 \
+    }
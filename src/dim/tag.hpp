@@ -14,6 +14,20 @@ using enable_if_t = typename ::std::enable_if<B,T>::type;
 }
 #endif
 
+/// Mark functions that can only be constexpr with relaxed (C++14) constexpr rules
+#if __cplusplus >= 201402L
+#define DIM_CONSTEXPR14 constexpr
+#else
+#define DIM_CONSTEXPR14
+#endif
+
+/// Mark a pointer that nothing else in scope aliases, so loops through it vectorize without overlap checks
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define DIM_RESTRICT __restrict
+#else
+#define DIM_RESTRICT
+#endif
+
 namespace dim
 {
 
@@ -32,6 +46,9 @@ struct dynamic_quantity_tag {};
 /// Tag type for systems
 struct system_tag {};
 
+/// Tag type for quantity_array and quantity_span
+struct quantity_array_tag {};
+
 
 
 // SFINAE macros that can be used as template parameters
@@ -54,6 +71,9 @@ struct system_tag {};
 /// Use as a template parameter to check if T is a system
 #define DIM_IS_SYSTEM(T) DIM_IS_TAGGED_FOR(::dim::system_tag, T)
 
+/// Use as a template parameter to check if A is a quantity_array or quantity_span
+#define DIM_IS_QUANTITY_ARRAY(A) DIM_IS_TAGGED_FOR(::dim::quantity_array_tag, A)
+
 /// Check if S is a scalar type (float, double, etc)
 #define DIM_IS_SCALAR(S) typename std::enable_if_t<std::is_arithmetic<S>::value>* = nullptr
 
@@ -1,11 +1,111 @@
 #pragma once
 #include "tag.hpp"
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 
 namespace dim
 {
 
+namespace detail
+{
+/*
+ * SWAR (SIMD within a register) arithmetic on dynamic_unit codes. A code packs
+ * eight int8_t exponents, one per byte, so one 64-bit add handles all eight
+ * once the sign bit of each lane is kept from carrying into the next lane.
+ */
+
+/// The sign bit of every byte lane
+constexpr uint64_t kLaneSigns = 0x8080808080808080ull;
+/// The low bit of every byte lane
+constexpr uint64_t kLaneOnes = 0x0101010101010101ull;
+/// The code of dynamic_unit::bad_unit()
+constexpr uint64_t kBadUnitCode = ~uint64_t(0);
+
+/// Lane-wise a + b, wrapping within each lane
+constexpr uint64_t lane_add(uint64_t a, uint64_t b)
+{
+    return ((a & ~kLaneSigns) + (b & ~kLaneSigns)) ^ ((a ^ b) & kLaneSigns);
+}
+
+/// Lane-wise a - b, wrapping within each lane
+constexpr uint64_t lane_sub(uint64_t a, uint64_t b)
+{
+    return ((a | kLaneSigns) - (b & ~kLaneSigns)) ^ ((a ^ ~b) & kLaneSigns);
+}
+
+/// Sign bits of the lanes where a + b wrapped: the operands share a sign the sum lacks
+constexpr uint64_t add_overflow(uint64_t a, uint64_t b, uint64_t sum) { return ~(a ^ b) & (a ^ sum) & kLaneSigns; }
+
+/// Sign bits of the lanes where a - b wrapped: the operand signs differ and the difference lacks a's
+constexpr uint64_t sub_overflow(uint64_t a, uint64_t b, uint64_t diff) { return (a ^ b) & (a ^ diff) & kLaneSigns; }
+
+/// Pass on a result unless a lane overflowed or an operand was bad
+constexpr uint64_t checked_code(uint64_t a, uint64_t b, uint64_t i_result, uint64_t i_overflow)
+{
+    return (i_overflow != 0 || a == kBadUnitCode || b == kBadUnitCode) ? kBadUnitCode : i_result;
+}
+
+/// Exponents of the product of two units
+constexpr uint64_t unit_product(uint64_t a, uint64_t b)
+{
+    return checked_code(a, b, lane_add(a, b), add_overflow(a, b, lane_add(a, b)));
+}
+
+/// Exponents of the quotient of two units
+constexpr uint64_t unit_quotient(uint64_t a, uint64_t b)
+{
+    return checked_code(a, b, lane_sub(a, b), sub_overflow(a, b, lane_sub(a, b)));
+}
+
+/**
+ * Exponents of a unit to the n'th power for n >= 0, by adding the doubled
+ * codes that match the set bits of n. Every partial sum lies between zero and
+ * the final exponents, so a lane only overflows when the answer does.
+ */
+constexpr uint64_t unit_power(uint64_t i_result, uint64_t i_base, uint32_t n)
+{
+    return n == 0 ? i_result
+                  : unit_power((n & 1) ? unit_product(i_result, i_base) : i_result,
+                               (n >> 1) ? unit_product(i_base, i_base) : i_base, n >> 1);
+}
+
+/// Exponents of a unit to the n'th power. Negative powers start from the inverse.
+constexpr uint64_t unit_power(uint64_t i_code, int n)
+{
+    return i_code == kBadUnitCode ? kBadUnitCode
+           : n < 0 ? unit_power(0, unit_quotient(0, i_code), 0u - static_cast<uint32_t>(n))
+                   : unit_power(0, i_code, static_cast<uint32_t>(n));
+}
+
+/// The exponent in byte lane i of a code
+constexpr int8_t lane(uint64_t i_code, unsigned i) { return static_cast<int8_t>(static_cast<uint8_t>(i_code >> (8 * i))); }
+
+/// Lane-wise arithmetic shift right by one, halving every exponent
+constexpr uint64_t lane_halve(uint64_t a) { return ((a >> 1) & ~kLaneSigns) | (a & kLaneSigns); }
+
+/// Divide the exponents from lane i on by n, or give kBadUnitCode if one is not a multiple of n
+constexpr uint64_t unit_root(uint64_t i_code, int n, unsigned i, uint64_t i_result)
+{
+    return i == 8 ? i_result
+           : lane(i_code, i) % n != 0
+               ? kBadUnitCode
+               : unit_root(i_code, n, i + 1,
+                           i_result | (static_cast<uint64_t>(static_cast<uint8_t>(lane(i_code, i) / n)) << (8 * i)));
+}
+
+/// Exponents of the n'th root of a unit. Square roots test and halve all lanes at once.
+constexpr uint64_t unit_root(uint64_t i_code, int n)
+{
+    return (i_code == kBadUnitCode || n == 0) ? kBadUnitCode
+           : n == 1                           ? i_code
+           : n == -1                          ? unit_quotient(0, i_code)
+           : n == 2                           ? ((i_code & kLaneOnes) != 0 ? kBadUnitCode : lane_halve(i_code))
+                                              : unit_root(i_code, n, 0, 0);
+}
+} // namespace detail
+
 // Forward declare the dynamic_unit/index type
 template <class System> class dynamic_unit;
 
@@ -132,23 +232,22 @@ template <class System> class dynamic_unit : public dynamic_unit_tag
 
     /**
      * @brief Compute the product of two units.
+     *
+     * The exponents are added lane by lane in the packed code. If one leaves the
+     * int8_t range, or either unit is bad, the result is bad_unit().
      */
-    // clang-format off
     constexpr dynamic_unit multiply(dynamic_unit const& i_other) const
-    {        
-        // Work byte by byte to avoid overflow into neighboring dimensions
-        return dynamic_unit{
-            scast(get_byte(Length) + i_other.get_byte(Length), Length)
-            | scast(get_byte(Time) + i_other.get_byte(Time), Time)
-            | scast(get_byte(Mass) + i_other.get_byte(Mass), Mass)
-            | scast(get_byte(Angle) + i_other.get_byte(Angle), Angle)
-            | scast(get_byte(Temperature) + i_other.get_byte(Temperature), Temperature)
-            | scast(get_byte(Amount) + i_other.get_byte(Amount), Amount)
-            | scast(get_byte(Current) + i_other.get_byte(Current), Current)
-            | scast(get_byte(Luminosity) + i_other.get_byte(Luminosity), Luminosity)
-        };        
+    {
+        return dynamic_unit(detail::unit_product(m_code, i_other.m_code));
+    }
+
+    /**
+     * @brief Compute the quotient of two units, checked like multiply().
+     */
+    constexpr dynamic_unit divide(dynamic_unit const& i_other) const
+    {
+        return dynamic_unit(detail::unit_quotient(m_code, i_other.m_code));
     }
-    // clang-format on
 
     /**
      * @brief  Number of distinct dimensions.
@@ -176,6 +275,30 @@ template <class System> class dynamic_unit : public dynamic_unit_tag
     uint64_t m_code;
 };
 
+namespace detail
+{
+/**
+ * Hash a dynamic_unit code. Each byte of a code is a small exponent, so the
+ * bits are spread with a multiply before folding the high half into the low
+ * half, where hash tables take their slot.
+ */
+constexpr uint64_t unit_hash(uint64_t i_code)
+{
+    return (i_code * 0x9e3779b97f4a7c15ull) ^ ((i_code * 0x9e3779b97f4a7c15ull) >> 32);
+}
+} // namespace detail
+
+/**
+ * @brief Units that unit_intern_table<System> gives the fixed IDs 1, 2, ...,
+ * count(), so common units have the same compact ID in every program. (ID 0
+ * is always dimensionless.) A system specializes this with get(i) and count();
+ * by default nothing is seeded.
+ */
+template <class System> struct interned_units {
+    static constexpr std::size_t count() { return 0; }
+    static constexpr dynamic_unit<System> get(std::size_t) { return dynamic_unit<System>::bad_unit(); }
+};
+
 /**
  * Conversion methods
  */
@@ -311,35 +434,34 @@ constexpr unit_divide_t<U1, U2> operator/(U1 const&, U2 const&)
 /// unit/unit power function
 template <class U, int P, DIM_IS_UNIT(U)> constexpr unit_pow_t<U, P> pow(U const&) { return unit_pow_t<U, P>(); }
 
-/// Compute the inverse of a dynamic unit
+/// Compute the inverse of a dynamic unit. Inverting an exponent of -128 gives bad_unit().
 template <class System> inline constexpr dynamic_unit<System> inverse(dynamic_unit<System> const& u)
 {
-    // clang-format off
-    return dynamic_unit<System>({
-        static_cast<int8_t>(-u.length()),
-        static_cast<int8_t>(-u.time()),
-        static_cast<int8_t>(-u.mass()),
-        static_cast<int8_t>(-u.angle()),
-        static_cast<int8_t>(-u.temperature()),
-        static_cast<int8_t>(-u.amount()),
-        static_cast<int8_t>(-u.current()),
-        static_cast<int8_t>(-u.luminosity())}
-    );
-    // clang-format on
+    return dynamic_unit<System>(detail::unit_quotient(0, u.raw()));
 }
 
+/// Raise a dynamic unit to a power, giving bad_unit() if an exponent leaves the int8_t range
 template <class System, DIM_IS_SYSTEM(System)> constexpr dynamic_unit<System> pow(dynamic_unit<System> i_unit, int n)
 {
-    return dynamic_unit<System>{
-        static_cast<int8_t>(n * i_unit.length()),
-        static_cast<int8_t>(n * i_unit.time()),
-        static_cast<int8_t>(n * i_unit.mass()),
-        static_cast<int8_t>(n * i_unit.angle()),
-        static_cast<int8_t>(n * i_unit.temperature()),
-        static_cast<int8_t>(n * i_unit.amount()),
-        static_cast<int8_t>(n * i_unit.current()),
-        static_cast<int8_t>(n * i_unit.luminosity())
-    };
+    return dynamic_unit<System>(detail::unit_power(i_unit.raw(), n));
 }
 
-} // namespace dim
\ No newline at end of file
+/// Take the n'th root of a dynamic unit, giving bad_unit() if an exponent is not a multiple of n
+template <class System, DIM_IS_SYSTEM(System)> constexpr dynamic_unit<System> root(dynamic_unit<System> i_unit, int n)
+{
+    return dynamic_unit<System>(detail::unit_root(i_unit.raw(), n));
+}
+
+} // namespace dim
+
+namespace std
+{
+/// Hash for dynamic_units, so that they can key unordered containers
+template <class System>
+struct hash<::dim::dynamic_unit<System>> {
+    std::size_t operator()(::dim::dynamic_unit<System> const& i_unit) const noexcept
+    {
+        return static_cast<std::size_t>(::dim::detail::unit_hash(i_unit.raw()));
+    }
+};
+} // namespace std
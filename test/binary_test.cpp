@@ -0,0 +1,127 @@
+#include <cstring>
+#include <vector>
+#include "dim/binary.hpp"
+#include "dim/quantity_array.hpp"
+#include "dim/si.hpp"
+#include "doctest.h"
+
+using namespace dim::si;
+
+using writer = dim::binary_writer<double, si::system>;
+using reader = dim::binary_reader<double, si::system>;
+
+TEST_CASE("binary.static")
+{
+    std::vector<Length> lengths;
+    for (int i = 0; i < 1000; ++i) {
+        lengths.push_back(static_cast<double>(i) * 0.25 * meter);
+    }
+    dim::quantity_array<Time> times(3, 2.0 * second);
+
+    for (dim::byte_order order : {dim::byte_order::little, dim::byte_order::big}) {
+        std::vector<unsigned char> buffer;
+        writer out(buffer, order);
+        out.write(lengths);
+        out.write(times);
+        // One header and one block per write
+        CHECK(buffer.size() == 16 + 16 + 1000 * sizeof(double) + 16 + 3 * sizeof(double));
+        CHECK(buffer[5] == (order == dim::byte_order::big ? 1 : 0));
+
+        reader in(buffer.data(), buffer.size());
+        REQUIRE(in.ok());
+        std::vector<Length> head(600);
+        std::vector<Length> tail(400);
+        CHECK(in.read(head) == 600);
+        CHECK(in.read(tail.data(), 1000) == 400);
+        CHECK(head[599] == lengths[599]);
+        CHECK(tail[399] == lengths[999]);
+        Time time[3];
+        CHECK(in.read(time, 3) == 3);
+        CHECK(time[2] == 2.0 * second);
+        CHECK(in.at_end());
+        CHECK(in.read(time, 3) == 0);
+        CHECK(in.ok());
+    }
+
+    // Blocks of the same unit are read as one run
+    std::vector<unsigned char> buffer;
+    writer out(buffer);
+    out.write(lengths.data(), 2);
+    out.write(lengths.data() + 2, 2);
+    reader in(buffer.data(), buffer.size());
+    Length joined[4];
+    CHECK(in.read(joined, 4) == 4);
+    CHECK(joined[3] == lengths[3]);
+}
+
+TEST_CASE("binary.dynamic")
+{
+    std::vector<si::dynamic_quantity> values{5.0 * meter, 6.0 * meter, 1.0 * second, 7.0 * meter, 7.0 * meter,
+                                             7.0 * meter};
+    std::vector<unsigned char> buffer;
+    writer out(buffer, dim::byte_order::big);
+    out.write(values);
+    // A block per run of equal units
+    CHECK(buffer.size() == 16 + 3 * 16 + values.size() * sizeof(double));
+
+    reader in(buffer.data(), buffer.size());
+    std::vector<si::dynamic_quantity> decoded(values.size() + 1);
+    CHECK(in.read(decoded) == values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        CHECK(decoded[i] == values[i]);
+    }
+
+    // Static blocks read as dynamic quantities
+    buffer.clear();
+    writer statics(buffer);
+    Speed speed[2] = {1.0 * meter / second, 2.0 * meter / second};
+    statics.write(speed, 2);
+    reader mixed(buffer.data(), buffer.size());
+    si::dynamic_quantity dynamic_speed[2];
+    CHECK(mixed.read(dynamic_speed, 2) == 2);
+    CHECK(dynamic_speed[1] == si::dynamic_quantity(2.0 * meter / second));
+}
+
+TEST_CASE("binary.errors")
+{
+    std::vector<Length> lengths(10, 1.0 * meter);
+    std::vector<unsigned char> buffer;
+    writer out(buffer);
+    out.write(lengths);
+    std::vector<unsigned char> wrong_system = buffer;
+    wrong_system[8] ^= 1;
+    std::vector<unsigned char> newer = buffer;
+    newer[4] = dim::kBinaryVersion + 1;
+    std::vector<unsigned char> garbage = buffer;
+    garbage[0] = 'X';
+    Time times[10];
+    Length read_back[10];
+
+#ifdef DIM_EXCEPTIONS
+    CHECK_THROWS_AS(reader(buffer.data(), 10), std::runtime_error);
+    CHECK_THROWS_AS(reader(wrong_system.data(), wrong_system.size()), std::runtime_error);
+    CHECK_THROWS_AS(reader(newer.data(), newer.size()), std::runtime_error);
+    CHECK_THROWS_AS(reader(garbage.data(), garbage.size()), std::runtime_error);
+    CHECK_THROWS_AS((dim::binary_reader<float, si::system>(buffer.data(), buffer.size())), std::runtime_error);
+    reader wrong_unit(buffer.data(), buffer.size());
+    CHECK_THROWS_AS(wrong_unit.read(times, 10), dim::incommensurable_exception);
+    reader truncated(buffer.data(), buffer.size() - 1);
+    CHECK_THROWS_AS(truncated.read(read_back, 10), std::runtime_error);
+#else
+    CHECK(reader(buffer.data(), 10).error() == dim::binary_error::truncated);
+    CHECK(reader(wrong_system.data(), wrong_system.size()).error() == dim::binary_error::wrong_system);
+    CHECK(reader(newer.data(), newer.size()).error() == dim::binary_error::bad_version);
+    CHECK(reader(garbage.data(), garbage.size()).error() == dim::binary_error::bad_header);
+    CHECK(dim::binary_reader<float, si::system>(buffer.data(), buffer.size()).error() ==
+          dim::binary_error::wrong_scalar);
+
+    reader wrong_unit(buffer.data(), buffer.size());
+    CHECK(wrong_unit.read(times, 10) == 0);
+    CHECK(wrong_unit.error() == dim::binary_error::incommensurable);
+
+    reader truncated(buffer.data(), buffer.size() - 1);
+    CHECK(truncated.read(read_back, 10) == 0);
+    CHECK(truncated.error() == dim::binary_error::truncated);
+    CHECK(truncated.at_end());
+#endif
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "dim/column_store.hpp"
+#include "dim/si.hpp"
+#include "doctest.h"
+
+using namespace dim::si;
+
+namespace
+{
+/// A file in the working directory that is removed when the test ends
+struct scratch_file {
+    explicit scratch_file(char const* i_path)
+        : path(i_path)
+    {
+    }
+    ~scratch_file() { std::remove(path.c_str()); }
+    std::string path;
+};
+} // namespace
+
+TEST_CASE("column_store.round_trip")
+{
+    scratch_file file("column_store_test.dimc");
+    std::vector<Length> position;
+    dim::quantity_array<Time> time(1000);
+    for (std::size_t i = 0; i < 1000; ++i) {
+        position.push_back(static_cast<double>(i) * 0.5 * meter);
+        time[i] = static_cast<double>(i) * second;
+    }
+    std::vector<double> loads{1.0, 2.0, 3.0};
+
+    dim::column_writer<double, si::system> columns;
+    columns.add("position", position);
+    columns.add("time", time);
+    columns.add("load", dim::index<Force>(), loads.data(), loads.size());
+    columns.add("empty", std::vector<Speed>());
+    REQUIRE(columns.write(file.path.c_str()));
+
+    dim::column_store<double, si::system> store(file.path.c_str());
+    REQUIRE(store.is_open());
+    REQUIRE(store.columns() == 4);
+    CHECK(store.name(2) == "load");
+    CHECK(store.unit(1) == dim::index<Time>());
+    CHECK(store.size(0) == 1000);
+    CHECK(store.find("time") == 1);
+    CHECK(store.find("missing") == store.npos);
+
+    dim::quantity_span<Length const> read_position = store.column<Length>("position");
+    REQUIRE(read_position.size() == 1000);
+    CHECK(read_position[999] == position[999]);
+    CHECK(reinterpret_cast<std::uintptr_t>(read_position.data()) % 64 == 0);
+    CHECK(sum(store.column<Time>(1)) == sum(time));
+    CHECK(store.column<Speed>("empty").empty());
+
+    // Spans combine with arrays without copying the file
+    dim::quantity_array<Speed> speed = store.column<Length>("position") / (store.column<Time>("time") + 1.0 * second);
+    CHECK(speed[1] / (meter / second) == doctest::Approx(0.25));
+
+    auto load = store.dynamic("load");
+    REQUIRE(load.size() == 3);
+    CHECK(load[2] == si::dynamic_quantity(3.0 * newton));
+    CHECK(load.unit() == dim::index<Force>());
+    CHECK(store.dynamic("missing").empty());
+    CHECK(store.column<Length>("missing").empty());
+
+#ifdef DIM_EXCEPTIONS
+    CHECK_THROWS_AS(store.column<Time>("position"), dim::incommensurable_exception);
+#else
+    CHECK(store.column<Time>("position").empty());
+#endif
+
+    store.close();
+    CHECK_FALSE(store.is_open());
+}
+
+TEST_CASE("column_store.errors")
+{
+    scratch_file file("column_store_errors.dimc");
+    std::vector<Length> position(10, 1.0 * meter);
+    dim::column_writer<double, si::system> columns;
+    columns.add("position", position);
+    REQUIRE(columns.write(file.path.c_str()));
+
+    std::ifstream input(file.path.c_str(), std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+    auto rewrite = [&](std::string const& i_contents) {
+        std::ofstream output(file.path.c_str(), std::ios::binary | std::ios::trunc);
+        output.write(i_contents.data(), static_cast<std::streamsize>(i_contents.size()));
+    };
+
+    dim::column_store<double, si::system> store;
+    std::string other_order = contents;
+    other_order[5] ^= 1;
+    std::reverse(other_order.begin() + 8, other_order.begin() + 16);
+    std::string truncated = contents.substr(0, contents.size() - 8);
+
+#ifdef DIM_EXCEPTIONS
+    CHECK_THROWS_AS(store.open("no_such_file.dimc"), std::runtime_error);
+    CHECK_THROWS_AS((dim::column_store<float, si::system>(file.path.c_str())), std::runtime_error);
+    rewrite(other_order);
+    CHECK_THROWS_AS(store.open(file.path.c_str()), std::runtime_error);
+    rewrite(truncated);
+    CHECK_THROWS_AS(store.open(file.path.c_str()), std::runtime_error);
+#else
+    CHECK_FALSE(store.open("no_such_file.dimc"));
+    CHECK(store.error() == dim::binary_error::unreadable);
+    CHECK(dim::column_store<float, si::system>(file.path.c_str()).error() == dim::binary_error::wrong_scalar);
+    rewrite(other_order);
+    CHECK_FALSE(store.open(file.path.c_str()));
+    CHECK(store.error() == dim::binary_error::wrong_byte_order);
+    rewrite(truncated);
+    CHECK_FALSE(store.open(file.path.c_str()));
+    CHECK(store.error() == dim::binary_error::truncated);
+    CHECK(store.columns() == 0);
+#endif
+    rewrite(contents);
+    CHECK(store.open(file.path.c_str()));
+    CHECK(store.column<Length>(0).size() == 10);
+}
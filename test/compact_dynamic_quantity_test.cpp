@@ -0,0 +1,99 @@
+#include <set>
+#include <thread>
+#include <vector>
+#include "dim/compact_dynamic_quantity.hpp"
+#include "dim/si.hpp"
+#include "doctest.h"
+
+using namespace dim::si;
+
+using compact = dim::compact_dynamic_quantity<double, si::system>;
+using compact_float = dim::compact_dynamic_quantity<float, si::system>;
+using table = dim::unit_intern_table<si::system>;
+
+TEST_CASE("compact_dynamic_quantity.size")
+{
+    CHECK(sizeof(compact) == sizeof(double) + sizeof(uint16_t));
+    CHECK(sizeof(compact_float) == sizeof(float) + sizeof(uint16_t));
+    CHECK(sizeof(compact) < sizeof(si::dynamic_quantity));
+}
+
+TEST_CASE("compact_dynamic_quantity.seeded")
+{
+    using seeds = dim::interned_units<si::system>;
+    std::set<dim::si::dynamic_unit> distinct;
+    for (std::size_t i = 0; i < seeds::count(); ++i) {
+        distinct.insert(seeds::get(i));
+    }
+    REQUIRE(distinct.size() == seeds::count());
+    CHECK(distinct.count(dim::si::dynamic_unit::dimensionless()) == 0);
+
+    // Seeded units have the same IDs in every program
+    table& units = table::instance();
+    REQUIRE(units.size() >= seeds::count() + 1);
+    CHECK(units.find(dim::si::dynamic_unit::dimensionless()) == 0);
+    CHECK(units.find(dim::index<Length>()) == 1);
+    for (std::size_t i = 0; i < seeds::count(); ++i) {
+        CHECK(units.find(seeds::get(i)) == i + 1);
+        CHECK(units.unit(static_cast<table::id_type>(i + 1)) == seeds::get(i));
+    }
+    CHECK(units.find(dim::si::dynamic_unit::bad_unit()) == table::kBadId);
+    CHECK(units.unit(table::kBadId).is_bad());
+}
+
+TEST_CASE("compact_dynamic_quantity.conversion")
+{
+    si::dynamic_quantity speed(12.0 * meter / second);
+    compact packed = speed;
+    CHECK(packed.id() == table::instance().find(speed.unit()));
+    CHECK(packed.value() == 12.0);
+    si::dynamic_quantity unpacked = packed;
+    CHECK(unpacked == speed);
+
+    compact force = 3.0 * newton;
+    CHECK(force.unit() == dim::index<Force>());
+    CHECK(compact() == compact(si::dynamic_quantity(0.0)));
+    CHECK(compact_float(2.5 * meter).dynamic().value() == 2.5f);
+
+    // Units outside the seeded set are interned on first use
+    si::dynamic_unit odd(3, -5, 2, 0, 0, 1, 0, 0);
+    std::size_t before = table::instance().size();
+    compact first(1.0, odd);
+    compact second(2.0, odd);
+    CHECK(first.id() == second.id());
+    CHECK(first.id() >= dim::interned_units<si::system>::count() + 1);
+    CHECK(table::instance().size() <= before + 1);
+    CHECK(second.unit() == odd);
+
+    CHECK(compact::bad_quantity().is_bad());
+    CHECK(compact(1.0, si::dynamic_unit::bad_unit()).is_bad());
+    CHECK(compact::bad_quantity().unit().is_bad());
+
+    // Vectors of compact quantities are packed
+    std::vector<compact> store{speed, force, first};
+    CHECK(reinterpret_cast<char const*>(&store[2]) - reinterpret_cast<char const*>(&store[0]) == 2 * sizeof(compact));
+    CHECK(store[1].dynamic() == si::dynamic_quantity(3.0 * newton));
+}
+
+TEST_CASE("compact_dynamic_quantity.threads")
+{
+    // Threads interning overlapping sets of new units agree on their IDs
+    std::vector<std::vector<table::id_type>> ids(4);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < ids.size(); ++t) {
+        workers.emplace_back([t, &ids] {
+            for (int8_t i = 0; i < 100; ++i) {
+                ids[t].push_back(table::instance().intern(si::dynamic_unit(i, 7, -7, 1, 2, 3, 4, 5)));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (std::size_t t = 1; t < ids.size(); ++t) {
+        CHECK(ids[t] == ids[0]);
+    }
+    for (int8_t i = 0; i < 100; ++i) {
+        CHECK(table::instance().unit(ids[0][static_cast<std::size_t>(i)]) == si::dynamic_unit(i, 7, -7, 1, 2, 3, 4, 5));
+    }
+}
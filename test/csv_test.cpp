@@ -0,0 +1,100 @@
+#include <sstream>
+#include <string>
+#include <vector>
+#include "dim/csv.hpp"
+#include "dim/si.hpp"
+#include "dim/si/si_facet.hpp"
+#include "doctest.h"
+
+using namespace dim::si;
+using reader = dim::csv_reader<double, dim::si::system>;
+
+TEST_CASE("csv_reader.header_units")
+{
+    std::istringstream input("time, speed [mph],pressure_kPa,\"label, quoted\"\n"
+                             "1.5_s,10,14.7,a\r\n"
+                             "\n"
+                             "2_min,20,29.4,b\n"
+                             "3_s,30,,c");
+    reader csv(input);
+    REQUIRE(csv.read_header());
+    CHECK(csv.columns() == 4);
+    CHECK(csv.name(1) == "speed [mph]");
+    CHECK(csv.name(3) == "label, quoted");
+    CHECK(csv.symbol(0) == "");
+    CHECK(csv.symbol(1) == "mph");
+    CHECK(csv.symbol(2) == "kPa");
+
+    REQUIRE(csv.read_chunk() == 3);
+    Time times[3];
+    std::errc errors[3];
+    dim::parse_batch_result result = csv.column(0, times, errors);
+    CHECK(result.count == 3);
+    CHECK(result.failed == 0);
+    CHECK(times[0] == 1.5 * second);
+    CHECK(times[1] == 120.0 * second);
+
+    Speed speeds[3];
+    result = csv.column(1, speeds, errors);
+    CHECK(result.failed == 0);
+    CHECK(speeds[0] / (meter / second) == doctest::Approx(4.4704));
+    CHECK(speeds[2] / (meter / second) == doctest::Approx(13.4112));
+
+    Pressure pressures[3];
+    result = csv.column(2, pressures, errors);
+    CHECK(result.failed == 1);
+    CHECK(errors[2] == std::errc::invalid_argument);
+    CHECK(pressures[0] / pascal == doctest::Approx(14700.0));
+
+    // Wrong dimension for the column
+    result = csv.column(1, pressures, errors);
+    CHECK(result.failed == 3);
+
+    CHECK(csv.read_chunk() == 0);
+}
+
+TEST_CASE("csv_reader.chunks")
+{
+    // Small chunks force lines to span reads and the buffer to grow
+    std::string text = "force\tlength\n";
+    for (int i = 0; i < 200; ++i) {
+        text += std::to_string(i) + (i % 3 == 0 ? "_lbf" : "_N") + "\t" + std::to_string(i) + "_mm\n";
+    }
+    std::istringstream input(text);
+    reader csv(input, '\t', 7);
+    REQUIRE(csv.read_header());
+    CHECK(csv.columns() == 2);
+
+    si::input_format_map_group group;
+    group.insert(dim::get_default_format<Force>());
+    group.insert(dim::get_default_format<Length>());
+
+    int row = 0;
+    for (std::size_t rows = csv.read_chunk(); rows > 0; rows = csv.read_chunk()) {
+        std::vector<Force> forces(rows);
+        std::vector<si::dynamic_quantity> lengths(rows);
+        CHECK(csv.column(0, forces.data(), nullptr).failed == 0);
+        CHECK(csv.column(1, lengths.data(), nullptr, group).failed == 0);
+        for (std::size_t i = 0; i < rows; ++i, ++row) {
+            double scalar = row;
+            Force expected = (row % 3 == 0 ? scalar * pound_force : scalar * newton);
+            CHECK(forces[i] / newton == doctest::Approx(expected / newton));
+            CHECK(lengths[i].unit() == dim::index<Length>());
+            CHECK(lengths[i].value() == doctest::Approx(scalar * 0.001));
+        }
+    }
+    CHECK(row == 200);
+}
+
+TEST_CASE("csv_reader.no_header")
+{
+    std::istringstream input("1_m;2_m;3_m\n4_m;5_m\n");
+    reader csv(input, ';');
+    REQUIRE(csv.read_chunk() == 2);
+    CHECK(csv.columns() == 3);
+    Length values[2];
+    std::errc errors[2];
+    CHECK(csv.column(2, values, errors).failed == 1);
+    CHECK(values[0] == 3.0 * meter);
+    CHECK(values[1].is_bad());
+}
@@ -65,6 +65,73 @@ TEST_CASE("dynamic_unit.inverse")
     CHECK(result == si::dynamic_unit::dimensionless());
 }
 
+TEST_CASE("dynamic_unit.arithmetic")
+{
+    si::dynamic_unit unit{1,2,3,4, -1,-2,-3,-4};
+    si::dynamic_unit other{-5,7,0,100, -100,2,-3,1};
+
+    // Every lane agrees with its own int8_t arithmetic
+    auto product = unit.multiply(other);
+    auto quotient = unit.divide(other);
+    for (uint8_t i = 0; i < si::dynamic_unit::size(); ++i) {
+        CHECK(quotient.get(i) == unit.get(i) - other.get(i));
+    }
+    CHECK(product == si::dynamic_unit(-4,9,3,104, -101,0,-6,-3));
+    CHECK(quotient.multiply(other) == unit);
+    CHECK(pow(unit, 3) == si::dynamic_unit(3,6,9,12, -3,-6,-9,-12));
+    CHECK(pow(unit, -2) == si::dynamic_unit(-2,-4,-6,-8, 2,4,6,8));
+    CHECK(pow(unit, 0) == si::dynamic_unit::dimensionless());
+    CHECK(pow(si::dynamic_unit(0,-1,0,0, 0,0,0,0), 128) == si::dynamic_unit(0,-128,0,0, 0,0,0,0));
+    static_assert(si::dynamic_unit(1,2,0,0, 0,0,0,0).multiply(si::dynamic_unit(1,-2,0,0, 0,0,0,0))
+                      == si::dynamic_unit(2,0,0,0, 0,0,0,0), "constexpr multiply");
+
+    // Roots
+    CHECK(root(pow(unit, 2), 2) == unit);
+    CHECK(root(pow(unit, 3), 3) == unit);
+    CHECK(root(pow(unit, 3), -3) == inverse(unit));
+    CHECK(root(unit, 1) == unit);
+    CHECK(root(unit, 2).is_bad());
+    CHECK(root(unit, 0).is_bad());
+    CHECK(root(si::dynamic_unit(2,-4,0,0, 0,0,0,0), 2) == si::dynamic_unit(1,-2,0,0, 0,0,0,0));
+
+    // Exponents that leave the int8_t range give bad units instead of wrapping
+    si::dynamic_unit big{120,0,0,0, 0,0,0,0};
+    si::dynamic_unit small{-120,0,0,0, 0,0,0,0};
+    CHECK(big.multiply(big).is_bad());
+    CHECK(small.multiply(small).is_bad());
+    CHECK(big.divide(inverse(big)).is_bad());
+    CHECK(small.divide(big).is_bad());
+    CHECK(inverse(si::dynamic_unit(0,0,-128,0, 0,0,0,0)).is_bad());
+    CHECK(pow(big, 2).is_bad());
+    CHECK(pow(si::dynamic_unit(0,2,0,0, 0,0,0,0), 64).is_bad());
+    CHECK(pow(si::dynamic_unit(0,1,0,0, 0,0,0,0), -128) == si::dynamic_unit(0,-128,0,0, 0,0,0,0));
+    CHECK(pow(si::dynamic_unit(0,1,0,0, 0,0,0,0), 1 << 30).is_bad());
+
+    // Bad units stay bad
+    CHECK(si::dynamic_unit::bad_unit().multiply(si::dynamic_unit::dimensionless()).is_bad());
+    CHECK(pow(si::dynamic_unit::bad_unit(), 0).is_bad());
+    CHECK(root(si::dynamic_unit::bad_unit(), 1).is_bad());
+
+    // Dynamic quantities
+    si::dynamic_quantity area(16.0, si::dynamic_unit(2,0,0,0, 0,0,0,0));
+    si::dynamic_quantity side = root(area, 2);
+    CHECK(side.value() == doctest::Approx(4.0));
+    CHECK(side.unit() == si::dynamic_unit(1,0,0,0, 0,0,0,0));
+    CHECK(root(area, 3).is_bad());
+
+    // Odd roots of negative values are negative; even roots of them are bad
+    si::dynamic_quantity volume(-8.0, si::dynamic_unit(3,0,0,0, 0,0,0,0));
+    si::dynamic_quantity edge = root(volume, 3);
+    CHECK(edge.value() == -2.0);
+    CHECK(edge.unit() == si::dynamic_unit(1,0,0,0, 0,0,0,0));
+    si::dynamic_quantity inverse_edge = root(volume, -3);
+    CHECK(inverse_edge.value() == doctest::Approx(-0.5));
+    CHECK(inverse_edge.unit() == si::dynamic_unit(-1,0,0,0, 0,0,0,0));
+    si::dynamic_quantity fifth = root(si::dynamic_quantity(-32.0, si::dynamic_unit(5,0,0,0, 0,0,0,0)), 5);
+    CHECK(fifth.value() == doctest::Approx(-2.0));
+    CHECK(root(si::dynamic_quantity(-16.0, si::dynamic_unit(2,0,0,0, 0,0,0,0)), 2).is_bad());
+}
+
 TEST_CASE("dynamic_unit.setter") {
     // Setters
     si::dynamic_unit unit{1,2,3,4, -1,-2,-3,-4};
@@ -1,5 +1,6 @@
 #include "doctest.h"
 #include "dim/si.hpp"
+#include <string>
 
 TEST_CASE("facet")
 {
@@ -33,3 +34,52 @@ TEST_CASE("facet")
     q = std::use_facet<si::facet>(loc).format<si::Length>(si::formatted_quantity(2.0, "in"));
     CHECK(dimensionless_cast(q) == doctest::Approx(2.0 * si::inch / si::meter));
 }
+
+TEST_CASE("codec")
+{
+    si::facet* fac = si::system::make_default_facet();
+    fac->output_formatter("in", si::inch);
+    std::locale loc(std::locale::classic(), fac);
+    si::codec const codec(loc);
+    REQUIRE(codec.output_formats() == &fac->output_formats());
+
+    char buffer[32];
+    std::to_chars_result written = codec.to_chars(buffer, buffer + sizeof(buffer), 5.0 * si::inch);
+    REQUIRE(written.ec == std::errc{});
+    CHECK(std::string(buffer, written.ptr) == "5_in");
+    si::formatted_quantity fq = codec.format(si::dynamic_quantity(2.0 * si::inch));
+    CHECK(fq.value() == doctest::Approx(2.0));
+    CHECK(std::string(fq.symbol()) == "in");
+
+    si::Length length;
+    char const text[] = "2_in;";
+    CHECK(codec.parse(length, text, 4));
+    CHECK(length / si::inch == doctest::Approx(2.0));
+    std::from_chars_result read = codec.from_chars(text, text + 5, length);
+    CHECK(read.ec == std::errc{});
+    CHECK(read.ptr == text + 4);
+    CHECK_FALSE(codec.parse(length, "2_kg", 4));
+    CHECK(length.is_bad());
+    si::Mass mass;
+    CHECK(codec.from_chars(text, text + 4, mass).ec == std::errc::invalid_argument);
+    CHECK(mass.is_bad());
+
+    si::dynamic_quantity dq;
+    CHECK(codec.parse(dq, si::formatted_quantity(3.0, "in")));
+    CHECK(dq.unit() == si::index<si::Length>());
+    CHECK(dimensionless_cast(dq) == doctest::Approx(3.0 * si::inch / si::meter));
+
+    // Without a facet, the default formats and the fallback parser are used
+    si::codec const plain;
+    CHECK(plain.output_formats() == nullptr);
+    written = plain.to_chars(buffer, buffer + sizeof(buffer), 2.0 * si::meter);
+    CHECK(std::string(buffer, written.ptr) == "2_m");
+    CHECK(plain.parse(length, "3_ft", 4));
+    CHECK(length / si::foot == doctest::Approx(3.0));
+    CHECK(si::codec(std::locale::classic()).output_formats() == nullptr);
+
+    // Explicit maps are used as given
+    si::codec const maps(&fac->input_formats(), &fac->output_formats());
+    written = maps.to_chars(buffer, buffer + sizeof(buffer), 1.0 * si::inch);
+    CHECK(std::string(buffer, written.ptr) == "1_in");
+}
@@ -1,7 +1,10 @@
 #include "dim/si/si_facet.hpp"
 #include "doctest.h"
 
+#include <cstring>
 #include <string>
+#include <unordered_map>
+#include <vector>
 #include "dim/si.hpp"
 
 TEST_CASE("input_format_map")
@@ -36,6 +39,52 @@ TEST_CASE("input_format_map")
     CHECK(map2.size() == 0);
 }
 
+TEST_CASE("input_format_map.static_table")
+{
+    static const si::formatter formats[] = {{"in", si::inch}, {"yd", si::yard}, {"mi", si::mile},
+                                            {"ft", si::foot}, {"in", si::foot}};
+    static const dim::detail::symbol_hash_index<5> index(formats);
+    si::input_format_map map(formats, index);
+
+    // Repeated symbols resolve to the last entry
+    CHECK(map.size() == 4);
+    CHECK(map.to_quantity<si::Length>(2.0, "in") / si::foot == doctest::Approx(2.0));
+    CHECK(map.to_quantity<si::Length>(2.0, "mi") / si::mile == doctest::Approx(2.0));
+    CHECK(map.to_quantity(2.0, "yd").value() == doctest::Approx(2.0 * si::yard / si::meter));
+    CHECK(map.get("ft") == &formats[3]);
+    CHECK(map.get("f") == nullptr);
+    CHECK(map.get("feet") == nullptr);
+    CHECK(map.to_quantity(1.0, "nmi").is_bad());
+
+    // Modification copies the table
+    CHECK(map.insert("nmi", si::nautical_mile));
+    CHECK(map.size() == 5);
+    CHECK(map.get("ft") != &formats[3]);
+    CHECK(map.to_quantity<si::Length>(2.0, "in") / si::foot == doctest::Approx(2.0));
+    CHECK(map.to_quantity<si::Length>(2.0, "nmi") / si::nautical_mile == doctest::Approx(2.0));
+    CHECK(map.erase("in"));
+    CHECK(map.size() == 4);
+    CHECK(map.get("in") == nullptr);
+    CHECK(std::string(formats[0].symbol()) == "in");
+
+    // Every default table finds each of its symbols
+    si::input_format_map const& angles = si::get_default_format<si::Angle>();
+    for (char const* symbol : {"radian", "deg", "°", "mil", "mrad", "milliradian", "turn", "tr", "rev", "cyc", "'", "m",
+                               "min", "minute", "\"", "s", "sec", "second"}) {
+        CHECK(angles.get(symbol) != nullptr);
+        CHECK(std::string(angles.get(symbol)->symbol()) == symbol);
+    }
+    CHECK(angles.size() == 18);
+    CHECK(angles.get("rad") == nullptr);
+
+#if __cplusplus >= 201402L
+    static constexpr si::formatter constant_formats[] = {{"hr", si::hour}, {"min", si::minute}};
+    static constexpr dim::detail::symbol_hash_index<2> constant_index(constant_formats);
+    static_assert(constant_index.lookup("hr") == 0, "hr should be in slot 0");
+    static_assert(constant_index.lookup("min") == 1, "min should be in slot 1");
+#endif
+}
+
 static std::string print(si::dynamic_unit unit)
 {
     std::string rep = "[";
@@ -106,6 +155,44 @@ TEST_CASE("input_format_map_group")
     CHECK(imap.size() == 0);
 }
 
+TEST_CASE("input_format_map_group.symbol_index")
+{
+    si::input_format_map_group imap;
+    imap.insert(si::get_default_format<si::Force>());
+    imap.insert(si::get_default_format<si::Mass>());
+    imap.insert(si::get_default_format<si::Angle>());
+    imap.insert(si::get_default_format<si::Time>());
+
+    // "lb" is both a Mass and a Force. The lower index (Mass) wins.
+    CHECK(dim::index<si::Mass>() < dim::index<si::Force>());
+    auto result = imap.to_quantity(2.0, "lb");
+    CHECK(result.unit() == dim::index<si::Mass>());
+    CHECK(imap.find_symbol("lb")->index() == dim::index<si::Mass>());
+    CHECK(imap.to_quantity<si::Force>(2.0, "lb") / si::pound_force == doctest::Approx(2.0));
+
+    // "min" is both an Angle and a Time
+    CHECK(imap.find_symbol("min")->index() == std::min(dim::index<si::Angle>(), dim::index<si::Time>()));
+
+    // The index follows erasure and insertion
+    CHECK(imap.erase(dim::index<si::Mass>(), "lb"));
+    CHECK(imap.to_quantity(2.0, "lb").unit() == dim::index<si::Force>());
+    CHECK(imap.erase(dim::index<si::Force>()));
+    CHECK(imap.to_quantity(2.0, "lb").is_bad());
+    CHECK(imap.find_symbol("dyn") == nullptr);
+    imap.insert("smoot", 1.7018 * si::meter);
+    CHECK(imap.to_quantity(1.0, "smoot").value() == doctest::Approx(1.7018));
+
+    // Copies index their own maps
+    si::input_format_map_group copy = imap;
+    imap.clear();
+    CHECK(imap.find_symbol("smoot") == nullptr);
+    CHECK(copy.to_quantity(1.0, "smoot").value() == doctest::Approx(1.7018));
+    CHECK(copy.to_quantity(1.0, "slug").unit() == dim::index<si::Mass>());
+    imap = copy;
+    copy.clear();
+    CHECK(imap.to_quantity(1.0, "hour").unit() == dim::index<si::Time>());
+}
+
 TEST_CASE("output_format_map")
 {
     si::output_format_map omap;
@@ -134,9 +221,114 @@ TEST_CASE("output_format_map")
     CHECK(omap.size() == 0);
 }
 
+TEST_CASE("output_format_map.unit_index")
+{
+    // Enough units to grow the index several times, including dimensionless
+    si::output_format_map omap;
+    std::vector<si::dynamic_unit> units;
+    for (int8_t length = -3; length <= 3; ++length) {
+        for (int8_t time = -2; time <= 2; ++time) {
+            units.push_back(si::dynamic_unit(length, time, 0, 0, 0, 0, 0, 0));
+            omap.insert(si::formatter(std::to_string(units.size()).c_str(), si::dynamic_quantity(2.0, units.back())));
+        }
+    }
+    REQUIRE(omap.size() == units.size());
+    for (std::size_t i = 0; i < units.size(); ++i) {
+        auto const* item = omap.get(units[i]);
+        REQUIRE(item);
+        CHECK(std::string(item->symbol()) == std::to_string(i + 1));
+    }
+    CHECK(omap.get(dim::index<si::Mass>()) == nullptr);
+
+    // Erasing moves the other formatters, and copies keep a working index
+    CHECK(omap.erase(units[0]));
+    CHECK_FALSE(omap.erase(units[0]));
+    si::output_format_map copy = omap;
+    for (std::size_t i = 1; i < units.size(); ++i) {
+        REQUIRE(copy.get(units[i]));
+        CHECK(std::string(copy.get(units[i])->symbol()) == std::to_string(i + 1));
+    }
+    CHECK(copy.get(units[0]) == nullptr);
+
+    // The group finds maps by unit the same way
+    si::input_format_map_group group;
+    group.insert(si::formatter("in", si::inch));
+    group.insert(si::formatter("hr", si::hour));
+    group.insert(si::formatter("lbm", si::pound_mass));
+    CHECK(group.get(dim::index<si::Time>())->size() == 1);
+    CHECK(group.erase(dim::index<si::Length>()));
+    CHECK(group.get(dim::index<si::Length>()) == nullptr);
+    CHECK(group.to_quantity<si::Mass>(1.0, "lbm") / si::pound_mass == doctest::Approx(1.0));
+}
+
+TEST_CASE("output_format_map.range_insert")
+{
+    // A range insert matches the same formatters inserted one at a time
+    si::output_format_map single;
+    std::vector<si::formatter> items;
+    std::vector<si::dynamic_unit> units;
+    for (int8_t length = 3; length >= -3; --length) {
+        for (int8_t time = -2; time <= 2; ++time) {
+            units.push_back(si::dynamic_unit(length, time, 0, 0, 0, 0, 0, 0));
+            items.push_back(si::formatter(std::to_string(units.size()).c_str(), si::dynamic_quantity(2.0, units.back())));
+            single.insert(items.back());
+        }
+    }
+    // The later of two formatters for one unit wins, as with single inserts
+    items.push_back(si::formatter("late", si::dynamic_quantity(1.0, units[4])));
+    single.insert(items.back());
+    si::output_format_map ranged;
+    ranged.insert(si::formatter("old", si::dynamic_quantity(1.0, units[0])));
+    ranged.insert(si::formatter("kept", si::kilogram));
+    ranged.insert(items.begin(), items.end());
+    REQUIRE(ranged.size() == single.size() + 1);
+    for (auto const& unit : units) {
+        REQUIRE(ranged.get(unit));
+        CHECK(std::string(ranged.get(unit)->symbol()) == single.get(unit)->symbol());
+    }
+    CHECK(std::string(ranged.get(units[4])->symbol()) == "late");
+    CHECK(std::string(ranged.get(dim::index<si::Mass>())->symbol()) == "kept");
+
+    // Erasing from the middle keeps the rest of the index in place
+    for (std::size_t i = 0; i < units.size(); i += 2) {
+        CHECK(ranged.erase(units[i]));
+    }
+    for (std::size_t i = 0; i < units.size(); ++i) {
+        CHECK((ranged.get(units[i]) != nullptr) == (i % 2 == 1));
+    }
+    CHECK(ranged.get(dim::index<si::Mass>()));
+
+    // The group takes ranges of maps and of formatters
+    si::input_format_map const maps[] = {dim::get_default_format<si::Mass>(), dim::get_default_format<si::Length>(),
+                                         dim::get_default_format<si::Force>()};
+    si::input_format_map_group group;
+    group.insert(std::begin(maps), std::end(maps));
+    si::formatter const extra[] = {si::formatter("smoot", 1.7018 * si::meter), si::formatter("shift", 8.0 * si::hour)};
+    group.insert(std::begin(extra), std::end(extra));
+    CHECK(group.size() == 4);
+    CHECK(group.to_quantity<si::Length>(1.0, "smoot") / si::meter == doctest::Approx(1.7018));
+    CHECK(group.to_quantity<si::Time>(1.0, "shift") / si::hour == doctest::Approx(8.0));
+    // "lb" is a Mass and a Force; the lower index still wins
+    si::input_format_map_group single_group;
+    for (auto const& map : maps) {
+        single_group.insert(map);
+    }
+    REQUIRE(group.find_symbol("lb"));
+    CHECK(group.find_symbol("lb")->index() == single_group.find_symbol("lb")->index());
+}
+
 TEST_CASE("quantity_index")
 {
     CHECK(dim::index<si::Frequency>() != dim::index<si::AngularRate>());
+
+    std::unordered_map<si::dynamic_unit, std::string> names;
+    names[dim::index<si::Length>()] = "length";
+    names[dim::index<si::Frequency>()] = "frequency";
+    names[dim::index<si::AngularRate>()] = "angular rate";
+    CHECK(names.size() == 3);
+    CHECK(names[dim::index<si::Frequency>()] == "frequency");
+    CHECK(std::hash<si::dynamic_unit>()(dim::index<si::Length>()) !=
+          std::hash<si::dynamic_unit>()(dim::index<si::Time>()));
 }
 
 TEST_CASE("parse_quantity")
@@ -157,6 +349,79 @@ TEST_CASE("parse_quantity")
     CHECK(dimensionless_cast(dq) == doctest::Approx(2.0 * si::yard / si::meter));
 }
 
+TEST_CASE("parse_quantities")
+{
+    char const* texts[] = {"2_yd", "3_yd", "1.5_km", "7_s", "x_m", "4_in"};
+    std::size_t lengths[6];
+    for (int i = 0; i < 6; ++i) { lengths[i] = strlen(texts[i]); }
+
+    si::input_format_map input_format(si::meter_);
+    input_format.insert("yd", si::yard);
+    input_format.insert("in", si::inch);
+    si::Length lengths_out[6];
+    std::errc errors[6];
+    dim::parse_batch_result result = dim::parse_quantities(lengths_out, errors, texts, lengths, 6, input_format);
+    CHECK(result.count == 6);
+    CHECK(result.failed == 2);
+    for (int i = 0; i < 6; ++i) {
+        si::formatted_quantity fq;
+        dim::from_chars(texts[i], texts[i] + lengths[i], fq);
+        if (errors[i] == std::errc{}) {
+            si::Length expected;
+            CHECK(parse_quantity(expected, fq, input_format));
+            CHECK(lengths_out[i] == expected);
+        } else {
+            CHECK(lengths_out[i].is_bad());
+        }
+    }
+    CHECK(errors[3] == std::errc::invalid_argument);
+    CHECK(errors[4] == std::errc::invalid_argument);
+
+    char const buffer[] = "10_C, 20_C,,30_K, 40_C";
+    si::Temperature temps[8];
+    result = dim::parse_quantities(temps, errors, 8, buffer, buffer + strlen(buffer), ',');
+    CHECK(result.count == 5);
+    CHECK(result.failed == 1);
+    CHECK(errors[2] == std::errc::invalid_argument);
+    CHECK(temps[0] / si::kelvin == doctest::Approx(283.15));
+    CHECK(temps[1] / si::kelvin == doctest::Approx(293.15));
+    CHECK(temps[3] / si::kelvin == doctest::Approx(30.0));
+    CHECK(temps[4] / si::kelvin == doctest::Approx(313.15));
+
+    result = dim::parse_quantities(temps, nullptr, 2, buffer, buffer + strlen(buffer), ',');
+    CHECK(result.count == 2);
+    CHECK(result.failed == 0);
+
+    // A trailing delimiter is followed by an empty field
+    char const trailing[] = "1_m,2_m,";
+    si::Length trailing_out[4];
+    result = dim::parse_quantities(trailing_out, errors, 4, trailing, trailing + strlen(trailing), ',');
+    CHECK(result.count == 3);
+    CHECK(result.failed == 1);
+    CHECK(errors[2] == std::errc::invalid_argument);
+    CHECK(trailing_out[2].is_bad());
+    result = dim::parse_quantities(trailing_out, errors, 4, trailing, trailing, ',');
+    CHECK(result.count == 0);
+
+    si::input_format_map_group group;
+    group.insert(input_format);
+    si::dynamic_quantity dqs[6];
+    result = dim::parse_quantities(dqs, errors, texts, lengths, 6, group);
+    CHECK(result.failed == 1);
+    CHECK(errors[4] == std::errc::invalid_argument);
+    CHECK(dqs[0] == si::dynamic_quantity(2.0 * si::yard));
+    CHECK(dqs[3] == si::dynamic_quantity(7.0 * si::second));
+    CHECK(dqs[5] == si::dynamic_quantity(4.0 * si::inch));
+
+#if __cplusplus >= 201703L
+    std::string_view views[] = {"1_yd", "2_yd", "3_m"};
+    result = dim::parse_quantities(lengths_out, errors, views, 3, input_format);
+    CHECK(result.failed == 0);
+    CHECK(lengths_out[1] == 2.0 * si::yard);
+    CHECK(lengths_out[2] == 3.0 * si::meter);
+#endif
+}
+
 TEST_CASE("format_quantity")
 {
     si::formatted_quantity formatted;
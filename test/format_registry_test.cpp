@@ -0,0 +1,159 @@
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "dim/format_registry.hpp"
+#include "dim/si.hpp"
+#include "doctest.h"
+
+using namespace dim::si;
+using snapshot = dim::format_snapshot<double, dim::si::system>;
+using registry = dim::format_registry<double, dim::si::system>;
+
+namespace
+{
+std::string print(snapshot const& i_snapshot, si::dynamic_quantity const& i_quantity)
+{
+    char buffer[64];
+    std::to_chars_result result = i_snapshot.codec().to_chars(buffer, buffer + sizeof(buffer), i_quantity);
+    return std::string(buffer, result.ptr);
+}
+} // namespace
+
+TEST_CASE("format_snapshot.read")
+{
+    std::istringstream input("# Pressure for this customer\n"
+                             "output psi 6894.757293168_Pa\n"
+                             "\n"
+                             "both degF 0.5555555555555556_K 255.3722222222222_K  # Fahrenheit\n"
+                             "input  kt 0.5144444444444445_m/s\n");
+    snapshot formats;
+    std::size_t error_line = 99;
+    REQUIRE(formats.read(input, &error_line));
+    CHECK(error_line == 0);
+
+    CHECK(print(formats, si::dynamic_quantity(2 * 6894.757293168 * pascal)) == "2_psi");
+    Temperature temperature;
+    CHECK(formats.codec().parse(temperature, "32_degF", 7));
+    CHECK(temperature / kelvin == doctest::Approx(273.15).epsilon(1e-6));
+    Speed speed;
+    CHECK(formats.codec().parse(speed, "10_kt", 5));
+    CHECK(speed / (meter / second) == doctest::Approx(5.144444444444445));
+    // psi was only added for output
+    Pressure pressure;
+    CHECK_FALSE(formats.codec().parse(pressure, "1_psi", 5));
+}
+
+TEST_CASE("format_snapshot.errors")
+{
+    char const* bad[] = {
+        "output psi\n",                          // Missing scale
+        "sideways psi 1_Pa\n",                   // Bad direction
+        "output psi 1_Pa 0_Pa extra\n",          // Too many fields
+        "output psi 1_Qz\n",                     // Unknown unit
+        "output degF 0.5555555555555556_K 1_m\n" // Offset and scale disagree
+    };
+    for (char const* text : bad) {
+        std::istringstream input(std::string("output kPa 1000_Pa\n") + text);
+        snapshot formats;
+        std::size_t error_line = 0;
+        CHECK_FALSE(formats.read(input, &error_line));
+        CHECK(error_line == 2);
+        // Nothing was added
+        CHECK(print(formats, si::dynamic_quantity(1000.0 * pascal)) == "1000_Pa");
+    }
+}
+
+TEST_CASE("format_registry.reload")
+{
+    std::unique_ptr<si::facet> defaults(si::system::make_default_facet());
+    registry formats(*defaults);
+    si::dynamic_quantity pressure(101325.0 * pascal);
+    registry::snapshot_pointer original = formats.current();
+    std::string default_text = print(*original, pressure);
+
+    std::istringstream psi("output psi 6894.757293168_Pa\n");
+    REQUIRE(formats.load(psi));
+    registry::snapshot_pointer first = formats.current();
+    CHECK(first != original);
+    CHECK(print(*first, pressure).substr(0, 7) == "14.6959");
+    // A reader holding the old snapshot still sees the old formats
+    CHECK(print(*original, pressure) == default_text);
+
+    // A bad file keeps the current snapshot
+    std::istringstream broken("output kPa\n");
+    std::size_t error_line = 0;
+    CHECK_FALSE(formats.load(broken, &error_line));
+    CHECK(error_line == 1);
+    CHECK(formats.current() == first);
+
+    // Each load starts again from the base formats
+    std::istringstream kpa("output kPa 1000_Pa\n");
+    REQUIRE(formats.load(kpa));
+    CHECK(print(*formats.current(), pressure) == "101.325_kPa");
+
+    CHECK_FALSE(formats.load_file("/nonexistent/units.conf", &error_line));
+    CHECK(error_line == 0);
+}
+
+TEST_CASE("format_registry.retire")
+{
+    registry formats;
+    std::weak_ptr<snapshot const> watch = formats.current();
+    registry::snapshot_pointer reader = formats.current();
+
+    std::istringstream kpa("output kPa 1000_Pa\n");
+    REQUIRE(formats.load(kpa));
+    // Replaced, but still held by a reader
+    CHECK_FALSE(watch.expired());
+    CHECK(print(*reader, si::dynamic_quantity(1000.0 * pascal)) == "1000_Pa");
+
+    // Freed as soon as the last reader lets go, including this thread's cache
+    reader.reset();
+    CHECK_FALSE(watch.expired());
+    CHECK(print(*formats.current(), si::dynamic_quantity(1000.0 * pascal)) == "1_kPa");
+    CHECK(watch.expired());
+
+    // Reloading many times keeps only the current snapshot
+    watch = formats.current();
+    for (int i = 0; i < 100; ++i) {
+        std::istringstream psi("output psi 6894.757293168_Pa\n");
+        REQUIRE(formats.load(psi));
+    }
+    // Held by the registry and this thread's cache
+    CHECK(formats.current().use_count() == 2);
+    CHECK(watch.expired());
+
+    // The cache is per registry generation, not per thread alone
+    registry other;
+    CHECK(print(*other.current(), si::dynamic_quantity(1000.0 * pascal)) == "1000_Pa");
+    CHECK(print(*formats.current(), si::dynamic_quantity(1000.0 * pascal)) != "1000_Pa");
+}
+
+TEST_CASE("format_registry.threads")
+{
+    registry formats;
+    std::atomic<bool> done(false);
+    std::atomic<std::size_t> torn(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                std::string text = print(*formats.current(), si::dynamic_quantity(1000.0 * pascal));
+                torn += (text != "1000_Pa" && text != "1_kPa" && text != "10_hPa");
+            }
+        });
+    }
+    for (int i = 0; i < 200; ++i) {
+        std::istringstream input(i % 2 ? "output kPa 1000_Pa\n" : "output hPa 100_Pa\n");
+        REQUIRE(formats.load(input));
+    }
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    CHECK(torn == 0);
+    CHECK(print(*formats.current(), si::dynamic_quantity(1000.0 * pascal)) == "1_kPa");
+}
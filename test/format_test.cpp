@@ -1,5 +1,6 @@
 #include "doctest.h"
 #include "dim/si.hpp"
+#include <cmath>
 
 using namespace dim::si::literal;
 
@@ -34,6 +35,90 @@ TEST_CASE("from_string")
     CHECK(angle.is_bad());
 }
 
+TEST_CASE("from_string.in_place")
+{
+    si::system::install_facet();
+    // Fields of a larger buffer, parsed without copies or terminators
+    char const buffer[] = "5.2_deg|3_lbf|12_kN/m|7_m";
+    si::Angle angle;
+    CHECK(from_string(angle, buffer, 7));
+    CHECK(angle / dim::si::degree == doctest::Approx(5.2));
+    si::Force force;
+    CHECK(from_string(force, buffer + 8, 5));
+    CHECK(force == 3.0 * si::pound_force);
+    si::dynamic_quantity dynamic;
+    CHECK(from_string(dynamic, buffer + 14, 7));
+    CHECK(dynamic == si::dynamic_quantity(12000.0 * si::newton / si::meter));
+    // The length bounds the symbol: "5.2_d" is not an angle
+    CHECK_FALSE(from_string(angle, buffer, 5));
+    CHECK(angle.is_bad());
+
+    si::Length length;
+    CHECK(from_string(length, "7_m"));
+    CHECK(length == 7.0 * si::meter);
+#if __cplusplus >= 201703L
+    std::string_view view(buffer + 22, 3);
+    CHECK(from_string(length, view));
+    CHECK(length == 7.0 * si::meter);
+#endif
+
+    double value;
+    char const* symbol;
+    std::size_t symbol_length;
+    auto result = dim::from_chars(buffer + 14, buffer + sizeof(buffer) - 1, value, symbol, symbol_length);
+    CHECK(result.ec == std::errc{});
+    CHECK(value == 12.0);
+    CHECK(std::string(symbol, symbol_length) == "kN/m");
+    CHECK(result.ptr == buffer + 21);
+
+    si::input_format_map const& forces = dim::get_default_format<si::Force>();
+    CHECK(forces.get(buffer + 10, 3) == forces.get("lbf"));
+    CHECK(forces.get(buffer + 10, 2) == forces.get("lb"));
+    CHECK(forces.get(buffer + 10, 1) == nullptr);
+    CHECK(forces.to_quantity<si::Force>(3.0, buffer + 10, 3) == 3.0 * si::pound_force);
+    si::input_format_map_group group;
+    group.insert(forces);
+    CHECK(group.find_symbol(buffer + 10, 3) == forces.get("lbf"));
+    CHECK(group.find_symbol(buffer + 10, 4) == nullptr);
+}
+
+TEST_CASE("to_chars")
+{
+    si::system::install_facet();
+    char buffer[64];
+    si::Angle angle = 5.2 * si::degree;
+    auto result = dim::to_chars(buffer, buffer + sizeof(buffer), angle);
+    REQUIRE(result.ec == std::errc{});
+    std::string text(buffer, result.ptr);
+    CHECK(text.substr(0, 18) == "0.0907571211037051");
+    CHECK(text.substr(text.size() - 4) == "_rad");
+
+    // Too small
+    result = dim::to_chars(buffer, buffer + 10, angle);
+    CHECK(result.ec == std::errc::value_too_large);
+    CHECK(result.ptr == buffer + 10);
+    result = dim::to_chars(buffer, buffer + 20, angle);
+    CHECK(result.ec == std::errc::value_too_large);
+
+    si::dynamic_quantity dynamic(2.5 * si::newton);
+    result = dim::to_chars(buffer, buffer + sizeof(buffer), dynamic);
+    REQUIRE(result.ec == std::errc{});
+    CHECK(std::string(buffer, result.ptr) == "2.5_N");
+
+    // Round trip exactly
+    uint32_t seed = 99u;
+    for (int i = 0; i < 1000; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        double value = std::ldexp(1.0 + seed / 4294967296.0, static_cast<int>(seed % 80) - 40);
+        si::Length length = value * si::meter;
+        result = dim::to_chars(buffer, buffer + sizeof(buffer), length);
+        REQUIRE(result.ec == std::errc{});
+        si::Length parsed;
+        CHECK(from_string(parsed, buffer, static_cast<std::size_t>(result.ptr - buffer)));
+        CHECK(parsed == length);
+    }
+}
+
 TEST_CASE("to_string")
 {
     si::system::install_facet();
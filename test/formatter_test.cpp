@@ -4,7 +4,25 @@
 #include "dim/si/si_facet.hpp"
 #include "doctest.h"
 #include "dim/si.hpp"
+#include "dim/static_formatter.hpp"
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
 
+namespace
+{
+/// True if an array kernel's result matches the single-value conversion compiled here
+bool same_rounding(double i_kernel, double i_single)
+{
+#if defined(__FMA__) || defined(__ARM_FEATURE_FMA)
+    // The compiler may fuse the single-value multiply and add here, but never in the kernels
+    return std::fabs(i_kernel - i_single) <= 2 * std::numeric_limits<double>::epsilon() * std::fabs(i_single);
+#else
+    return i_kernel == i_single;
+#endif
+}
+} // namespace
 
 TEST_CASE("formatter")
 {
@@ -59,6 +77,161 @@ TEST_CASE("formatter")
 #endif
 }
 
+TEST_CASE("formatter.affine")
+{
+    si::formatter f("F", 5. / 9. * si::kelvin, (273.15 - 5. / 9. * 32.) * si::kelvin);
+    CHECK(f.index() == dim::index<si::Temperature>());
+    CHECK(f.scale().value() == doctest::Approx(5. / 9.));
+    CHECK(f.offset().unit() == dim::index<si::Temperature>());
+
+    // Output inverts input
+    CHECK(f.input<si::Temperature>(212.0) / si::fahrenheit(212.0) == doctest::Approx(1.0));
+    CHECK(f.non_dim(si::fahrenheit(212.0)) == doctest::Approx(212.0));
+    CHECK(f.output(si::dynamic_quantity(si::fahrenheit(-40.0))).value() == doctest::Approx(-40.0));
+    CHECK(f.non_dim(si::celsius(100.0)) == doctest::Approx(212.0));
+    for (double value : {-459.67, -40.0, 0.0, 32.0, 98.6, 1e6}) {
+        CHECK(f.non_dim(f.input(value)) == doctest::Approx(value));
+    }
+}
+
+TEST_CASE("formatter.round_trip")
+{
+    // Output divides by the scale, which reads back exactly more often than multiplying by its reciprocal
+    si::formatter feet("ft", si::foot);
+    std::vector<double> meters(10000);
+    std::vector<double> back(meters.size());
+    std::size_t divide_misses = 0;
+    std::size_t reciprocal_misses = 0;
+    for (std::size_t i = 0; i < meters.size(); ++i) {
+        double value = static_cast<double>(i + 1);
+        meters[i] = dimensionless_cast(feet.input<si::Length>(value));
+        double measured = feet.non_dim(meters[i] * si::meter);
+        CHECK(measured == meters[i] / (si::foot / si::meter));
+        divide_misses += (measured != value);
+        reciprocal_misses += (meters[i] * (1.0 / (si::foot / si::meter)) != value);
+    }
+    CHECK(divide_misses < reciprocal_misses);
+
+    // The array kernels round the same way
+    feet.non_dim(meters.data(), back.data(), meters.size());
+    for (std::size_t i = 0; i < meters.size(); ++i) {
+        REQUIRE(back[i] == feet.non_dim(meters[i] * si::meter));
+    }
+}
+
+TEST_CASE("formatter.arrays")
+{
+    INFO("Kernel: ", dim::detail::affine_transform_isa());
+    si::formatter f("F", 5. / 9. * si::kelvin, (273.15 - 5. / 9. * 32.) * si::kelvin);
+    std::vector<double> values(67);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = -40.0 + 7.25 * static_cast<double>(i);
+    }
+    // Every length exercises the vector loops and the tails
+    for (std::size_t count = 0; count <= values.size(); ++count) {
+        std::vector<double> kelvin(count + 1, -1.0);
+        f.input(values.data(), kelvin.data(), count);
+        std::vector<double> back(count + 1, -1.0);
+        f.non_dim(kelvin.data(), back.data(), count);
+        for (std::size_t i = 0; i < count; ++i) {
+            CHECK(same_rounding(kelvin[i], dimensionless_cast(f.input(values[i]))));
+            CHECK(back[i] == f.non_dim(si::dynamic_quantity(kelvin[i], dim::index<si::Temperature>())));
+        }
+        CHECK(kelvin[count] == -1.0);
+        CHECK(back[count] == -1.0);
+    }
+
+    // In place, and into quantities
+    std::vector<double> work(values);
+    f.input(work.data(), work.data(), work.size());
+    std::vector<si::Temperature> temperatures(values.size());
+    f.input(values.data(), temperatures.data(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        CHECK(temperatures[i] / si::kelvin == work[i]);
+        CHECK(temperatures[i] / si::fahrenheit(values[i]) == doctest::Approx(1.0));
+    }
+    f.non_dim(temperatures.data(), work.data(), work.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        CHECK(work[i] == doctest::Approx(values[i]));
+    }
+
+    // float arrays use their own kernels
+    dim::formatter<float, si::system> ft("in", dim::dynamic_quantity<float, si::system>(0.0254f, si::meter_));
+    std::vector<float> inches(35, 12.0f);
+    ft.input(inches.data(), inches.data(), inches.size());
+    for (float meters : inches) {
+        CHECK(meters == 12.0f * 0.0254f);
+    }
+
+#ifdef DIM_EXCEPTIONS
+    std::vector<si::Time> times(2);
+    CHECK_THROWS_AS(f.input(values.data(), times.data(), times.size()), dim::incommensurable_exception);
+#else
+    std::vector<si::Time> times(2);
+    f.input(values.data(), times.data(), times.size());
+    CHECK(times[0].is_bad());
+    CHECK(times[1].is_bad());
+#endif
+}
+
+namespace
+{
+struct knots {
+    static constexpr char const* symbol() { return "kt"; }
+    static constexpr si::Speed scale() { return si::knot; }
+};
+
+struct fahrenheit {
+    static constexpr char const* symbol() { return "F"; }
+    static constexpr si::Temperature scale() { return 5. / 9. * si::kelvin; }
+    static constexpr si::Temperature offset() { return (273.15 - 5. / 9. * 32.) * si::kelvin; }
+};
+} // namespace
+
+TEST_CASE("static_formatter")
+{
+    using knot_format = dim::static_formatter<si::Speed, knots>;
+    using fahrenheit_format = dim::static_formatter<si::Temperature, fahrenheit>;
+    static_assert(knot_format::input(2.0) == 2.0 * si::knot, "input is constexpr");
+    static_assert(knot_format::kOffset == 0.0, "offset defaults to zero");
+    static_assert(std::is_empty<knot_format>::value, "static formatters have no state");
+
+    // Same results as the equivalent formatter
+    si::formatter dynamic_knots("kt", si::knot);
+    si::formatter dynamic_fahrenheit("F", 5. / 9. * si::kelvin, (273.15 - 5. / 9. * 32.) * si::kelvin);
+    for (double value : {-459.67, -40.0, 0.0, 32.0, 98.6, 1e6}) {
+        CHECK(knot_format::input(value) == dynamic_knots.input<si::Speed>(value));
+        CHECK(knot_format::non_dim(value * si::meter / si::second) ==
+              dynamic_knots.non_dim(value * si::meter / si::second));
+        CHECK(fahrenheit_format::input(value) == dynamic_fahrenheit.input<si::Temperature>(value));
+        CHECK(fahrenheit_format::non_dim(si::fahrenheit(value)) == dynamic_fahrenheit.non_dim(si::fahrenheit(value)));
+    }
+    auto formatted = knot_format::output(si::knot * 3.0);
+    CHECK(strcmp(formatted.symbol(), "kt") == 0);
+    CHECK(formatted.value() == doctest::Approx(3.0));
+
+    // Arrays
+    std::vector<double> values{-40.0, 0.0, 212.0};
+    std::vector<si::Temperature> temperatures(values.size());
+    fahrenheit_format::input(values.data(), temperatures.data(), values.size());
+    std::vector<double> back(values.size());
+    fahrenheit_format::non_dim(temperatures.data(), back.data(), back.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        CHECK(same_rounding(temperatures[i] / si::kelvin, fahrenheit_format::input(values[i]) / si::kelvin));
+        CHECK(back[i] == fahrenheit_format::non_dim(temperatures[i]));
+    }
+
+    // As a dynamic formatter in maps and facets
+    si::output_format_map map;
+    map.insert(knot_format());
+    CHECK(strcmp(map.format(si::knot * 5.0).symbol(), "kt") == 0);
+    CHECK(map.format(si::knot * 5.0).value() == doctest::Approx(5.0));
+    std::unique_ptr<si::facet> facet(si::system::make_default_facet());
+    facet->output_formatter(fahrenheit_format());
+    CHECK(strcmp(facet->output_formats().format(si::fahrenheit(50.0)).symbol(), "F") == 0);
+    CHECK(fahrenheit_format::dynamic().index() == dim::index<si::Temperature>());
+}
+
 TEST_CASE("formatted_quantity")
 {
     si::formatted_quantity fq(1.0, "01234567890123456789012345678901");
@@ -404,3 +404,49 @@ TEST_CASE("unit_string_scanner.utf8")
     CHECK(scanner.state() == dim::detail::unit_parse_state::kError);
 }
 
+
+TEST_CASE("scan_simple_symbol")
+{
+    // Compare against running the scanner byte by byte, as from_chars did
+    // before the prescan.
+    char const* pieces[] = {"m", "s", "kg", "Pa", "ABCDEFGHIJ", "xyz", "/", "*", "_", " ", "]", ",", "2", ".",
+                            "^", "(", ")", "μ", "\xce", "°", "@", "[", "{", "`"};
+    int const piece_count = sizeof(pieces) / sizeof(pieces[0]);
+    uint32_t seed = 2024u;
+    char buffer[96];
+    int simple = 0;
+    for (int trial = 0; trial < 20000; trial++) {
+        char* end = buffer;
+        seed = seed * 1664525u + 1013904223u;
+        int length = (seed >> 24) % 12;
+        for (int i = 0; i < length; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            char const* piece = pieces[(seed >> 16) % piece_count];
+            while (*piece) { *end++ = *piece++; }
+        }
+
+        dim::detail::unit_string_scanner scanner;
+        char const* expected = buffer;
+        while (expected < buffer + dim::kMaxSymbol && expected < end && scanner.accept(*expected)) { ++expected; }
+
+        dim::detail::unit_parse_state state;
+        char const* actual = dim::detail::scan_simple_symbol(buffer, end, state);
+        if (actual) {
+            ++simple;
+            CHECK_MESSAGE(actual == expected, std::string(buffer, end));
+            CHECK_MESSAGE(state == scanner.state(), std::string(buffer, end));
+        }
+    }
+    CHECK(simple > 5000);
+
+    // The vector path covers 16 bytes at a time
+    char const* longer = "kilometerpersecondsquared_m";
+    dim::detail::unit_parse_state state;
+    CHECK(dim::detail::scan_simple_symbol(longer, longer + strlen(longer), state) == longer + strlen(longer));
+    CHECK(state == dim::detail::unit_parse_state::kSymbol);
+    longer = "kilometerpersecondsq^2";
+    CHECK(dim::detail::scan_simple_symbol(longer, longer + strlen(longer), state) == nullptr);
+    longer = "kilometerpersecondsq//m";
+    CHECK(dim::detail::scan_simple_symbol(longer, longer + strlen(longer), state) == longer + 21);
+    CHECK(state == dim::detail::unit_parse_state::kError);
+}
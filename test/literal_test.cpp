@@ -46,3 +46,36 @@ TEST_CASE("SiLiterals") {
     CHECK(1_kat == 1.0*dim::si::katal);
     
 }
+
+#if __cplusplus >= 201402L
+TEST_CASE("UnitStringLiterals") {
+    using namespace dim::si;
+    auto torque = DIM_UNIT("kN*m");
+    static_assert(std::is_same<decltype(torque), Energy>::value, "kN*m should be an energy");
+    CHECK(torque == 1e3 * joule);
+
+    auto speed = DIM_UNIT("mm/s");
+    static_assert(std::is_same<decltype(speed), Speed>::value, "mm/s should be a speed");
+    CHECK(speed / (meter / second) == doctest::Approx(1e-3));
+
+    auto acceleration = DIM_UNIT("Mg*m/s^2");
+    static_assert(std::is_same<decltype(acceleration), Force>::value, "Mg*m/s^2 should be a force");
+    CHECK(acceleration / newton == doctest::Approx(1e3));
+
+    auto inverse = DIM_UNIT("(km)^(-2)");
+    CHECK(inverse * 1e6 * meter * meter == doctest::Approx(1.0));
+
+    auto ohms = DIM_UNIT("kΩ");
+    static_assert(std::is_same<decltype(ohms), Resistance>::value, "kΩ should be a resistance");
+    CHECK(ohms / ohm == doctest::Approx(1e3));
+#if __cplusplus >= 201703L
+    constexpr auto pressure = DIM_UNIT("hPa");
+    static_assert(pressure / pascal == 100.0, "hPa should be 100 Pa");
+#endif
+#if __cplusplus >= 202002L
+    constexpr auto energy = "kN*m"_unit;
+    static_assert(std::is_same<decltype(energy), Energy const>::value, "kN*m should be an energy");
+    static_assert(energy / joule == 1e3, "kN*m should be 1 kJ");
+#endif
+}
+#endif
@@ -2,6 +2,8 @@
 
 #include "dim/si.hpp"
 #include "dim/si/definition.hpp"
+#include "dim/si/quantity_parser_driver.hpp"
+#include "dim/si/unit_string_parser.hpp"
 #include "doctest.h"
 
 using namespace dim::detail;
@@ -127,3 +129,142 @@ TEST_CASE("quantity_parser.errors")
     result = parse_standard_rep<double, si::system>(buffer,  buffer + 64);
     CHECK(result.is_bad() == true);
 }
+
+TEST_CASE("quantity_parser.cache")
+{
+    si::parse_cache_capacity(4);
+    si::parse_cache_clear();
+    char const* text = "kN*m";
+    auto first = parse_standard_rep<double, si::system>(text, text + strlen(text));
+    auto second = parse_standard_rep<double, si::system>(text, text + strlen(text));
+    CHECK(first.value() == second.value());
+    CHECK(first.unit() == second.unit());
+    CHECK(second.unit() == dim::index<si::Energy>());
+    auto stats = si::parse_cache_statistics();
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.capacity == 4);
+
+    // The key ends at the first nul
+    char buffer[64] = "kN*m";
+    auto padded = parse_standard_rep<double, si::system>(buffer, buffer + sizeof(buffer));
+    CHECK(padded.value() == first.value());
+    CHECK(si::parse_cache_statistics().hits == 2);
+
+    // Failures are remembered too
+    text = "m**s";
+    CHECK(parse_standard_rep<double, si::system>(text, text + strlen(text)).is_bad());
+    CHECK(parse_standard_rep<double, si::system>(text, text + strlen(text)).is_bad());
+    CHECK(si::parse_cache_statistics().hits == 3);
+
+    // Eviction keeps the results correct
+    char const* corpus[] = {"mm/s", "Mg*m/s^2", "kPa", "μm", "ms", "kN*m", "GHz", "mol/L"};
+    for (int pass = 0; pass < 3; pass++) {
+        for (char const* symbol : corpus) {
+            auto cached = parse_standard_rep<double, si::system>(symbol, symbol + strlen(symbol));
+            CHECK_FALSE(cached.is_bad());
+        }
+    }
+    text = "mm/s";
+    auto speed = parse_standard_rep<double, si::system>(text, text + strlen(text));
+    CHECK(speed.value() == doctest::Approx(1e-3));
+    CHECK(speed.unit() == dim::index<si::Speed>());
+
+    // Disable the cache
+    si::parse_cache_capacity(0);
+    si::parse_cache_clear();
+    parse_standard_rep<double, si::system>(text, text + strlen(text));
+    stats = si::parse_cache_statistics();
+    CHECK(stats.hits == 0);
+    CHECK(stats.misses == 0);
+    CHECK(stats.capacity == 0);
+
+    si::parse_cache_capacity(512);
+}
+
+namespace {
+
+/**
+ * Run the hand-written and Bison parsers on the same text, checking they agree.
+ * The Bison parser accepts as soon as it reduces a complete unit group, ignoring
+ * any trailing text (e.g. "m)"). The hand-written parser rejects those strings.
+ */
+void check_engines_agree(char const* i_begin, char const* i_end)
+{
+    si::dynamic_quantity fast = dim::detail::unit_string_parser(i_begin, i_end).parse();
+    si::detail::quantity_parser_driver driver;
+    driver.parse(i_begin, i_end);
+    INFO(std::string(i_begin, i_end));
+    if (fast.is_bad() && !driver.result.is_bad()) {
+        // The Bison result must come from a leading part of the text
+        bool prefix_matches = false;
+        for (char const* end = i_end - 1; end > i_begin && !prefix_matches; --end) {
+            si::dynamic_quantity head = dim::detail::unit_string_parser(i_begin, end).parse();
+            prefix_matches = (head.unit() == driver.result.unit() && head.value() == driver.result.value());
+        }
+        CHECK(prefix_matches);
+        return;
+    }
+    CHECK(fast.is_bad() == driver.result.is_bad());
+    if (!fast.is_bad() && !driver.result.is_bad()) {
+        CHECK(fast.unit() == driver.result.unit());
+        CHECK(fast.value() == driver.result.value());
+    }
+}
+
+} // namespace
+
+TEST_CASE("quantity_parser.engines")
+{
+    char const* corpus[] = {"",      "m",        "mol",      "mmol",   "kmol",  "cd",       "mcd",     "ccd",
+                            "Pa",    "PPa",      "hPa",      "T",      "Ts",    "TT",       "Ta",      "Hz",
+                            "mHz",   "H",        "mH",       "kat",    "kkat",  "eV",       "keV",     "bar",
+                            "mbar",  "L",        "dL",       "Gy",     "GGy",   "Sv",       "mSv",     "Wb",
+                            "kg",    "Mg*m/s^2", "m/s^2",    "m/s/s",  "(m*s)^2", "m^2^3",  "m^((2))", "*m",
+                            " m",    "m ",       "**m",      "m**s",   "m*/s",  "m*2",      "m^-1",    "m^+121",
+                            "m^(s)", "m^1.2",    "m,s",      "()",     "(m",    "m)",       "m(s)",    "kΩ",
+                            "μm/s",  "mK",       "μΩ",       "m^",     "m^-",   "m^ 2",     "k m",     "kN*m",
+                            "mm/s",  "kPa",      "GHz",      "mol/L",  "m.s",   "m_s_K",    "A*s/V",   "(m/s)/(s)"};
+    for (char const* text : corpus) {
+        char const* end = text + strlen(text);
+        check_engines_agree(text, end);
+    }
+
+    // Embedded nul ends the text
+    char const padded[] = "km\0/s";
+    check_engines_agree(padded, padded + sizeof(padded));
+
+    // Deeply nested parentheses
+    char nested[2 * dim::detail::unit_string_parser::kMaxDepth + 1];
+    for (int i = 0; i < dim::detail::unit_string_parser::kMaxDepth; i++) {
+        nested[i] = '(';
+        nested[dim::detail::unit_string_parser::kMaxDepth + 1 + i] = ')';
+    }
+    nested[dim::detail::unit_string_parser::kMaxDepth] = 'm';
+    check_engines_agree(nested, nested + sizeof(nested));
+    char too_deep[2 * dim::detail::unit_string_parser::kMaxDepth + 3] = "(";
+    std::memcpy(too_deep + 1, nested, sizeof(nested));
+    too_deep[sizeof(too_deep) - 1] = ')';
+    CHECK(dim::detail::unit_string_parser(too_deep, too_deep + sizeof(too_deep)).parse().is_bad());
+
+    // Random token soup
+    char const* pieces[] = {"m", "s", "g", "k", "M", "c", "d", "mol", "rad", "Pa", "P", "a", "Hz", "e", "V", "K",
+                            "T", "u", "Ω", "μ", "\xce", "\xe2\x84", "(", ")", "^", "/", "*", "_", ".", " ",
+                            "2", "-1", "+3", "-", "x"};
+    int const piece_count = sizeof(pieces) / sizeof(pieces[0]);
+    uint32_t state = 12345u;
+    char buffer[64];
+    for (int trial = 0; trial < 20000; trial++) {
+        char* cursor = buffer;
+        state = state * 1664525u + 1013904223u;
+        int length = 1 + (state >> 24) % 10;
+        for (int i = 0; i < length; i++) {
+            state = state * 1664525u + 1013904223u;
+            char const* piece = pieces[(state >> 16) % piece_count];
+            while (*piece) { *cursor++ = *piece++; }
+        }
+        // The Bison lexer reads past the end of truncated UTF-8 sequences
+        *cursor = '\0';
+        check_engines_agree(buffer, cursor);
+    }
+}
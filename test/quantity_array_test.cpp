@@ -0,0 +1,223 @@
+#include <array>
+#include <type_traits>
+#include <vector>
+#include "dim/quantity_array.hpp"
+#include "dim/si.hpp"
+#include "doctest.h"
+
+using namespace dim::si;
+
+TEST_CASE("quantity_array.arithmetic")
+{
+    dim::quantity_array<Length> distance{1.0 * meter, 4.0 * meter, 9.0 * meter};
+    dim::quantity_array<Time> time{1.0 * second, 2.0 * second, 3.0 * second};
+    REQUIRE(distance.size() == 3);
+
+    dim::quantity_array<Speed> speed = distance / time;
+    static_assert(std::is_same<decltype(distance / time)::value_type, Speed>::value, "Speed units");
+    CHECK(speed[2] / (meter / second) == doctest::Approx(3.0));
+
+    auto area = distance * distance;
+    static_assert(std::is_same<decltype(area)::value_type, Area>::value, "Area units");
+    CHECK(area[1] / (meter * meter) == doctest::Approx(16.0));
+
+    dim::quantity_array<Length> total = distance + distance - distance;
+    CHECK(total[1] / meter_ == doctest::Approx(4.0));
+    CHECK((-distance)[0] / meter_ == doctest::Approx(-1.0));
+
+    // Broadcast quantities and scalars
+    CHECK((distance + 1.0 * meter)[0] / meter_ == doctest::Approx(2.0));
+    CHECK((10.0 * meter - distance)[2] / meter_ == doctest::Approx(1.0));
+    CHECK((distance * 2.0)[1] / meter_ == doctest::Approx(8.0));
+    CHECK((2.0 * distance)[1] / meter_ == doctest::Approx(8.0));
+    CHECK((distance / 2.0)[1] / meter_ == doctest::Approx(2.0));
+    auto frequency = 1.0 / time;
+    static_assert(std::is_same<decltype(frequency)::value_type, Frequency>::value, "Frequency units");
+    CHECK(frequency[1] * second == doctest::Approx(0.5));
+    auto force = 2.0 * kilogram * (distance / (time * time));
+    static_assert(std::is_same<decltype(force)::value_type, Force>::value, "Force units");
+    CHECK(force[2] / newton == doctest::Approx(2.0));
+
+    // In place
+    distance += time * (1.0 * meter / second);
+    CHECK(distance[0] / meter_ == doctest::Approx(2.0));
+    distance -= 1.0 * meter;
+    distance *= 3.0;
+    distance /= 1.5;
+    CHECK(distance[2] / meter_ == doctest::Approx(22.0));
+}
+
+TEST_CASE("quantity_array.span")
+{
+    std::vector<Length> values(37);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<double>(i) * meter;
+    }
+    dim::quantity_span<Length> view(values);
+    dim::quantity_span<Length const> read_only(view);
+    CHECK(read_only.scalars() == reinterpret_cast<double const*>(values.data()));
+    CHECK(view.subspan(10, 5)[0] / meter_ == doctest::Approx(10.0));
+
+    // Changes through a span are seen by the owner
+    dim::quantity_span<Length> first = view.subspan(0, 2);
+    first *= 10.0;
+    CHECK(values[1] / meter_ == doctest::Approx(10.0));
+    values[1] = 1.0 * meter;
+
+    // Spans and arrays mix, and results are owning arrays
+    dim::quantity_array<Length> copy(read_only);
+    dim::quantity_array<Length> doubled = read_only + copy;
+    CHECK(doubled[36] / meter_ == doctest::Approx(72.0));
+
+    std::array<Length, 2> fixed{{1.0 * meter, 2.0 * meter}};
+    dim::quantity_span<Length> fixed_view(fixed);
+    CHECK(sum(fixed_view) / meter_ == doctest::Approx(3.0));
+}
+
+TEST_CASE("quantity_array.reductions")
+{
+    // Enough values to use every partial sum and a tail
+    dim::quantity_array<Length> values(37);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = static_cast<double>(i + 1) * meter;
+    }
+    CHECK(sum(values) / meter_ == doctest::Approx(37.0 * 38.0 / 2.0));
+    CHECK(dot(values, values) / (meter * meter) == doctest::Approx(37.0 * 38.0 * 75.0 / 6.0));
+    CHECK(min(values) / meter_ == 1.0);
+    CHECK(max(values) / meter_ == 37.0);
+    values[20] = -5.0 * meter;
+    values[36] = 50.0 * meter;
+    values[0] = Length::bad_quantity();
+    CHECK(min(values) / meter_ == -5.0);
+    CHECK(max(values) / meter_ == 50.0);
+
+    dim::quantity_array<Length> empty;
+    CHECK(sum(empty) / meter_ == 0.0);
+    CHECK(min(empty).is_bad());
+
+    // No good values is a bad quantity, not an infinity
+    dim::quantity_array<Length> bad(37, Length::bad_quantity());
+    CHECK(min(bad).is_bad());
+    CHECK(max(bad).is_bad());
+    bad[30] = 2.0 * meter;
+    CHECK(min(bad) / meter_ == 2.0);
+    CHECK(max(bad) / meter_ == 2.0);
+
+    dim::quantity_array<dim::quantity<Length::unit, float>> floats(100, dim::quantity<Length::unit, float>(0.5f));
+    CHECK(dimensionless_cast(sum(floats)) == 50.0f);
+}
+
+TEST_CASE("quantity_array.expressions")
+{
+    std::size_t const count = 1000;
+    dim::quantity_array<Mass> mass(count, 2.0 * kilogram);
+    dim::quantity_array<Acceleration> acceleration(count);
+    dim::quantity_array<Speed> speed(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        acceleration[i] = static_cast<double>(i) * meter / (second * second);
+        speed[i] = static_cast<double>(i % 10) * meter / second;
+    }
+    auto const drag = 0.5 * kilogram / meter;
+
+    // Nothing is evaluated until the assignment, which is one loop
+    auto expression = mass * acceleration + drag * speed * speed;
+    static_assert(std::is_same<decltype(expression)::value_type, Force>::value, "Force units");
+    CHECK(expression[7] / newton == doctest::Approx(2.0 * 7.0 + 0.5 * 49.0));
+    dim::quantity_array<Force> force = expression;
+    REQUIRE(force.size() == count);
+    for (std::size_t i = 0; i < count; i += 97) {
+        double v = static_cast<double>(i % 10);
+        CHECK(force[i] / newton == doctest::Approx(2.0 * static_cast<double>(i) + 0.5 * v * v));
+    }
+
+    // Reductions of expressions make no temporary array
+    CHECK(sum(mass * acceleration) / newton == doctest::Approx(2.0 * 999.0 * 1000.0 / 2.0));
+    CHECK(max(-speed) / (meter / second) == 0.0);
+
+    // An expression may read the array it is assigned to
+    force = force - mass * acceleration;
+    CHECK(force[13] / newton == doctest::Approx(0.5 * 9.0));
+    force += drag * speed * speed;
+    CHECK(force[13] / newton == doctest::Approx(9.0));
+
+    // Assigning through a span
+    dim::quantity_span<Speed> slow(speed.data(), 10);
+    slow.assign(slow * 0.5 + 1.0 * meter / second);
+    CHECK(speed[4] / (meter / second) == doctest::Approx(3.0));
+    CHECK(speed[14] / (meter / second) == doctest::Approx(4.0));
+}
+
+TEST_CASE("quantity_array.shifted_overlap")
+{
+    std::size_t const count = 4000;
+    std::vector<Length> values(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<double>(i) * meter;
+    }
+    dim::quantity_span<Length> view(values);
+
+    // Shift up by one, reading each value before it is overwritten
+    view.subspan(1, count - 1).assign(view.subspan(0, count - 1));
+    CHECK(values[0] / meter_ == 0.0);
+    CHECK(values[1] / meter_ == 0.0);
+    CHECK(values[2] / meter_ == 1.0);
+    CHECK(values[count - 1] / meter_ == static_cast<double>(count - 2));
+
+    // Shift down by one, in an expression and on several threads
+    dim::parallel_policy policy(4, 100);
+    view.subspan(0, count - 1).assign(view.subspan(1, count - 1) * 2.0, policy);
+    bool shifted = true;
+    for (std::size_t i = 1; i + 1 < count; ++i) {
+        shifted = shifted && values[i] / meter_ == 2.0 * static_cast<double>(i);
+    }
+    CHECK(values[0] / meter_ == 0.0);
+    CHECK(shifted);
+    CHECK(values[count - 1] / meter_ == static_cast<double>(count - 2));
+}
+
+TEST_CASE("quantity_array.parallel")
+{
+    std::size_t const count = 100003;
+    dim::quantity_array<Length> length(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        length[i] = static_cast<double>(i % 100) * meter;
+    }
+    dim::quantity_array<Time> time(count, 2.0 * second);
+
+    dim::parallel_policy policy(4, 1000);
+    CHECK(policy.parts(count) == 4);
+    CHECK(policy.parts(3000) == 3);
+    CHECK(policy.parts(10) == 1);
+
+    dim::quantity_array<Speed> speed(length / time, policy);
+    dim::quantity_array<Speed> serial = length / time;
+    REQUIRE(speed.size() == count);
+    bool same = true;
+    for (std::size_t i = 0; i < count; ++i) {
+        same = same && speed[i] == serial[i];
+    }
+    CHECK(same);
+
+    CHECK(sum(length, policy) / meter_ == doctest::Approx(sum(length) / meter_));
+    CHECK(dot(length, time, policy) / (meter * second) == doctest::Approx(dot(length, time) / (meter * second)));
+    // Whole numbers sum exactly whichever way they are split
+    CHECK(sum(length, dim::parallel_policy(3, 1)) == sum(length));
+}
+
+TEST_CASE("quantity_array.size_mismatch")
+{
+    dim::quantity_array<Length> three(3, 1.0 * meter);
+    dim::quantity_array<Length> two(2, 1.0 * meter);
+#ifdef DIM_EXCEPTIONS
+    CHECK_THROWS_AS(three + two, std::length_error);
+    CHECK_THROWS_AS(three += two, std::length_error);
+    CHECK_THROWS_AS(dot(three, two), std::length_error);
+#else
+    dim::quantity_array<Length> bad = three + two;
+    REQUIRE(bad.size() == 3);
+    CHECK(bad[0].is_bad());
+    three -= two;
+    CHECK(three[2].is_bad());
+    CHECK(dot(two, three).is_bad());
+#endif
+}
@@ -56,6 +56,31 @@ TEST_CASE("SiDerived") {
     doCheck<Viscosity>(poiseuille, "Pl");
 }
 
+TEST_CASE("SiDynamicSymbol") {
+    CHECK(std::string(system::specialized_symbol(dim::index<Length>())) == "m");
+    CHECK(std::string(system::specialized_symbol(dim::index<Pressure>())) == "Pa");
+    CHECK(std::string(system::specialized_symbol(dim::index<Luminance>())) == "Ix");
+    CHECK(std::string(system::specialized_symbol(dim::index<Speed>())).empty());
+
+    // Overrides replace the built-in symbol and may be replaced themselves
+    char const* before = system::specialized_symbol(dim::index<Acceleration>());
+    CHECK(std::string(before).empty());
+    system::set_specialized_symbol(dim::index<Acceleration>(), "Gal");
+    char const* first = system::specialized_symbol(dim::index<Acceleration>());
+    CHECK(std::string(first) == "Gal");
+    system::set_specialized_symbol(dim::index<Acceleration>(), "mps2");
+    CHECK(std::string(system::specialized_symbol(dim::index<Acceleration>())) == "mps2");
+    CHECK(std::string(first) == "Gal");
+    // Each distinct symbol is stored once, however often it is set
+    for (int i = 0; i < 100; ++i) {
+        system::set_specialized_symbol(dim::index<Acceleration>(), i % 2 ? "Gal" : "mps2");
+    }
+    CHECK(system::specialized_symbol(dim::index<Acceleration>()) == first);
+    system::set_specialized_symbol(dim::index<Acceleration>(), "");
+    CHECK(std::string(system::specialized_symbol(dim::index<Acceleration>())).empty());
+    CHECK(std::string(system::specialized_symbol(dim::index<Force>())) == "N");
+}
+
 TEST_CASE("CompoundUnits") {
     CHECK(1.0*meter2 == 1.0*meter*meter);
     CHECK(1.0*meter3 == 1.0*meter*meter*meter);
@@ -0,0 +1,78 @@
+#include "dim/si.hpp"
+#include "dim/system_conversion.hpp"
+#include "doctest.h"
+
+using namespace dim;
+
+/// A centimeter-gram-second system for the tests
+namespace cgs
+{
+using dim::unit;
+
+struct system : dim::system_tag {
+    using dimensionless_unit = unit<0, 0, 0, 0, 0, 0, 0, 0, system>;
+};
+
+DIM_DEFINE_QUANTITY(Length, centimeter, system, double, 1, 0, 0, 0, 0, 0, 0, 0)
+DIM_DEFINE_QUANTITY(Time, second, system, double, 0, 1, 0, 0, 0, 0, 0, 0)
+DIM_DEFINE_QUANTITY(Mass, gram, system, double, 0, 0, 1, 0, 0, 0, 0, 0)
+DIM_DEFINE_QUANTITY(Force, dyne, system, double, 1, -2, 1, 0, 0, 0, 0, 0)
+DIM_DEFINE_QUANTITY(Energy, erg, system, double, 2, -2, 1, 0, 0, 0, 0, 0)
+DIM_DEFINE_QUANTITY(Density, gram_per_cc, system, double, -3, 0, 1, 0, 0, 0, 0, 0)
+
+using dynamic_quantity = dim::dynamic_quantity<double, system>;
+} // namespace cgs
+
+DIM_DEFINE_SYSTEM_CONVERSION(cgs::system, dim::si::system, 0.01, 1.0, 0.001, 1.0, 1.0, 1.0, 1.0, 1.0)
+
+TEST_CASE("system_conversion.factor")
+{
+    static_assert(system_factor<cgs::Length::unit, si::system>() == 0.01, "compile-time factor");
+    CHECK(system_factor<cgs::Force::unit, si::system>() == doctest::Approx(1e-5));
+    CHECK(system_factor<cgs::Energy::unit, si::system>() == doctest::Approx(1e-7));
+    CHECK(system_factor<cgs::Density::unit, si::system>() == doctest::Approx(1000.0));
+    CHECK(system_factor<si::Force::unit, cgs::system>() == doctest::Approx(1e5));
+    CHECK(system_factor<si::Time::unit, cgs::system>() == 1.0);
+    CHECK(system_factor<si::Length::unit, si::system>() == 1.0);
+}
+
+TEST_CASE("system_conversion.static")
+{
+    si::Force f = system_cast<si::system>(5.0 * cgs::dyne);
+    CHECK(f / si::newton == doctest::Approx(5e-5));
+
+    cgs::Energy e = system_cast<cgs::system>(2.0 * si::joule);
+    CHECK(e / cgs::erg == doctest::Approx(2e7));
+
+    si::Density rho = system_cast<si::system>(1.0 * cgs::gram_per_cc);
+    CHECK(rho / (si::kilogram / (si::meter * si::meter * si::meter)) == doctest::Approx(1000.0));
+
+    // Round trips come back to the same value
+    si::Length l = 3.0 * si::meter;
+    CHECK(system_cast<si::system>(system_cast<cgs::system>(l)) / si::meter == doctest::Approx(3.0));
+
+    // Converting to the same system changes nothing
+    CHECK(system_cast<si::system>(l) == l);
+
+    constexpr cgs::Length cm = system_cast<cgs::system>(si::meter);
+    static_assert(dimensionless_cast(cm) == 100.0, "constexpr conversion");
+}
+
+TEST_CASE("system_conversion.dynamic")
+{
+    cgs::dynamic_quantity dyn(5.0, dim::index<cgs::Force>());
+    si::dynamic_quantity f = system_cast<si::system>(dyn);
+    CHECK(f.value() == doctest::Approx(5e-5));
+    CHECK(f.unit() == dim::index<si::Force>());
+
+    // The runtime factor agrees with the static one for every unit
+    si::dynamic_quantity e = system_cast<si::system>(cgs::dynamic_quantity(1.0, dim::index<cgs::Energy>()));
+    CHECK(e.value() == system_factor<cgs::Energy::unit, si::system>());
+    CHECK(system_factor<si::system>(dim::index<cgs::Density>()) ==
+          system_factor<cgs::Density::unit, si::system>());
+
+    cgs::dynamic_quantity back = system_cast<cgs::system>(si::dynamic_quantity(2.0 * si::joule));
+    CHECK(back.value() == doctest::Approx(2e7));
+
+    CHECK(system_cast<si::system>(cgs::dynamic_quantity::bad_quantity()).is_bad());
+}